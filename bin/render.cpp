@@ -3,6 +3,7 @@
 #include <mbgl/util/image.hpp>
 #include <mbgl/util/std.hpp>
 #include <mbgl/util/io.hpp>
+#include <mbgl/util/chrono.hpp>
 
 #include <mbgl/platform/default/headless_view.hpp>
 #include <mbgl/platform/default/headless_display.hpp>
@@ -10,6 +11,10 @@
 #include <mbgl/storage/default_file_source.hpp>
 #include <mbgl/storage/sqlite_cache.hpp>
 
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
 #pragma GCC diagnostic push
 #ifndef __clang__
 #pragma GCC diagnostic ignored "-Wunused-local-typedefs"
@@ -20,56 +25,196 @@
 
 namespace po = boost::program_options;
 
-#include <uv.h>
-
 #include <cassert>
 #include <cstdlib>
+#include <future>
 #include <iostream>
 
-int main(int argc, char *argv[]) {
+using namespace mbgl;
+
+namespace {
+
+struct Job {
     std::string style_path;
     double lat = 0, lon = 0;
     double zoom = 0;
     double bearing = 0;
-
     int width = 512;
     int height = 512;
     double pixelRatio = 1.0;
-    static std::string output = "out.png";
-    std::string cache_file = "cache.sqlite";
     std::vector<std::string> classes;
+    std::string output = "out.png";
+};
+
+// Keeps a single map, and with it the GL context, the worker threads and the tiles that were
+// loaded for previous jobs, around for all jobs.
+class Renderer {
+public:
+    Renderer(FileSource& fileSource, const std::string& token) : map(view, fileSource) {
+        map.start(Map::Mode::Static);
+        if (token.size()) {
+            map.setAccessToken(std::string(token));
+        }
+    }
+
+    ~Renderer() {
+        map.stop();
+    }
+
+    void render(const Job& job) {
+        // Reloading the style drops all tiles, so it's only done when the style changes.
+        if (job.style_path != style_path) {
+            map.setStyleJSON(util::read_file(job.style_path), ".");
+            style_path = job.style_path;
+        }
+        map.setClasses(job.classes);
+
+        view.resize(job.width, job.height, job.pixelRatio);
+        map.setLatLngZoom({ job.lat, job.lon }, job.zoom);
+        map.setBearing(job.bearing);
+
+        std::promise<std::unique_ptr<const StillImage>> promise;
+        map.renderStill([&promise](std::unique_ptr<const StillImage> image) {
+            promise.set_value(std::move(image));
+        });
+        const auto image = promise.get_future().get();
+
+        const std::string png = util::compress_png(image->width, image->height, image->pixels.get());
+        util::write_file(job.output, png);
+    }
+
+    Map& getMap() { return map; }
+
+private:
+    HeadlessView view;
+    Map map;
+    std::string style_path;
+};
+
+// Reads a job from a JSON object such as {"style": "style.json", "zoom": 4, "output": "4.png"}.
+// Keys use the names of the command line options, and missing keys keep their default.
+Job parseJob(const std::string& line, const Job& defaults) {
+    rapidjson::Document doc;
+    doc.Parse<0>(line.c_str());
+    if (doc.HasParseError()) {
+        throw std::runtime_error(std::string("Invalid job: ") + doc.GetParseError());
+    }
+    if (!doc.IsObject()) {
+        throw std::runtime_error("Job must be an object");
+    }
+
+    Job job = defaults;
+    for (auto it = doc.MemberBegin(); it != doc.MemberEnd(); ++it) {
+        const std::string key = it->name.GetString();
+        const rapidjson::Value& value = it->value;
+
+        if (value.IsNumber()) {
+            const double number = value.GetDouble();
+            if (key == "lat") job.lat = number;
+            else if (key == "lon") job.lon = number;
+            else if (key == "zoom") job.zoom = number;
+            else if (key == "bearing") job.bearing = number;
+            else if (key == "width") job.width = int(number);
+            else if (key == "height") job.height = int(number);
+            else if (key == "ratio") job.pixelRatio = number;
+            else throw std::runtime_error("Invalid key " + key);
+        } else if (value.IsString()) {
+            if (key == "style") job.style_path = value.GetString();
+            else if (key == "output") job.output = value.GetString();
+            else throw std::runtime_error("Invalid key " + key);
+        } else if (value.IsArray() && key == "class") {
+            job.classes.clear();
+            for (rapidjson::SizeType i = 0; i < value.Size(); i++) {
+                if (!value[i].IsString()) {
+                    throw std::runtime_error("Class names must be strings");
+                }
+                job.classes.emplace_back(value[i].GetString());
+            }
+        } else {
+            throw std::runtime_error("Invalid key " + key);
+        }
+    }
+
+    if (job.style_path.empty()) {
+        throw std::runtime_error("Job has no style");
+    }
+
+    return job;
+}
+
+// Renders a job from each line of the input, and writes a line with the result of each job,
+// e.g. {"output": "4.png", "time": 35.2}, with the time in milliseconds, or {"error": "..."}.
+void runBatch(Renderer& renderer, const Job& defaults, std::istream& input, std::ostream& log) {
+    std::string line;
+    while (std::getline(input, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        writer.StartObject();
+
+        const TimePoint start = Clock::now();
+        try {
+            const Job job = parseJob(line, defaults);
+            renderer.render(job);
+            writer.String("output");
+            writer.String(job.output.c_str());
+            writer.String("time");
+            writer.Double(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+        } catch (const std::exception& ex) {
+            writer.String("error");
+            writer.String(ex.what());
+        }
+
+        writer.EndObject();
+        log << buffer.GetString() << std::endl;
+    }
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    Job job;
+    std::string cache_file = "cache.sqlite";
+    std::string metrics_file;
     std::string token;
+    bool batch = false;
 
     po::options_description desc("Allowed options");
     desc.add_options()
-        ("style,s", po::value(&style_path)->required()->value_name("json"), "Map stylesheet")
-        ("lon,x", po::value(&lon)->value_name("degrees")->default_value(lon), "Longitude")
-        ("lat,y", po::value(&lat)->value_name("degrees")->default_value(lat), "Latitude in degrees")
-        ("zoom,z", po::value(&zoom)->value_name("number")->default_value(zoom), "Zoom level")
-        ("bearing,b", po::value(&bearing)->value_name("degrees")->default_value(bearing), "Bearing")
-        ("width,w", po::value(&width)->value_name("pixels")->default_value(width), "Image width")
-        ("height,h", po::value(&height)->value_name("pixels")->default_value(height), "Image height")
-        ("class,c", po::value(&classes)->value_name("name"), "Class name")
+        ("style,s", po::value(&job.style_path)->value_name("json"), "Map stylesheet")
+        ("lon,x", po::value(&job.lon)->value_name("degrees")->default_value(job.lon), "Longitude")
+        ("lat,y", po::value(&job.lat)->value_name("degrees")->default_value(job.lat), "Latitude in degrees")
+        ("zoom,z", po::value(&job.zoom)->value_name("number")->default_value(job.zoom), "Zoom level")
+        ("bearing,b", po::value(&job.bearing)->value_name("degrees")->default_value(job.bearing), "Bearing")
+        ("width,w", po::value(&job.width)->value_name("pixels")->default_value(job.width), "Image width")
+        ("height,h", po::value(&job.height)->value_name("pixels")->default_value(job.height), "Image height")
+        ("class,c", po::value(&job.classes)->value_name("name"), "Class name")
         ("token,t", po::value(&token)->value_name("key")->default_value(token), "Mapbox access token")
-        ("output,o", po::value(&output)->value_name("file")->default_value(output), "Output file name")
+        ("output,o", po::value(&job.output)->value_name("file")->default_value(job.output), "Output file name")
         ("cache,d", po::value(&cache_file)->value_name("file")->default_value(cache_file), "Cache database file name")
+        ("metrics,m", po::value(&metrics_file)->value_name("file"), "Write request, parse and render metrics as JSON")
+        ("batch", po::bool_switch(&batch), "Render one JSON job per line of stdin, using the options above as defaults")
     ;
 
     try {
         po::variables_map vm;
         po::store(po::parse_command_line(argc, argv, desc), vm);
         po::notify(vm);
+        if (!batch && job.style_path.empty()) {
+            throw std::runtime_error("the option '--style' is required but missing");
+        }
     } catch(std::exception& e) {
         std::cout << "Error: " << e.what() << std::endl << desc;
         exit(1);
     }
 
-    std::string style = mbgl::util::read_file(style_path);
-
-    using namespace mbgl;
-
-    mbgl::SQLiteCache cache(cache_file);
-    mbgl::DefaultFileSource fileSource(&cache);
+    SQLiteCache cache(cache_file);
+    // Tiles of consecutive jobs are stored together; the cache commits the rest when it's closed.
+    cache.setWriteBatch(64, std::chrono::seconds(1));
+    DefaultFileSource fileSource(&cache);
 
     // Try to load the token from the environment.
     if (!token.size()) {
@@ -79,42 +224,16 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    Renderer renderer(fileSource, token);
 
-    HeadlessView view;
-    Map map(view, fileSource);
-
-    map.start(Map::Mode::Static);
-
-    // Set access token if present
-    if (token.size()) {
-        map.setAccessToken(std::string(token));
+    if (batch) {
+        // Results go to stdout, so that jobs can be streamed in and results out through a pipe.
+        runBatch(renderer, job, std::cin, std::cout);
+    } else {
+        renderer.render(job);
     }
 
-    map.setStyleJSON(style, ".");
-    map.setClasses(classes);
-
-    view.resize(width, height, pixelRatio);
-    map.setLatLngZoom({ lat, lon }, zoom);
-    map.setBearing(bearing);
-
-    uv_async_t *async = new uv_async_t;
-    uv_async_init(uv_default_loop(), async, [](uv_async_t *as, int) {
-        std::unique_ptr<const StillImage> image(reinterpret_cast<const StillImage *>(as->data));
-        uv_close(reinterpret_cast<uv_handle_t *>(as), [](uv_handle_t *handle) {
-            delete reinterpret_cast<uv_async_t *>(handle);
-        });
-
-        const std::string png = util::compress_png(image->width, image->height, image->pixels.get());
-        util::write_file(output, png);
-    });
-
-    map.renderStill([async](std::unique_ptr<const StillImage> image) {
-        async->data = const_cast<StillImage *>(image.release());
-        uv_async_send(async);
-    });
-
-    // This loop will terminate once the async was fired.
-    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
-
-    map.stop();
+    if (metrics_file.size()) {
+        util::write_file(metrics_file, renderer.getMap().getMetrics().toJSON());
+    }
 }
@@ -6,6 +6,7 @@
 
 #include <thread>
 #include <functional>
+#include <memory>
 #include <vector>
 
 typedef struct uv_loop_s uv_loop_t;
@@ -13,6 +14,7 @@ typedef struct uv_loop_s uv_loop_t;
 namespace mbgl {
 
 class FileSource;
+class MetricsRecorder;
 class Request;
 class Response;
 struct Resource;
@@ -59,9 +61,16 @@ public:
     // Request to terminate the environment.
     void terminate();
 
+    // #############################################################################################
+
+    // Counters and timings of everything that happens in this environment. Safe to use from
+    // any thread.
+    MetricsRecorder& getMetrics() { return *metrics; }
+
 private:
     unsigned id;
     FileSource& fileSource;
+    const std::unique_ptr<MetricsRecorder> metrics;
 
     // Stores OpenGL objects that we marked for deletion
     std::vector<uint32_t> abandonedVAOs;
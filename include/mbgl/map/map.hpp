@@ -4,6 +4,8 @@
 #include <mbgl/map/transform.hpp>
 #include <mbgl/util/chrono.hpp>
 #include <mbgl/map/update.hpp>
+#include <mbgl/map/memory_pressure.hpp>
+#include <mbgl/map/metrics.hpp>
 #include <mbgl/util/geo.hpp>
 #include <mbgl/util/projection.hpp>
 #include <mbgl/util/noncopyable.hpp>
@@ -43,6 +45,7 @@ class AnnotationManager;
 class MapData;
 class Worker;
 class StillImage;
+class TileCache;
 
 class Map : private util::noncopyable {
     friend class View;
@@ -159,9 +162,20 @@ public:
     LatLngBounds getBoundsForAnnotations(const std::vector<uint32_t>&);
 
     // Memory
-    void setSourceTileCacheSize(size_t);
-    size_t getSourceTileCacheSize() const { return sourceCacheSize; }
-    void onLowMemory();
+    // Limits the memory held by tiles that left the viewport, across all sources, in bytes.
+    void setTileCacheBudget(size_t);
+    size_t getTileCacheBudget() const { return tileCacheBudget; }
+    void onLowMemory(MemoryPressure = MemoryPressure::Critical);
+
+    // Loads the tiles for where an animation or a gesture takes the map ahead of time, into the
+    // tile cache. Enabled by default.
+    void setPrefetchEnabled(bool);
+    bool getPrefetchEnabled() const { return prefetchEnabled; }
+
+    // Metrics
+    // Returns the counters and timings recorded since the map was created. Can be polled from
+    // any thread while the map is running.
+    MapMetrics getMetrics() const;
 
     // Debug
     void setDebug(bool value);
@@ -212,7 +226,8 @@ private:
 
     void updateAnnotationTiles(const std::vector<TileID>&);
 
-    size_t sourceCacheSize;
+    size_t tileCacheBudget;
+    std::atomic<bool> prefetchEnabled { true };
 
     Mode mode = Mode::None;
 
@@ -258,6 +273,7 @@ private:
     util::ptr<TexturePool> texturePool;
     std::unique_ptr<Painter> painter;
     std::unique_ptr<AnnotationManager> annotationManager;
+    std::unique_ptr<TileCache> tileCache;
 
     const std::unique_ptr<MapData> data;
 
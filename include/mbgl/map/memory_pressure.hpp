@@ -0,0 +1,17 @@
+#ifndef MBGL_MAP_MEMORY_PRESSURE
+#define MBGL_MAP_MEMORY_PRESSURE
+
+#include <cstdint>
+
+namespace mbgl {
+
+// Each level releases everything the previous levels release, too.
+enum class MemoryPressure : uint8_t {
+    Moderate, // drop raw tile data that is no longer needed
+    High,     // drop cached tiles whose buffers are still held in main memory
+    Critical, // drop all cached tiles
+};
+
+}
+
+#endif
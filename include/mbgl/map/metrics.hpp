@@ -0,0 +1,84 @@
+#ifndef MBGL_MAP_METRICS
+#define MBGL_MAP_METRICS
+
+#include <mbgl/util/chrono.hpp>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace mbgl {
+
+// Distribution of durations. Buckets grow exponentially, with four buckets per power of two, so
+// quantiles are accurate to about 20% from a microsecond up to several minutes.
+class Histogram {
+public:
+    static const std::size_t bucketsPerPowerOfTwo = 4;
+    static const std::size_t bucketCount = 28 * bucketsPerPowerOfTwo;
+
+    void record(Duration);
+
+    uint64_t count() const { return samples; }
+    Duration sum() const { return total; }
+    Duration min() const { return samples ? minimum : Duration::zero(); }
+    Duration max() const { return maximum; }
+    Duration mean() const;
+
+    // Returns the upper bound of the bucket that contains the quantile, which must be between
+    // 0 and 1. The result never exceeds the largest recorded duration.
+    Duration quantile(double) const;
+
+    const std::array<uint64_t, bucketCount>& getBuckets() const { return buckets; }
+
+    // The largest duration counted by the bucket with the given index.
+    static Duration bucketLimit(std::size_t index);
+
+private:
+    std::array<uint64_t, bucketCount> buckets = {{}};
+    uint64_t samples = 0;
+    Duration total = Duration::zero();
+    Duration minimum = Duration::max();
+    Duration maximum = Duration::zero();
+};
+
+// Snapshot of everything a map recorded since it was created.
+struct MapMetrics {
+    // Resource requests, from the request to the response. Canceled requests aren't counted.
+    uint64_t requests = 0;
+    uint64_t requestErrors = 0;
+    Histogram requestTime;
+
+    // Tiles that were reused from the in-memory tile cache, and those that had to be loaded.
+    uint64_t tileCacheHits = 0;
+    uint64_t tileCacheMisses = 0;
+
+    // Parsing on the worker threads. Tiles that wait for glyphs or sprite images are parsed in
+    // more than one pass; each pass is recorded separately.
+    Histogram tileParseTime;
+    uint64_t featuresParsed = 0;
+    uint64_t verticesGenerated = 0;
+
+    // Time spent adding features to buckets and placing symbols, by bucket type.
+    std::map<std::string, Histogram> bucketParseTime;
+
+    // From the tile request until the tile is drawn for the first time.
+    Histogram tileFirstRenderTime;
+
+    // Vertex, element and texture data transferred to the GPU.
+    uint64_t uploadBytes = 0;
+
+    uint64_t frames = 0;
+    Histogram frameTime;
+
+    // GL state changes and draw calls the painter made while rendering frames, in total and in
+    // the most recent frame.
+    uint64_t glCalls = 0;
+    uint64_t lastFrameGLCalls = 0;
+
+    std::string toJSON() const;
+};
+
+}
+
+#endif
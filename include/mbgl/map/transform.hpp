@@ -56,6 +56,12 @@ public:
     // Gesture
     void setGestureInProgress(bool);
 
+    // Prediction
+    // Sets `state` to where the map will most likely be in `lookahead`: the destination of the
+    // running transition, or where an ongoing gesture ends up if it keeps its current velocity.
+    // Returns false if the map isn't moving.
+    bool predictState(TransformState& state, Duration lookahead) const;
+
     // Transform state
     const TransformState currentState() const;
     const TransformState finalState() const;
@@ -70,6 +76,9 @@ private:
 
     void constrain(double& scale, double& y) const;
 
+    // Records the velocity of gestures, which move the map without a transition.
+    void trackMotion(double new_scale, double xn, double yn);
+
     View &view;
 
     mutable std::recursive_mutex mtx;
@@ -94,6 +103,10 @@ private:
     Duration transitionDuration;
     std::function<Update(TimePoint)> transitionFrameFn;
     std::function<void()> transitionFinishFn;
+
+    // Velocity of the most recent gesture, in pixels and zoom levels per second.
+    TimePoint motionTime = TimePoint::min();
+    double velocityX = 0, velocityY = 0, velocityZoom = 0;
 };
 
 }
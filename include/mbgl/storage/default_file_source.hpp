@@ -3,6 +3,7 @@
 
 #include <mbgl/storage/file_source.hpp>
 #include <mbgl/storage/file_cache.hpp>
+#include <mbgl/storage/http_options.hpp>
 
 namespace mbgl {
 
@@ -23,6 +24,13 @@ public:
 
     void abort(const Environment &env) override;
 
+    // Applies to HTTP requests that start after this call.
+    void setHTTPOptions(const HTTPOptions&);
+
+    // Network requests beyond this number wait, and are started by the priority of their
+    // resources. 0 doesn't limit the number. The default is 20.
+    void setMaximumConcurrentRequests(std::size_t);
+
 public:
     class Impl;
 private:
@@ -0,0 +1,42 @@
+#ifndef MBGL_STORAGE_HTTP_OPTIONS
+#define MBGL_STORAGE_HTTP_OPTIONS
+
+#include <cstddef>
+
+namespace mbgl {
+
+// How HTTP requests use connections. Backends that manage connections themselves may ignore some
+// of these.
+struct HTTPOptions {
+    // Sends concurrent requests to a host over a single HTTP/2 connection when the server supports
+    // it, instead of opening a connection per request.
+    bool multiplexing = true;
+
+    // The number of connections that are open at the same time, per host and in total. Requests
+    // beyond the limit wait until a connection is free. 0 means no limit.
+    std::size_t maximumHostConnections = 8;
+    std::size_t maximumConnections = 0;
+
+    // Sends TCP keep-alive probes on idle connections, so that they stay open for later requests.
+    bool keepAlive = true;
+
+    // Shares DNS lookups and TLS sessions between requests, so that new connections to a host
+    // don't resolve its name again and resume the TLS session instead of a full handshake.
+    bool shareSessions = true;
+
+    bool operator==(const HTTPOptions& rhs) const {
+        return multiplexing == rhs.multiplexing &&
+               maximumHostConnections == rhs.maximumHostConnections &&
+               maximumConnections == rhs.maximumConnections &&
+               keepAlive == rhs.keepAlive &&
+               shareSessions == rhs.shareSessions;
+    }
+
+    bool operator!=(const HTTPOptions& rhs) const {
+        return !(*this == rhs);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef MBGL_STORAGE_OFFLINE_DOWNLOAD
+#define MBGL_STORAGE_OFFLINE_DOWNLOAD
+
+#include <mbgl/util/chrono.hpp>
+#include <mbgl/util/geo.hpp>
+#include <mbgl/util/noncopyable.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mbgl {
+
+namespace util {
+template <typename T> class Thread;
+}
+
+class FileSource;
+class FileCache;
+
+// The area of a style to make available offline.
+struct OfflineRegion {
+    std::string styleURL;
+    std::string accessToken;
+
+    LatLngBounds bounds;
+    double minZoom = 0;
+    double maxZoom = 14;
+    float pixelRatio = 1;
+
+    // The glyph ranges to download for every font stack the region uses. Empty means all of them,
+    // since the labels the tiles contain aren't known before they are parsed.
+    std::vector<std::pair<uint16_t, uint16_t>> glyphRanges;
+
+    // The number of requests that are in flight at the same time.
+    std::size_t maximumConcurrentRequests = 8;
+};
+
+struct OfflineProgress {
+    // All resources found so far. This grows while TileJSONs are loaded.
+    uint64_t requiredResources = 0;
+    // Resources that were loaded or failed, including the ones that were cached already.
+    uint64_t completedResources = 0;
+    // Resources that were fresh in the cache, or loaded by an earlier download of the region.
+    uint64_t cachedResources = 0;
+    uint64_t failedResources = 0;
+
+    uint64_t completedTiles = 0;
+    uint64_t downloadedTiles = 0;
+    uint64_t downloadedBytes = 0;
+    Duration elapsed = Duration::zero();
+
+    // Set once all resources are completed.
+    bool complete = false;
+
+    double bytesPerSecond() const;
+    double tilesPerSecond() const;
+};
+
+// Loads the style, TileJSONs, tiles, glyphs and sprites a region needs through a file source, so
+// that they end up in its cache. The download runs on its own thread until it is complete or the
+// object is destroyed.
+class OfflineDownload : private util::noncopyable {
+public:
+    // Invoked on the download thread whenever a resource is completed.
+    using Observer = std::function<void(const OfflineProgress&)>;
+
+    // Resources that are fresh in `cache` aren't downloaded again. The URLs of loaded resources are
+    // appended to the file at `progressPath`, if one is given, so that a download that was stopped
+    // resumes where it left off.
+    OfflineDownload(const OfflineRegion&, FileSource&, FileCache*,
+                    const std::string& progressPath, Observer);
+    ~OfflineDownload();
+
+private:
+    class Impl;
+    const std::unique_ptr<util::Thread<Impl>> thread;
+};
+
+}
+
+#endif
@@ -10,6 +10,7 @@
 #include <thread>
 #include <functional>
 #include <memory>
+#include <vector>
 
 typedef struct uv_async_s uv_async_t;
 typedef struct uv_loop_s uv_loop_t;
@@ -27,8 +28,10 @@ public:
     Request(const Resource &resource, uv_loop_t *loop, const Environment &env, Callback callback);
 
 public:
-    // May be called from any thread.
+    // May be called from any thread. Stale responses don't complete the request; it is either
+    // notified again or finished without a response.
     void notify(const std::shared_ptr<const Response> &response);
+    void finish();
     void destruct();
 
     // May be called only from the thread the Request was created in.
@@ -44,7 +47,10 @@ private:
     struct Canceled;
     std::unique_ptr<Canceled> canceled;
     Callback callback;
-    std::shared_ptr<const Response> response;
+
+    // Responses that haven't been delivered yet. A null response finishes the request.
+    std::mutex mutex;
+    std::vector<std::shared_ptr<const Response>> responses;
 
 public:
     const Resource resource;
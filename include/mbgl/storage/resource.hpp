@@ -15,9 +15,52 @@ struct Resource {
         JSON = 4,
     };
 
+    // Network requests are started in this order when there are more than the file source runs
+    // at the same time.
+    enum Priority : uint8_t {
+        // Styles and TileJSON, which are needed to find everything else.
+        Style = 0,
+        // Glyphs and sprites, which are needed to render tiles.
+        Dependency = 1,
+        // Tiles in the current viewport.
+        Visible = 2,
+        // Resources that may be needed later.
+        Prefetch = 3,
+    };
+
+    // How an expired response from the cache is handled.
+    enum Freshness : bool {
+        // The request is answered once the response was revalidated.
+        Revalidate = false,
+        // The request is answered with the expired response right away, and revalidated in the
+        // background. It's answered a second time only if the resource changed.
+        StaleWhileRevalidate = true,
+    };
+
+    Resource(Kind kind_, const std::string &url_)
+        : kind(kind_), url(url_), priority(defaultPriority(kind_)), freshness(Revalidate) {}
+    Resource(Kind kind_, const std::string &url_, Priority priority_,
+             Freshness freshness_ = Revalidate)
+        : kind(kind_), url(url_), priority(priority_), freshness(freshness_) {}
+
+    static Priority defaultPriority(Kind kind) {
+        switch (kind) {
+        case JSON: return Style;
+        case Glyphs: case Image: return Dependency;
+        default: return Visible;
+        }
+    }
+
     const Kind kind;
     const std::string url;
 
+    // Requests for the same resource with different priorities are coalesced and share the most
+    // urgent one. The priority isn't part of the resource's identity.
+    const Priority priority;
+
+    // Like the priority, this belongs to the request and isn't part of the resource's identity.
+    const Freshness freshness;
+
     inline bool operator==(const Resource &res) const {
         return kind == res.kind && url == res.url;
     }
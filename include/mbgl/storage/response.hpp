@@ -1,6 +1,9 @@
 #ifndef MBGL_STORAGE_RESPONSE
 #define MBGL_STORAGE_RESPONSE
 
+#include <mbgl/util/chrono.hpp>
+
+#include <memory>
 #include <string>
 
 namespace mbgl {
@@ -14,7 +17,29 @@ public:
     int64_t modified = 0;
     int64_t expires = 0;
     std::string etag;
-    std::string data;
+
+    // An expired response from the cache, which is being revalidated. Requests that accept stale
+    // responses stay alive after they were answered with one; they are answered again if the
+    // resource changed, and must be canceled as long as they are pending.
+    bool stale = false;
+
+    // The payload is immutable and shared by every copy of the response, from the file source to
+    // the tiles, sprites and glyphs that use it. Successful responses always have a payload.
+    std::shared_ptr<const std::string> data;
+
+    // Phases of a request that was loaded over the network, each measured from the start of the
+    // request. Phases that were skipped, because a connection was reused or isn't encrypted, are
+    // zero, and so is the timing of responses that didn't come from the network.
+    struct Timing {
+        Duration lookup = Duration::zero();
+        Duration connect = Duration::zero();
+        Duration tls = Duration::zero();
+        Duration firstByte = Duration::zero();
+        Duration total = Duration::zero();
+        bool reusedConnection = false;
+    };
+
+    Timing timing;
 };
 
 }
@@ -2,6 +2,7 @@
 #define MBGL_STORAGE_DEFAULT_SQLITE_CACHE
 
 #include <mbgl/storage/file_cache.hpp>
+#include <mbgl/util/chrono.hpp>
 
 #include <string>
 
@@ -20,6 +21,20 @@ public:
     void get(const Resource &resource, Callback callback) override;
     void put(const Resource &resource, std::shared_ptr<const Response> response, Hint hint) override;
 
+    // Queues responses and expiry updates, and commits them in a single transaction once `size`
+    // writes are queued, or `delay` after the first one was queued. Reads are answered before
+    // queued writes are committed, and see the queued writes. A size of 1, the default, writes
+    // every response right away.
+    void setWriteBatch(std::size_t size, Duration delay);
+
+    // Switches the database to write-ahead logging, which doesn't block reads while a batch is
+    // committed and syncs less often. The journal mode is stored in the database file.
+    void setWriteAheadLog(bool);
+
+    // Evicts the least recently used responses once the database grows beyond `size` bytes. A
+    // size of 0, the default, doesn't limit the size.
+    void setMaximumCacheSize(uint64_t size);
+
 private:
     class Impl;
     const std::unique_ptr<util::Thread<Impl>> thread;
@@ -301,7 +301,7 @@ void HTTPRequestImpl::handleResult(NSData *data, NSURLResponse *res, NSError *er
         const long responseCode = [(NSHTTPURLResponse *)res statusCode];
 
         response = util::make_unique<Response>();
-        response->data = {(const char *)[data bytes], [data length]};
+        response->data = std::make_shared<const std::string>((const char *)[data bytes], [data length]);
 
         NSDictionary *headers = [(NSHTTPURLResponse *)res allHeaderFields];
         NSString *cache_control = [headers objectForKey:@"Cache-Control"];
@@ -326,7 +326,7 @@ void HTTPRequestImpl::handleResult(NSData *data, NSURLResponse *res, NSError *er
 
         if (responseCode == 304) {
             if (existingResponse) {
-                // We're going to copy over the existing response's data.
+                // We're going to copy over the existing response, which shares its payload.
                 response->status = existingResponse->status;
                 response->message = existingResponse->message;
                 response->modified = existingResponse->modified;
@@ -337,6 +337,7 @@ void HTTPRequestImpl::handleResult(NSData *data, NSURLResponse *res, NSError *er
                 // This is an unsolicited 304 response and should only happen on malfunctioning
                 // HTTP servers. It likely doesn't include any data, but we don't have much options.
                 response->status = Response::Successful;
+                response->data = std::make_shared<const std::string>();
                 status = ResponseStatus::Successful;
             }
         } else if (responseCode == 200) {
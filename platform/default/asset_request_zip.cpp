@@ -190,8 +190,9 @@ void AssetRequestImpl::fileStated(uv_zip_t *zip) {
         response = util::make_unique<Response>();
 
         // Allocate the space for reading the data.
-        response->data.resize(zip->stat->size);
-        buffer = uv_buf_init(const_cast<char *>(response->data.data()), zip->stat->size);
+        auto data = std::make_shared<std::string>(zip->stat->size, '\0');
+        buffer = uv_buf_init(const_cast<char *>(data->data()), zip->stat->size);
+        response->data = std::move(data);
 
         // Get the modification time in case we have one.
         if (zip->stat->valid & ZIP_STAT_MTIME) {
@@ -1,5 +1,6 @@
 #include <mbgl/storage/http_request.hpp>
 #include <mbgl/storage/http_context.hpp>
+#include <mbgl/storage/http_options.hpp>
 #include <mbgl/storage/response.hpp>
 #include <mbgl/util/chrono.hpp>
 #include <mbgl/platform/log.hpp>
@@ -74,6 +75,9 @@ public:
     void returnHandle(CURL *handle);
     void checkMultiInfo();
 
+    // Applies the connection limits of the options to the multi handle, if they changed.
+    void configure(const HTTPOptions&);
+
 public:
     // Used as the CURL timer function to periodically check for socket updates.
     uv_timer_t *timeout = nullptr;
@@ -82,9 +86,14 @@ public:
     // block and spawn threads.
     CURLM *multi = nullptr;
 
-    // CURL share handles are used for sharing session state (e.g.)
+    // CURL share handles are used for sharing session state (e.g. DNS lookups and TLS sessions)
+    // between easy handles.
     CURLSH *share = nullptr;
 
+    // The options the multi handle was last configured with.
+    HTTPOptions options;
+    bool configured = false;
+
     // A queue that we use for storing resuable CURL easy handles to avoid creating and destroying
     // them all the time.
     std::queue<CURL *> handles;
@@ -122,6 +131,9 @@ private:
     // Will store the current response.
     std::unique_ptr<Response> response;
 
+    // Collects the body, which becomes the response's payload once the request succeeded.
+    std::string body;
+
     // In case of revalidation requests, this will store the old response.
     const std::shared_ptr<const Response> existingResponse;
 
@@ -188,6 +200,8 @@ HTTPCURLContext::HTTPCURLContext(uv_loop_t *loop_) : HTTPContext(loop_) {
     uv_timer_init(loop, timeout);
 
     share = curl_share_init();
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
 
     multi = curl_multi_init();
     handleError(curl_multi_setopt(multi, CURLMOPT_SOCKETFUNCTION, handleSocket));
@@ -222,6 +236,27 @@ void HTTPCURLContext::returnHandle(CURL *handle) {
     handles.push(handle);
 }
 
+void HTTPCURLContext::configure(const HTTPOptions& options_) {
+    MBGL_VERIFY_THREAD(tid);
+
+    if (configured && options == options_) {
+        return;
+    }
+    options = options_;
+    configured = true;
+
+#if LIBCURL_VERSION_NUM >= 0x072b00 // 7.43.0
+    handleError(curl_multi_setopt(multi, CURLMOPT_PIPELINING,
+                                  options.multiplexing ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING));
+#endif
+#if LIBCURL_VERSION_NUM >= 0x071e00 // 7.30.0
+    handleError(curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                                  long(options.maximumHostConnections)));
+    handleError(curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                                  long(options.maximumConnections)));
+#endif
+}
+
 void HTTPCURLContext::checkMultiInfo() {
     MBGL_VERIFY_THREAD(tid);
     CURLMsg *message = nullptr;
@@ -433,6 +468,9 @@ HTTPRequestImpl::HTTPRequestImpl(HTTPRequest *request_, uv_loop_t *loop, std::sh
     assert(request);
     context->addRequest(request);
 
+    const HTTPOptions &options = request->source->httpOptions;
+    context->configure(options);
+
     // Zero out the error buffer.
     memset(error, 0, sizeof(error));
 
@@ -469,7 +507,20 @@ HTTPRequestImpl::HTTPRequestImpl(HTTPRequest *request_, uv_loop_t *loop, std::sh
     handleError(curl_easy_setopt(handle, CURLOPT_HEADERDATA, this));
     handleError(curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "gzip, deflate"));
     handleError(curl_easy_setopt(handle, CURLOPT_USERAGENT, "MapboxGL/1.0"));
-    handleError(curl_easy_setopt(handle, CURLOPT_SHARE, context->share));
+    if (options.shareSessions) {
+        handleError(curl_easy_setopt(handle, CURLOPT_SHARE, context->share));
+    }
+#if LIBCURL_VERSION_NUM >= 0x071900 // 7.25.0
+    handleError(curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, long(options.keepAlive)));
+#endif
+#if LIBCURL_VERSION_NUM >= 0x072f00 // 7.47.0
+    if (options.multiplexing) {
+        // Negotiates HTTP/2 over TLS, and waits for a connection that is being established to
+        // find out whether it can be multiplexed instead of opening another one.
+        handleError(curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, long(CURL_HTTP_VERSION_2TLS)));
+        handleError(curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L));
+    }
+#endif
 
     start();
 }
@@ -525,7 +576,7 @@ size_t HTTPRequestImpl::writeCallback(void *const contents, const size_t size, c
         impl->response = util::make_unique<Response>();
     }
 
-    impl->response->data.append((char *)contents, size * nmemb);
+    impl->body.append((char *)contents, size * nmemb);
     return size * nmemb;
 }
 
@@ -594,6 +645,7 @@ void HTTPRequestImpl::retry(uint64_t timeout) {
     handleError(curl_multi_remove_handle(context->multi, handle));
 
     response.reset();
+    body.clear();
 
     assert(!timer);
     timer = new uv_timer_t;
@@ -649,6 +701,42 @@ void HTTPRequestImpl::finish(ResponseStatus status) {
     delete this;
 }
 
+// Returns the phases of the last transfer of an easy handle.
+static Response::Timing getTiming(CURL *handle) {
+    Response::Timing timing;
+
+#if LIBCURL_VERSION_NUM >= 0x073d00 // 7.61.0
+    const auto get = [&](CURLINFO info) {
+        curl_off_t microseconds = 0;
+        curl_easy_getinfo(handle, info, &microseconds);
+        return std::chrono::duration_cast<Duration>(std::chrono::microseconds(microseconds));
+    };
+    timing.lookup = get(CURLINFO_NAMELOOKUP_TIME_T);
+    timing.connect = get(CURLINFO_CONNECT_TIME_T);
+    timing.tls = get(CURLINFO_APPCONNECT_TIME_T);
+    timing.firstByte = get(CURLINFO_STARTTRANSFER_TIME_T);
+    timing.total = get(CURLINFO_TOTAL_TIME_T);
+#else
+    const auto get = [&](CURLINFO info) {
+        double seconds = 0;
+        curl_easy_getinfo(handle, info, &seconds);
+        return std::chrono::duration_cast<Duration>(std::chrono::duration<double>(seconds));
+    };
+    timing.lookup = get(CURLINFO_NAMELOOKUP_TIME);
+    timing.connect = get(CURLINFO_CONNECT_TIME);
+    timing.tls = get(CURLINFO_APPCONNECT_TIME);
+    timing.firstByte = get(CURLINFO_STARTTRANSFER_TIME);
+    timing.total = get(CURLINFO_TOTAL_TIME);
+#endif
+
+    // A transfer that got a response without opening a connection reused one.
+    long connects = 0;
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connects);
+    timing.reusedConnection = connects == 0 && timing.firstByte > Duration::zero();
+
+    return timing;
+}
+
 void HTTPRequestImpl::handleResult(CURLcode code) {
     MBGL_VERIFY_THREAD(tid);
 
@@ -665,6 +753,8 @@ void HTTPRequestImpl::handleResult(CURLcode code) {
         response = util::make_unique<Response>();
     }
 
+    response->timing = getTiming(handle);
+
     // Add human-readable error code
     if (code != CURLE_OK) {
         response->status = Response::Error;
@@ -688,7 +778,7 @@ void HTTPRequestImpl::handleResult(CURLcode code) {
 
         if (responseCode == 304) {
             if (existingResponse) {
-                // We're going to copy over the existing response's data.
+                // We're going to copy over the existing response, which shares its payload.
                 response->status = existingResponse->status;
                 response->message = existingResponse->message;
                 response->modified = existingResponse->modified;
@@ -699,10 +789,12 @@ void HTTPRequestImpl::handleResult(CURLcode code) {
                 // This is an unsolicited 304 response and should only happen on malfunctioning
                 // HTTP servers. It likely doesn't include any data, but we don't have much options.
                 response->status = Response::Successful;
+                response->data = std::make_shared<const std::string>();
                 return finish(ResponseStatus::Successful);
             }
         } else if (responseCode == 200) {
             response->status = Response::Successful;
+            response->data = std::make_shared<const std::string>(std::move(body));
             return finish(ResponseStatus::Successful);
         } else if (responseCode >= 500 && responseCode < 600) {
             // Server errors may be temporary, so back off exponentially.
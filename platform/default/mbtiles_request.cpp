@@ -0,0 +1,333 @@
+#include <mbgl/storage/mbtiles_request.hpp>
+#include <mbgl/storage/thread_context.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/compression.hpp>
+#include <mbgl/util/std.hpp>
+#include <mbgl/util/util.hpp>
+
+#include "sqlite3.hpp"
+
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <uv.h>
+
+#pragma GCC diagnostic push
+#ifndef __clang__
+#pragma GCC diagnostic ignored "-Wunused-local-typedefs"
+#pragma GCC diagnostic ignored "-Wshadow"
+#endif
+#include <boost/algorithm/string.hpp>
+#pragma GCC diagnostic pop
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace algo = boost::algorithm;
+
+namespace mbgl {
+
+using namespace mapbox::sqlite;
+
+namespace {
+
+// Tiles are read through a memory map of up to this many bytes instead of being copied from the
+// page cache.
+const int64_t mmapSize = 256 * 1024 * 1024;
+
+}
+
+// A read-only connection to an MBTiles file.
+class MBTilesConnection {
+public:
+    MBTilesConnection(const std::string &path)
+        : db(path, ReadOnly),
+          tileStmt(db.prepare("SELECT `tile_data` FROM `tiles` "
+                              "WHERE `zoom_level` = ? AND `tile_column` = ? AND `tile_row` = ?")) {
+        db.exec("PRAGMA mmap_size = " + std::to_string(mmapSize));
+    }
+
+    Database db;
+    Statement tileStmt;
+};
+
+// The connections to an MBTiles file that aren't used at the moment. Every read takes a connection
+// from the pool, or opens a new one, and returns it afterwards, so that tiles are read on as many
+// threads as the loop's thread pool has.
+class MBTilesConnectionPool : private util::noncopyable {
+public:
+    MBTilesConnectionPool(const std::string &path_) : path(path_) {}
+
+    std::unique_ptr<MBTilesConnection> acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!idle.empty()) {
+                auto connection = std::move(idle.back());
+                idle.pop_back();
+                return connection;
+            }
+        }
+        return util::make_unique<MBTilesConnection>(path);
+    }
+
+    void release(std::unique_ptr<MBTilesConnection> connection) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(std::move(connection));
+    }
+
+private:
+    const std::string path;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<MBTilesConnection>> idle;
+};
+
+// -------------------------------------------------------------------------------------------------
+
+class MBTilesContext : public ThreadContext<MBTilesContext> {
+public:
+    MBTilesContext(uv_loop_t *loop);
+
+    std::shared_ptr<MBTilesConnectionPool> getPool(const std::string &path);
+
+private:
+    // Reads that are in progress keep their pool alive.
+    std::map<std::string, std::shared_ptr<MBTilesConnectionPool>> pools;
+};
+
+template<> pthread_key_t ThreadContext<MBTilesContext>::key{};
+template<> pthread_once_t ThreadContext<MBTilesContext>::once = PTHREAD_ONCE_INIT;
+
+MBTilesContext::MBTilesContext(uv_loop_t *loop_) : ThreadContext(loop_) {
+}
+
+std::shared_ptr<MBTilesConnectionPool> MBTilesContext::getPool(const std::string &path) {
+    auto &pool = pools[path];
+    if (!pool) {
+        pool = std::make_shared<MBTilesConnectionPool>(path);
+    }
+    return pool;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+class MBTilesRequestImpl {
+    MBGL_STORE_THREAD(tid)
+
+public:
+    MBTilesRequestImpl(MBTilesRequest *request, uv_loop_t *loop);
+    ~MBTilesRequestImpl();
+
+    static void work(uv_work_t *req);
+    static void afterWork(uv_work_t *req, int status);
+
+    MBTilesRequest *request = nullptr;
+    uv_work_t req;
+
+private:
+    void readTile(MBTilesConnection &connection);
+    void readTileJSON(MBTilesConnection &connection);
+
+    // Everything the worker thread needs is copied from the request, since the request may be
+    // canceled and deleted while the worker is reading.
+    const std::string url;
+    std::shared_ptr<MBTilesConnectionPool> pool;
+    bool tile = false;
+    int z = 0, x = 0, y = 0;
+    std::unique_ptr<Response> response;
+};
+
+MBTilesRequestImpl::MBTilesRequestImpl(MBTilesRequest *request_, uv_loop_t *loop)
+    : request(request_), url(request->resource.url) {
+    req.data = this;
+    response = util::make_unique<Response>();
+
+    // Splits the URL into the path of the file and the coordinates of the tile, if any.
+    const std::string location = url.substr(10);
+    const std::size_t extension = location.find(".mbtiles");
+    if (extension == std::string::npos) {
+        response->message = "Invalid MBTiles URL";
+    } else {
+        const std::string file = location.substr(0, extension + 8);
+        const std::string suffix = location.substr(extension + 8);
+        if (suffix.empty()) {
+            tile = false;
+        } else if (std::sscanf(suffix.c_str(), "/%d/%d/%d", &z, &x, &y) == 3 && z >= 0 && z < 31 &&
+                   x >= 0 && x < (1 << z) && y >= 0 && y < (1 << z)) {
+            tile = true;
+        } else {
+            response->message = "Invalid MBTiles tile URL";
+        }
+
+        if (response->message.empty()) {
+            if (file[0] == '/') {
+                // This is an absolute path.
+                pool = MBTilesContext::Get(loop)->getPool(file);
+            } else {
+                // This is a relative path. Prefix with the application root.
+                pool = MBTilesContext::Get(loop)->getPool(request->source->assetRoot + "/" + file);
+            }
+        }
+    }
+
+    uv_queue_work(loop, &req, work, afterWork);
+}
+
+MBTilesRequestImpl::~MBTilesRequestImpl() {
+    MBGL_VERIFY_THREAD(tid);
+
+    if (request) {
+        request->ptr = nullptr;
+    }
+}
+
+void MBTilesRequestImpl::work(uv_work_t *req) {
+    assert(req->data);
+    auto self = reinterpret_cast<MBTilesRequestImpl *>(req->data);
+
+    if (!self->pool) {
+        // The URL is invalid.
+        return;
+    }
+
+    try {
+        auto connection = self->pool->acquire();
+        if (self->tile) {
+            self->readTile(*connection);
+        } else {
+            self->readTileJSON(*connection);
+        }
+        self->pool->release(std::move(connection));
+    } catch (std::runtime_error &ex) {
+        // Reading from the database or decompressing the tile failed.
+        self->response->status = Response::Error;
+        self->response->message = ex.what();
+    }
+}
+
+void MBTilesRequestImpl::afterWork(uv_work_t *req, int status) {
+    assert(req->data);
+    auto self = reinterpret_cast<MBTilesRequestImpl *>(req->data);
+    MBGL_VERIFY_THREAD(self->tid);
+
+    if (self->request && status == 0) {
+        self->request->notify(std::move(self->response), FileCache::Hint::No);
+        delete self->request;
+    }
+
+    delete self;
+}
+
+void MBTilesRequestImpl::readTile(MBTilesConnection &connection) {
+    Statement &stmt = connection.tileStmt;
+    stmt.reset();
+
+    // MBTiles files number rows from the bottom.
+    stmt.bind(1, z);
+    stmt.bind(2, x);
+    stmt.bind(3, (1 << z) - 1 - y);
+
+    if (!stmt.run()) {
+        response->status = Response::Error;
+        response->message = "Tile not found";
+        return;
+    }
+
+    std::string data = stmt.get<std::string>(0);
+    stmt.reset();
+    if (data.size() > 2 && data[0] == '\x1f' && data[1] == '\x8b') {
+        // Vector tiles are usually stored gzipped.
+        data = util::decompress(data);
+    }
+    response->data = std::make_shared<const std::string>(std::move(data));
+    response->status = Response::Successful;
+}
+
+void MBTilesRequestImpl::readTileJSON(MBTilesConnection &connection) {
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.String("tilejson");
+    writer.String("2.0.0");
+
+    Statement stmt = connection.db.prepare("SELECT `name`, `value` FROM `metadata`");
+    while (stmt.run()) {
+        const std::string name = stmt.get<std::string>(0);
+        const std::string value = stmt.get<std::string>(1);
+
+        if (name == "minzoom" || name == "maxzoom") {
+            writer.String(name.c_str());
+            writer.Uint(std::atoi(value.c_str()));
+        } else if (name == "bounds" || name == "center") {
+            writer.String(name.c_str());
+            writer.StartArray();
+            std::istringstream stream(value);
+            std::string number;
+            while (std::getline(stream, number, ',')) {
+                writer.Double(std::atof(number.c_str()));
+            }
+            writer.EndArray();
+        } else if (name == "name" || name == "attribution" || name == "description" ||
+                   name == "version") {
+            writer.String(name.c_str());
+            writer.String(value.c_str());
+        }
+    }
+
+    writer.String("scheme");
+    writer.String("xyz");
+    writer.String("tiles");
+    writer.StartArray();
+    writer.String((url + "/{z}/{x}/{y}").c_str());
+    writer.EndArray();
+    writer.EndObject();
+
+    response->data = std::make_shared<const std::string>(buffer.GetString(), buffer.Size());
+    response->status = Response::Successful;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+MBTilesRequest::MBTilesRequest(DefaultFileSource::Impl *source_, const Resource &resource_)
+    : SharedRequestBase(source_, resource_) {
+    assert(algo::starts_with(resource.url, "mbtiles://"));
+}
+
+MBTilesRequest::~MBTilesRequest() {
+    MBGL_VERIFY_THREAD(tid);
+
+    if (ptr) {
+        reinterpret_cast<MBTilesRequestImpl *>(ptr)->request = nullptr;
+    }
+}
+
+void MBTilesRequest::start(uv_loop_t *loop, std::shared_ptr<const Response> response) {
+    MBGL_VERIFY_THREAD(tid);
+
+    // MBTiles files aren't cached, so there is no existing response.
+    (void(response));
+
+    assert(!ptr);
+    ptr = new MBTilesRequestImpl(this, loop);
+    // Note: the MBTilesRequestImpl deletes itself.
+}
+
+void MBTilesRequest::cancel() {
+    MBGL_VERIFY_THREAD(tid);
+
+    if (ptr) {
+        // Reads that have started already run to completion, but their result is discarded.
+        auto impl = reinterpret_cast<MBTilesRequestImpl *>(ptr);
+        impl->request = nullptr;
+        uv_cancel(reinterpret_cast<uv_req_t *>(&impl->req));
+        ptr = nullptr;
+    }
+
+    delete this;
+}
+
+}
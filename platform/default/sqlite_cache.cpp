@@ -4,12 +4,20 @@
 
 #include <mbgl/util/compression.hpp>
 #include <mbgl/util/io.hpp>
+#include <mbgl/util/noncopyable.hpp>
+#include <mbgl/util/run_loop.hpp>
 #include <mbgl/util/thread.hpp>
+#include <mbgl/util/uv_detail.hpp>
 #include <mbgl/platform/log.hpp>
 
 #include "sqlite3.hpp"
 #include <sqlite3.h>
 
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+#include <vector>
+
 namespace mbgl {
 
 std::string removeAccessTokenFromURL(const std::string &url) {
@@ -65,19 +73,27 @@ SQLiteCache::SQLiteCache(const std::string& path_)
     : thread(util::make_unique<util::Thread<Impl>>("SQLite Cache", path_)) {
 }
 
-SQLiteCache::~SQLiteCache() = default;
+SQLiteCache::~SQLiteCache() {
+    // Commits the queued writes and closes the timer while the thread's loop is still running.
+    thread->invoke(&Impl::flush);
+}
 
 SQLiteCache::Impl::Impl(const std::string& path_)
     : path(path_) {
 }
 
 SQLiteCache::Impl::~Impl() {
+    assert(!flushTimer);
+    assert(pending.empty());
+
     // Deleting these SQLite objects may result in exceptions, but we're in a destructor, so we
     // can't throw anything.
     try {
         getStmt.reset();
         putStmt.reset();
         refreshStmt.reset();
+        accessStmt.reset();
+        evictStmt.reset();
         db.reset();
     } catch (mapbox::sqlite::Exception& ex) {
         Log::Error(Event::Database, ex.code, ex.what());
@@ -86,10 +102,26 @@ SQLiteCache::Impl::~Impl() {
 
 void SQLiteCache::Impl::createDatabase() {
     db = util::make_unique<Database>(path.c_str(), ReadWrite | Create);
+    if (writeAheadLog) {
+        setJournalMode();
+    }
+}
+
+void SQLiteCache::Impl::setJournalMode() {
+    if (writeAheadLog) {
+        // With a write-ahead log, syncing at checkpoints only can't corrupt the database, but
+        // may lose the last transactions when the system crashes, which is fine for a cache.
+        db->exec("PRAGMA journal_mode = WAL");
+        db->exec("PRAGMA synchronous = NORMAL");
+    } else {
+        db->exec("PRAGMA journal_mode = DELETE");
+        db->exec("PRAGMA synchronous = FULL");
+    }
 }
 
 void SQLiteCache::Impl::createSchema() {
     constexpr const char *const sql = ""
+        "PRAGMA auto_vacuum = INCREMENTAL;" // Only takes effect before the first table is created.
         "CREATE TABLE IF NOT EXISTS `http_cache` ("
         "    `url` TEXT PRIMARY KEY NOT NULL,"
         "    `status` INTEGER NOT NULL," // The response status (Successful or Error).
@@ -98,11 +130,27 @@ void SQLiteCache::Impl::createSchema() {
         "    `etag` TEXT,"
         "    `expires` INTEGER," // Timestamp when the server says the file expires.
         "    `data` BLOB,"
-        "    `compressed` INTEGER NOT NULL DEFAULT 0" // Whether the data is compressed.
+        "    `compressed` INTEGER NOT NULL DEFAULT 0," // Whether the data is compressed.
+        "    `accessed` INTEGER NOT NULL DEFAULT 0," // Timestamp in ms when the file was last used.
+        "    `size` INTEGER NOT NULL DEFAULT 0" // The size of the stored data.
         ");"
-        "CREATE INDEX IF NOT EXISTS `http_cache_kind_idx` ON `http_cache` (`kind`);";
+        "CREATE INDEX IF NOT EXISTS `http_cache_kind_idx` ON `http_cache` (`kind`);"
+        "CREATE INDEX IF NOT EXISTS `http_cache_accessed_idx` ON `http_cache` (`accessed`);"
+        "PRAGMA user_version = 1;";
 
     try {
+        bool migrate = false;
+        {
+            Statement versionStmt = db->prepare("PRAGMA user_version");
+            Statement tableStmt = db->prepare(
+                "SELECT 1 FROM `sqlite_master` WHERE `type` = 'table' AND `name` = 'http_cache'");
+            migrate = versionStmt.run() && versionStmt.get<int>(0) == 0 && tableStmt.run();
+        }
+
+        if (migrate) {
+            migrateSchema();
+        }
+
         db->exec(sql);
         schema = true;
     } catch (mapbox::sqlite::Exception &ex) {
@@ -126,15 +174,98 @@ void SQLiteCache::Impl::createSchema() {
     }
 }
 
+void SQLiteCache::Impl::migrateSchema() {
+    // Version 0 didn't track access times or sizes. Responses stored by it are evicted first.
+    Log::Info(Event::Database, "Migrating cache to version 1");
+    db->exec("ALTER TABLE `http_cache` ADD COLUMN `accessed` INTEGER NOT NULL DEFAULT 0;"
+             "ALTER TABLE `http_cache` ADD COLUMN `size` INTEGER NOT NULL DEFAULT 0;"
+             "UPDATE `http_cache` SET `size` = length(`data`);");
+
+    // Switching an existing database to incremental vacuuming requires rebuilding it.
+    db->exec("PRAGMA auto_vacuum = INCREMENTAL");
+    db->exec("VACUUM");
+}
+
+namespace {
+
+// Inflates a compressed response on the thread pool of the loop that requested it.
+class DecompressWork : private util::noncopyable {
+public:
+    static void start(uv_loop_t* loop, std::unique_ptr<Response> response,
+                      SQLiteCache::Callback callback) {
+        auto self = new DecompressWork(std::move(response), std::move(callback));
+        uv_queue_work(loop, &self->req, work, afterWork);
+    }
+
+private:
+    DecompressWork(std::unique_ptr<Response> response_, SQLiteCache::Callback callback_)
+        : response(std::move(response_)), callback(std::move(callback_)) {
+        req.data = this;
+    }
+
+    static void work(uv_work_t* req) {
+        auto self = reinterpret_cast<DecompressWork*>(req->data);
+        try {
+            self->response->data =
+                std::make_shared<const std::string>(util::decompress(*self->response->data));
+        } catch (std::runtime_error& ex) {
+            self->error = ex.what();
+        }
+    }
+
+    static void afterWork(uv_work_t* req, int) {
+        std::unique_ptr<DecompressWork> self(reinterpret_cast<DecompressWork*>(req->data));
+        if (self->error.empty()) {
+            self->callback(std::move(self->response));
+        } else {
+            // Treat a payload that can't be inflated like a response that isn't cached.
+            Log::Error(Event::Database, "Failed to decompress cached response: %s",
+                       self->error.c_str());
+            self->callback(nullptr);
+        }
+    }
+
+    uv_work_t req;
+    std::unique_ptr<Response> response;
+    const SQLiteCache::Callback callback;
+    std::string error;
+};
+
+}
+
 void SQLiteCache::get(const Resource &resource, Callback callback) {
     // Can be called from any thread, but most likely from the file source thread.
     // Will try to load the URL from the SQLite database and call the callback when done.
     // Note that the callback is probably going to invoked from another thread, so the caller
-    // must make sure that it can run in that thread.
-    thread->invokeWithResult(&Impl::get, callback, resource);
+    // must make sure that it can run in that thread. Compressed payloads are inflated on the
+    // thread pool of the calling thread's loop before the callback is invoked.
+    util::RunLoop* caller = util::RunLoop::Get();
+    assert(caller);
+    uv_loop_t* loop = caller->get();
+
+    std::function<void(Impl::StoredResponse)> after = [loop, callback](Impl::StoredResponse stored) {
+        if (stored.compressed) {
+            DecompressWork::start(loop, std::move(stored.response), callback);
+        } else {
+            callback(std::move(stored.response));
+        }
+    };
+    thread->invokeWithResult(&Impl::get, after, resource);
 }
 
-std::unique_ptr<Response> SQLiteCache::Impl::get(const Resource &resource) {
+SQLiteCache::Impl::StoredResponse SQLiteCache::Impl::get(const Resource &resource) {
+    const std::string unifiedURL = unifyMapboxURLs(resource.url);
+    StoredResponse stored;
+
+    // Queued writes are newer than what is stored in the database.
+    const auto it = pending.find(unifiedURL);
+    if (it != pending.end() && it->second.response) {
+        stored.response = util::make_unique<Response>(*it->second.response);
+        stored.response->expires = it->second.expires;
+        stored.response->timing = Response::Timing();
+        return stored;
+    }
+
     try {
         // This is called in the SQLite event loop.
         if (!db) {
@@ -154,28 +285,33 @@ std::unique_ptr<Response> SQLiteCache::Impl::get(const Resource &resource) {
             getStmt->reset();
         }
 
-        const std::string unifiedURL = unifyMapboxURLs(resource.url);
         getStmt->bind(1, unifiedURL.c_str());
         if (getStmt->run()) {
             // There is data.
-            auto response = util::make_unique<Response>();
-            response->status = Response::Status(getStmt->get<int>(0));
-            response->modified = getStmt->get<int64_t>(1);
-            response->etag = getStmt->get<std::string>(2);
-            response->expires = getStmt->get<int64_t>(3);
-            response->data = getStmt->get<std::string>(4);
-            if (getStmt->get<int>(5)) { // == compressed
-                response->data = util::decompress(response->data);
+            stored.response = util::make_unique<Response>();
+            stored.response->status = Response::Status(getStmt->get<int>(0));
+            stored.response->modified = getStmt->get<int64_t>(1);
+            stored.response->etag = getStmt->get<std::string>(2);
+            stored.response->expires = getStmt->get<int64_t>(3);
+            stored.response->data = std::make_shared<const std::string>(getStmt->get<std::string>(4));
+            stored.compressed = getStmt->get<int>(5);
+            if (it != pending.end()) {
+                // There is a queued refresh.
+                stored.response->expires = it->second.expires;
+            }
+
+            accessed[unifiedURL] = accessTime();
+            if (accessed.size() >= 64) {
+                commitAccessTimes();
             }
-            return std::move(response);
-        } else {
-            // There is no data.
-            return nullptr;
         }
+        // Otherwise, there is no data.
     } catch (mapbox::sqlite::Exception& ex) {
         Log::Error(Event::Database, ex.code, ex.what());
-        return nullptr;
+        stored = StoredResponse();
     }
+
+    return stored;
 }
 
 void SQLiteCache::put(const Resource &resource, std::shared_ptr<const Response> response, Hint hint) {
@@ -189,56 +325,132 @@ void SQLiteCache::put(const Resource &resource, std::shared_ptr<const Response>
     }
 }
 
-void SQLiteCache::Impl::put(const Resource& resource, std::shared_ptr<const Response> response) {
-    try {
-        if (!db) {
-            createDatabase();
-        }
+void SQLiteCache::setWriteBatch(std::size_t size, Duration delay) {
+    thread->invoke(&Impl::setWriteBatch, thread->get(), size, delay);
+}
 
-        if (!schema) {
-            createSchema();
-        }
+void SQLiteCache::setWriteAheadLog(bool enable) {
+    thread->invoke(&Impl::setWriteAheadLog, enable);
+}
 
-        if (!putStmt) {
-            putStmt = util::make_unique<Statement>(db->prepare("REPLACE INTO `http_cache` ("
-            //     1       2       3         4         5         6        7          8
-                "`url`, `status`, `kind`, `modified`, `etag`, `expires`, `data`, `compressed`"
-                ") VALUES(?, ?, ?, ?, ?, ?, ?, ?)"));
-        } else {
-            putStmt->reset();
-        }
+void SQLiteCache::setMaximumCacheSize(uint64_t size) {
+    thread->invoke(&Impl::setMaximumCacheSize, size);
+}
+
+void SQLiteCache::Impl::setWriteBatch(uv_loop_t* loop_, std::size_t size, Duration delay) {
+    loop = loop_;
+    batchSize = std::max<std::size_t>(size, 1);
+    batchDelay = delay;
+
+    if (!pending.empty()) {
+        flush();
+    }
+}
 
-        const std::string unifiedURL = unifyMapboxURLs(resource.url);
-        putStmt->bind(1 /* url */, unifiedURL.c_str());
-        putStmt->bind(2 /* status */, int(response->status));
-        putStmt->bind(3 /* kind */, int(resource.kind));
-        putStmt->bind(4 /* modified */, response->modified);
-        putStmt->bind(5 /* etag */, response->etag.c_str());
-        putStmt->bind(6 /* expires */, response->expires);
-
-        std::string data;
-        if (resource.kind != Resource::Image) {
-            // Do not compress images, since they are typically compressed already.
-            data = util::compress(response->data);
+void SQLiteCache::Impl::setWriteAheadLog(bool enable) {
+    writeAheadLog = enable;
+
+    if (db) {
+        try {
+            setJournalMode();
+        } catch (mapbox::sqlite::Exception& ex) {
+            Log::Error(Event::Database, ex.code, ex.what());
         }
+    }
+}
 
-        if (!data.empty() && data.size() < response->data.size()) {
-            // Store the compressed data when it is smaller than the original
-            // uncompressed data.
-            putStmt->bind(7 /* data */, data, false); // do not retain the string internally.
-            putStmt->bind(8 /* compressed */, true);
-        } else {
-            putStmt->bind(7 /* data */, response->data, false); // do not retain the string internally.
-            putStmt->bind(8 /* compressed */, false);
+void SQLiteCache::Impl::setMaximumCacheSize(uint64_t size) {
+    maximumSize = size;
+
+    if (maximumSize && db) {
+        try {
+            prune();
+        } catch (mapbox::sqlite::Exception& ex) {
+            Log::Error(Event::Database, ex.code, ex.what());
         }
+    }
+}
 
-        putStmt->run();
+void SQLiteCache::Impl::put(const Resource& resource, std::shared_ptr<const Response> response) {
+    PendingWrite entry;
+    entry.kind = resource.kind;
+    entry.expires = response->expires;
+    entry.response = std::move(response);
+
+    const std::string unifiedURL = unifyMapboxURLs(resource.url);
+    if (batchSize > 1) {
+        pending[unifiedURL] = std::move(entry);
+        scheduleFlush();
+        return;
+    }
+
+    try {
+        write(unifiedURL, entry);
+        if (maximumSize && bytesSincePrune >= maximumSize / 8) {
+            prune();
+        }
     } catch (mapbox::sqlite::Exception& ex) {
         Log::Error(Event::Database, ex.code, ex.what());
     }
 }
 
 void SQLiteCache::Impl::refresh(const Resource& resource, int64_t expires) {
+    const std::string unifiedURL = unifyMapboxURLs(resource.url);
+    if (batchSize > 1) {
+        // Updates the expiry of a queued response, or queues an update of the stored one.
+        PendingWrite& entry = pending[unifiedURL];
+        entry.kind = resource.kind;
+        entry.expires = expires;
+        scheduleFlush();
+        return;
+    }
+
+    PendingWrite entry;
+    entry.kind = resource.kind;
+    entry.expires = expires;
+
+    try {
+        write(unifiedURL, entry);
+    } catch (mapbox::sqlite::Exception& ex) {
+        Log::Error(Event::Database, ex.code, ex.what());
+    }
+}
+
+void SQLiteCache::Impl::scheduleFlush() {
+    if (!flushTimer) {
+        flushTimer = new uv_timer_t;
+        uv_timer_init(loop, flushTimer);
+        flushTimer->data = this;
+        uv_timer_start(flushTimer, onFlushTimeout,
+                       std::chrono::duration_cast<std::chrono::milliseconds>(batchDelay).count(), 0);
+    }
+
+    if (pending.size() >= batchSize) {
+        // Restarting the timer defers the commit to the next loop iteration, so that reads that
+        // are queued already are answered first.
+        uv_timer_start(flushTimer, onFlushTimeout, 0, 0);
+    }
+}
+
+#if UV_VERSION_MAJOR == 0 && UV_VERSION_MINOR <= 10
+void SQLiteCache::Impl::onFlushTimeout(uv_timer_t *timer, int) {
+#else
+void SQLiteCache::Impl::onFlushTimeout(uv_timer_t *timer) {
+#endif
+    reinterpret_cast<Impl*>(timer->data)->flush();
+}
+
+void SQLiteCache::Impl::flush() {
+    if (flushTimer) {
+        uv_timer_stop(flushTimer);
+        uv::close(std::unique_ptr<uv_timer_t>(flushTimer));
+        flushTimer = nullptr;
+    }
+
+    if (pending.empty() && accessed.empty()) {
+        return;
+    }
+
     try {
         if (!db) {
             createDatabase();
@@ -248,6 +460,38 @@ void SQLiteCache::Impl::refresh(const Resource& resource, int64_t expires) {
             createSchema();
         }
 
+        db->exec("BEGIN");
+        try {
+            for (const auto& entry : pending) {
+                write(entry.first, entry.second);
+            }
+            writeAccessTimes();
+            db->exec("COMMIT");
+        } catch (mapbox::sqlite::Exception&) {
+            db->exec("ROLLBACK");
+            throw;
+        }
+
+        if (maximumSize && bytesSincePrune >= maximumSize / 8) {
+            prune();
+        }
+    } catch (mapbox::sqlite::Exception& ex) {
+        Log::Error(Event::Database, ex.code, ex.what());
+    }
+
+    pending.clear();
+}
+
+void SQLiteCache::Impl::write(const std::string& url, const PendingWrite& entry) {
+    if (!db) {
+        createDatabase();
+    }
+
+    if (!schema) {
+        createSchema();
+    }
+
+    if (!entry.response) {
         if (!refreshStmt) {
             refreshStmt = util::make_unique<Statement>( //       1               2
                 db->prepare("UPDATE `http_cache` SET `expires` = ? WHERE `url` = ?"));
@@ -255,13 +499,161 @@ void SQLiteCache::Impl::refresh(const Resource& resource, int64_t expires) {
             refreshStmt->reset();
         }
 
-        const std::string unifiedURL = unifyMapboxURLs(resource.url);
-        refreshStmt->bind(1, int64_t(expires));
-        refreshStmt->bind(2, unifiedURL.c_str());
+        refreshStmt->bind(1, int64_t(entry.expires));
+        refreshStmt->bind(2, url.c_str());
         refreshStmt->run();
+        return;
+    }
+
+    const Response& response = *entry.response;
+
+    if (!putStmt) {
+        putStmt = util::make_unique<Statement>(db->prepare("REPLACE INTO `http_cache` ("
+        //     1       2       3         4         5         6        7          8
+            "`url`, `status`, `kind`, `modified`, `etag`, `expires`, `data`, `compressed`, "
+        //      9         10
+            "`accessed`, `size`) VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"));
+    } else {
+        putStmt->reset();
+    }
+
+    putStmt->bind(1 /* url */, url.c_str());
+    putStmt->bind(2 /* status */, int(response.status));
+    putStmt->bind(3 /* kind */, int(entry.kind));
+    putStmt->bind(4 /* modified */, response.modified);
+    putStmt->bind(5 /* etag */, response.etag.c_str());
+    putStmt->bind(6 /* expires */, entry.expires);
+    putStmt->bind(9 /* accessed */, accessTime());
+
+    static const std::string empty;
+    const std::string& payload = response.data ? *response.data : empty;
+
+    std::string data;
+    if (entry.kind != Resource::Image) {
+        // Do not compress images, since they are typically compressed already.
+        data = util::compress(payload);
+    }
+
+    if (!data.empty() && data.size() < payload.size()) {
+        // Store the compressed data when it is smaller than the original
+        // uncompressed data.
+        putStmt->bind(7 /* data */, data, false); // do not retain the string internally.
+        putStmt->bind(8 /* compressed */, true);
+        putStmt->bind(10 /* size */, int64_t(data.size()));
+        bytesSincePrune += data.size();
+    } else {
+        putStmt->bind(7 /* data */, payload, false); // do not retain the string internally.
+        putStmt->bind(8 /* compressed */, false);
+        putStmt->bind(10 /* size */, int64_t(payload.size()));
+        bytesSincePrune += payload.size();
+    }
+
+    putStmt->run();
+}
+
+int64_t SQLiteCache::Impl::accessTime() {
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                            SystemClock::now().time_since_epoch()).count();
+    lastAccessTime = std::max(now, lastAccessTime + 1);
+    return lastAccessTime;
+}
+
+void SQLiteCache::Impl::writeAccessTimes() {
+    if (!accessStmt) {
+        accessStmt = util::make_unique<Statement>( //             1               2
+            db->prepare("UPDATE `http_cache` SET `accessed` = ? WHERE `url` = ?"));
+    }
+
+    for (const auto& entry : accessed) {
+        accessStmt->reset();
+        accessStmt->bind(1, entry.second);
+        accessStmt->bind(2, entry.first.c_str());
+        accessStmt->run();
+    }
+
+    accessed.clear();
+}
+
+void SQLiteCache::Impl::commitAccessTimes() {
+    try {
+        db->exec("BEGIN");
+        try {
+            writeAccessTimes();
+            db->exec("COMMIT");
+        } catch (mapbox::sqlite::Exception&) {
+            db->exec("ROLLBACK");
+            throw;
+        }
     } catch (mapbox::sqlite::Exception& ex) {
+        // Losing access times only makes the eviction less accurate.
         Log::Error(Event::Database, ex.code, ex.what());
+        accessed.clear();
+    }
+}
+
+uint64_t SQLiteCache::Impl::databaseSize() {
+    Statement pageSizeStmt = db->prepare("PRAGMA page_size");
+    Statement pageCountStmt = db->prepare("PRAGMA page_count");
+    Statement freelistCountStmt = db->prepare("PRAGMA freelist_count");
+    pageSizeStmt.run();
+    pageCountStmt.run();
+    freelistCountStmt.run();
+    return uint64_t(pageSizeStmt.get<int64_t>(0)) *
+           (pageCountStmt.get<int64_t>(0) - freelistCountStmt.get<int64_t>(0));
+}
+
+void SQLiteCache::Impl::prune() {
+    bytesSincePrune = 0;
+
+    if (!schema) {
+        createSchema();
+    }
+
+    // Eviction relies on up to date access times.
+    if (!accessed.empty()) {
+        commitAccessTimes();
+    }
+
+    const uint64_t size = databaseSize();
+    if (size <= maximumSize) {
+        return;
+    }
+
+    // Evicts the least recently used responses until their data makes up for the excess, but
+    // at most 256 at a time so that a single prune doesn't hold up reads for long. Rows take a
+    // bit more space than their data, so this usually frees a bit more than necessary.
+    const uint64_t excess = size - maximumSize;
+    std::vector<std::string> urls;
+    uint64_t evicted = 0;
+    {
+        Statement lruStmt = db->prepare(
+            "SELECT `url`, `size` FROM `http_cache` ORDER BY `accessed` LIMIT 256");
+        while (evicted < excess && lruStmt.run()) {
+            urls.emplace_back(lruStmt.get<std::string>(0));
+            evicted += lruStmt.get<int64_t>(1);
+        }
     }
+
+    if (!evictStmt) {
+        evictStmt = util::make_unique<Statement>(
+            db->prepare("DELETE FROM `http_cache` WHERE `url` = ?"));
+    }
+
+    db->exec("BEGIN");
+    try {
+        for (const auto& url : urls) {
+            evictStmt->reset();
+            evictStmt->bind(1, url.c_str());
+            evictStmt->run();
+        }
+        db->exec("COMMIT");
+    } catch (mapbox::sqlite::Exception&) {
+        db->exec("ROLLBACK");
+        throw;
+    }
+
+    // Returns the freed pages to the file system.
+    db->exec("PRAGMA incremental_vacuum");
 }
 
 }
@@ -2,6 +2,12 @@
 #define MBGL_STORAGE_DEFAULT_SQLITE_CACHE_IMPL
 
 #include <mbgl/storage/sqlite_cache.hpp>
+#include <mbgl/storage/resource.hpp>
+
+#include <uv.h>
+
+#include <string>
+#include <unordered_map>
 
 namespace mapbox {
 namespace sqlite {
@@ -17,20 +23,80 @@ public:
     Impl(const std::string &path = ":memory:");
     ~Impl();
 
-    std::unique_ptr<Response> get(const Resource&);
+    // A response as it is stored. Compressed payloads are inflated by the caller, so that this
+    // thread only does I/O.
+    struct StoredResponse {
+        std::unique_ptr<Response> response;
+        bool compressed = false;
+    };
+
+    StoredResponse get(const Resource&);
     void put(const Resource& resource, std::shared_ptr<const Response> response);
     void refresh(const Resource& resource, int64_t expires);
 
+    void setWriteBatch(uv_loop_t* loop, std::size_t size, Duration delay);
+    void setWriteAheadLog(bool);
+    void setMaximumCacheSize(uint64_t size);
+
+    // Commits all queued writes in a single transaction.
+    void flush();
+
 private:
+    // A queued write. Refreshes of responses that aren't queued don't have a response.
+    struct PendingWrite {
+        Resource::Kind kind = Resource::Unknown;
+        std::shared_ptr<const Response> response;
+        int64_t expires = 0;
+    };
+
     void createDatabase();
     void createSchema();
+    void migrateSchema();
+    void setJournalMode();
+
+    // Returns a timestamp in milliseconds that is later than all previous ones.
+    int64_t accessTime();
+    void writeAccessTimes();
+    void commitAccessTimes();
+
+    uint64_t databaseSize();
+    void prune();
+
+    void write(const std::string& url, const PendingWrite&);
+    void scheduleFlush();
+
+#if UV_VERSION_MAJOR == 0 && UV_VERSION_MINOR <= 10
+    static void onFlushTimeout(uv_timer_t *timer, int status);
+#else
+    static void onFlushTimeout(uv_timer_t *timer);
+#endif
 
     const std::string path;
     std::unique_ptr<::mapbox::sqlite::Database> db;
     std::unique_ptr<::mapbox::sqlite::Statement> getStmt;
     std::unique_ptr<::mapbox::sqlite::Statement> putStmt;
     std::unique_ptr<::mapbox::sqlite::Statement> refreshStmt;
+    std::unique_ptr<::mapbox::sqlite::Statement> accessStmt;
+    std::unique_ptr<::mapbox::sqlite::Statement> evictStmt;
     bool schema = false;
+    bool writeAheadLog = false;
+
+    std::size_t batchSize = 1;
+    Duration batchDelay = Duration::zero();
+
+    // Queued writes by URL. Later writes to the same URL replace earlier ones.
+    std::unordered_map<std::string, PendingWrite> pending;
+
+    // Runs while writes are queued; it's closed when they are committed.
+    uv_loop_t* loop = nullptr;
+    uv_timer_t *flushTimer = nullptr;
+
+    // Access times of responses that were read, by URL. They are written in batches.
+    std::unordered_map<std::string, int64_t> accessed;
+    int64_t lastAccessTime = 0;
+
+    uint64_t maximumSize = 0;
+    uint64_t bytesSincePrune = 0;
 };
 
 
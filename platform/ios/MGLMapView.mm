@@ -566,15 +566,10 @@ mbgl::DefaultFileSource *mbglFileSource = nullptr;
     {
         mbglView->resize(rect.size.width, rect.size.height, view.contentScaleFactor, view.drawableWidth, view.drawableHeight);
 
-        CGFloat zoomFactor   = mbglMap->getMaxZoom() - mbglMap->getMinZoom() + 1;
-        CGFloat cpuFactor    = (CGFloat)[[NSProcessInfo processInfo] processorCount];
-        CGFloat memoryFactor = (CGFloat)[[NSProcessInfo processInfo] physicalMemory] / 1000 / 1000 / 1000;
-        CGFloat sizeFactor   = ((CGFloat)mbglMap->getState().getWidth()  / mbgl::util::tileSize) *
-                               ((CGFloat)mbglMap->getState().getHeight() / mbgl::util::tileSize);
+        // Tiles that left the viewport may use up to 1/16th of the device's memory.
+        NSUInteger cacheBudget = (NSUInteger)([[NSProcessInfo processInfo] physicalMemory] / 16);
 
-        NSUInteger cacheSize = zoomFactor * cpuFactor * memoryFactor * sizeFactor * 0.5;
-
-        mbglMap->setSourceTileCacheSize(cacheSize);
+        mbglMap->setTileCacheBudget(cacheBudget);
 
         mbglMap->renderSync();
     }
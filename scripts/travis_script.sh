@@ -30,6 +30,9 @@ elif [[ ${TRAVIS_OS_NAME} == "linux" ]]; then
     mapbox_time "run_tests" \
     make test-* BUILDTYPE=${BUILDTYPE}
 
+    mapbox_time "run_allocation_tests" \
+    make run-allocations BUILDTYPE=${BUILDTYPE}
+
     mapbox_time "compare_results" \
     ./scripts/compare_images.sh
 
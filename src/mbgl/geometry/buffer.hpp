@@ -4,8 +4,11 @@
 #include <mbgl/platform/gl.hpp>
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <cassert>
 #include <stdexcept>
 
@@ -37,6 +40,38 @@ public:
         return pos == 0;
     }
 
+    // Returns the number of elements that fit into the memory allocated for this buffer.
+    inline size_t capacity() const {
+        return length / itemSize;
+    }
+
+    // Makes room for at least the given number of additional elements, so that adding them
+    // doesn't reallocate. Builders that know how much they're going to add call this first.
+    inline void reserve(size_t count) {
+        if (length < pos + count * itemSize) {
+            grow(pos + count * itemSize);
+        }
+    }
+
+    // Appends the elements of another buffer from the given index on.
+    void appendFrom(const Buffer& other, size_t first = 0) {
+        const size_t count = other.index() - first;
+        if (count) {
+            std::memcpy(addElements(count), reinterpret_cast<const char *>(other.array) + first * itemSize,
+                        count * itemSize);
+        }
+    }
+
+    // Returns the number of bytes allocated for this buffer in main memory.
+    inline size_t clientBytes() const {
+        return array ? length : 0;
+    }
+
+    // Returns the number of bytes that were transferred to the GPU.
+    inline size_t serverBytes() const {
+        return buffer ? pos : 0;
+    }
+
     // Transfers this buffer to the GPU and binds the buffer to the GL context.
     void bind(bool force = false) {
         if (buffer == 0) {
@@ -50,6 +85,7 @@ public:
             }
 
             MBGL_CHECK_ERROR(glBufferData(bufferType, pos, array, GL_STATIC_DRAW));
+            Environment::Get().getMetrics().uploaded(pos);
             if (!retainAfterUpload) {
                 cleanup();
             }
@@ -60,6 +96,7 @@ public:
         if (array) {
             free(array);
             array = nullptr;
+            length = 0;
         }
     }
 
@@ -68,20 +105,22 @@ public:
     }
 
 protected:
-    // increase the buffer size by at least /required/ bytes.
+    // Returns the memory for a new element, which the caller fills in.
     inline void *addElement() {
-        if (buffer != 0) {
-            throw std::runtime_error("Can't add elements after buffer was bound to GPU");
-        }
-        if (length < pos + itemSize) {
-            while (length < pos + itemSize) length += defaultLength;
-            array = realloc(array, length);
-            if (array == nullptr) {
-                throw std::runtime_error("Buffer reallocation failed");
-            }
+        return addElements(1);
+    }
+
+    // Returns the memory for the given number of consecutive new elements, which the caller
+    // fills in.
+    inline void *addElements(size_t count) {
+        assert(buffer == 0);
+        const size_t required = pos + count * itemSize;
+        if (length < required) {
+            grow(required);
         }
-        pos += itemSize;
-        return reinterpret_cast<char *>(array) + (pos - itemSize);
+        void *elements = reinterpret_cast<char *>(array) + pos;
+        pos = required;
+        return elements;
     }
 
     // Get a pointer to the item at a given index.
@@ -101,6 +140,19 @@ public:
     static const size_t itemSize = item_size;
 
 private:
+    // Grows the buffer geometrically, so that adding elements one by one takes amortized
+    // constant time.
+    void grow(size_t required) {
+        if (buffer != 0) {
+            throw std::runtime_error("Can't add elements after buffer was bound to GPU");
+        }
+        length = std::max(required, std::max(length * 2, defaultLength));
+        array = realloc(array, length);
+        if (array == nullptr) {
+            throw std::runtime_error("Buffer reallocation failed");
+        }
+    }
+
     // CPU buffer
     void *array = nullptr;
 
@@ -0,0 +1,497 @@
+#include <mbgl/geometry/earcut.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+namespace mbgl {
+
+namespace {
+
+// Twice the signed area of the ring.
+double signedArea(const ClipperLib::Path& ring) {
+    double sum = 0;
+    for (std::size_t i = 0, j = ring.size() - 1; i < ring.size(); j = i++) {
+        sum += double(ring[j].X - ring[i].X) * double(ring[i].Y + ring[j].Y);
+    }
+    return sum;
+}
+
+}
+
+bool Earcut::operator()(RingIterator begin, RingIterator end, uint32_t offset,
+                        std::vector<uint32_t>& indices) {
+    assert(begin != end);
+
+    std::size_t size = 0;
+    double polygonArea = std::abs(signedArea(*begin));
+    for (auto ring = begin; ring != end; ++ring) {
+        size += ring->size();
+        if (ring != begin) {
+            polygonArea -= std::abs(signedArea(*ring));
+        }
+    }
+
+    nodes.clear();
+    nodes.reserve(size + 2 * (end - begin - 1));
+    triangleArea = 0;
+
+    const std::size_t start = indices.size();
+    Node* outer = linkedList(*begin, offset, true);
+
+    if (outer && outer->next != outer->prev) {
+        if (begin + 1 != end) {
+            outer = eliminateHoles(begin + 1, end, offset + uint32_t(begin->size()), outer);
+        }
+
+        // Polygons with few vertices are faster to triangulate without the hash.
+        hashed = size > 80;
+        if (hashed) {
+            double maxX = minX = double(begin->front().X);
+            double maxY = minY = double(begin->front().Y);
+            for (auto ring = begin; ring != end; ++ring) {
+                for (const auto& pt : *ring) {
+                    minX = std::min(minX, double(pt.X));
+                    minY = std::min(minY, double(pt.Y));
+                    maxX = std::max(maxX, double(pt.X));
+                    maxY = std::max(maxY, double(pt.Y));
+                }
+            }
+            invSize = std::max(maxX - minX, maxY - minY);
+            invSize = invSize != 0 ? 32767 / invSize : 0;
+        }
+
+        if (!earcutLinked(outer, indices, 0)) {
+            indices.resize(start);
+            return false;
+        }
+    }
+
+    // The triangles of a valid polygon cover exactly its area. Vertex coordinates are integers,
+    // so the areas are exact. Rings that intersect each other or themselves end up with
+    // overlapping or missing triangles instead.
+    if (triangleArea != polygonArea) {
+        indices.resize(start);
+        return false;
+    }
+
+    return true;
+}
+
+#pragma mark - Linked list
+
+Earcut::Node* Earcut::linkedList(const ClipperLib::Path& ring, uint32_t offset, bool clockwise) {
+    Node* last = nullptr;
+
+    if (clockwise == (signedArea(ring) > 0)) {
+        for (std::size_t i = 0; i < ring.size(); i++) {
+            last = insertNode(offset + uint32_t(i), ring[i], last);
+        }
+    } else {
+        for (std::size_t i = ring.size(); i-- > 0;) {
+            last = insertNode(offset + uint32_t(i), ring[i], last);
+        }
+    }
+
+    if (last && equals(last, last->next)) {
+        removeNode(last);
+        last = last->next;
+    }
+
+    return last;
+}
+
+Earcut::Node* Earcut::insertNode(uint32_t i, const ClipperLib::IntPoint& pt, Node* last) {
+    assert(nodes.size() < nodes.capacity());
+    nodes.emplace_back(i, double(pt.X), double(pt.Y));
+    Node* p = &nodes.back();
+
+    if (!last) {
+        p->prev = p;
+        p->next = p;
+    } else {
+        p->next = last->next;
+        p->prev = last;
+        last->next->prev = p;
+        last->next = p;
+    }
+    return p;
+}
+
+void Earcut::removeNode(Node* p) {
+    p->next->prev = p->prev;
+    p->prev->next = p->next;
+
+    if (p->prevZ) p->prevZ->nextZ = p->nextZ;
+    if (p->nextZ) p->nextZ->prevZ = p->prevZ;
+}
+
+// Removes duplicate and collinear points.
+Earcut::Node* Earcut::filterPoints(Node* start, Node* end) {
+    if (!start) return start;
+    if (!end) end = start;
+
+    Node* p = start;
+    bool again;
+    do {
+        again = false;
+
+        if (equals(p, p->next) || area(p->prev, p, p->next) == 0) {
+            removeNode(p);
+            p = end = p->prev;
+            if (p == p->next) break;
+            again = true;
+        } else {
+            p = p->next;
+        }
+    } while (again || p != end);
+
+    return end;
+}
+
+#pragma mark - Ear clipping
+
+bool Earcut::earcutLinked(Node* ear, std::vector<uint32_t>& indices, int pass) {
+    if (!ear) return true;
+
+    if (!pass && hashed) indexCurve(ear);
+
+    Node* stop = ear;
+    while (ear->prev != ear->next) {
+        Node* prev = ear->prev;
+        Node* next = ear->next;
+
+        if (hashed ? isEarHashed(ear) : isEar(ear)) {
+            indices.push_back(prev->i);
+            indices.push_back(ear->i);
+            indices.push_back(next->i);
+            triangleArea -= area(prev, ear, next);
+
+            removeNode(ear);
+
+            // Skipping the next vertex leads to less sliver triangles.
+            ear = next->next;
+            stop = next->next;
+            continue;
+        }
+
+        ear = next;
+
+        // We went around the ring without finding an ear. Remove collinear points and try once
+        // more. earcut.js goes on to cure local self-intersections and to split the polygon,
+        // which isn't needed for valid polygons; we hand the others to libtess2 instead.
+        if (ear == stop) {
+            return !pass && earcutLinked(filterPoints(ear), indices, 1);
+        }
+    }
+
+    return true;
+}
+
+bool Earcut::isEar(Node* ear) const {
+    const Node* a = ear->prev;
+    const Node* b = ear;
+    const Node* c = ear->next;
+
+    // Reflex, can't be an ear.
+    if (area(a, b, c) >= 0) return false;
+
+    // Make sure that no other point is inside the ear.
+    for (const Node* p = ear->next->next; p != ear->prev; p = p->next) {
+        if (pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+            area(p->prev, p, p->next) >= 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Earcut::isEarHashed(Node* ear) const {
+    const Node* a = ear->prev;
+    const Node* b = ear;
+    const Node* c = ear->next;
+
+    if (area(a, b, c) >= 0) return false;
+
+    // Only the points within the bounding box of the triangle are candidates, and they're
+    // within its range on the z-order curve.
+    const int32_t minZ = zOrder(std::min({ a->x, b->x, c->x }), std::min({ a->y, b->y, c->y }));
+    const int32_t maxZ = zOrder(std::max({ a->x, b->x, c->x }), std::max({ a->y, b->y, c->y }));
+
+    const auto inside = [&](const Node* p) {
+        return p != ear->prev && p != ear->next &&
+               pointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) &&
+               area(p->prev, p, p->next) >= 0;
+    };
+
+    // Look in both directions at once, then in the one that remains.
+    const Node* p = ear->prevZ;
+    const Node* n = ear->nextZ;
+    while (p && p->z >= minZ && n && n->z <= maxZ) {
+        if (inside(p)) return false;
+        p = p->prevZ;
+        if (inside(n)) return false;
+        n = n->nextZ;
+    }
+    for (; p && p->z >= minZ; p = p->prevZ) {
+        if (inside(p)) return false;
+    }
+    for (; n && n->z <= maxZ; n = n->nextZ) {
+        if (inside(n)) return false;
+    }
+
+    return true;
+}
+
+#pragma mark - Holes
+
+Earcut::Node* Earcut::eliminateHoles(RingIterator begin, RingIterator end, uint32_t offset,
+                                     Node* outer) {
+    holes.clear();
+    for (auto ring = begin; ring != end; ++ring) {
+        Node* list = linkedList(*ring, offset, false);
+        offset += uint32_t(ring->size());
+        if (list) {
+            holes.push_back(getLeftmost(list));
+        }
+    }
+
+    // Bridge the holes from left to right, so that later bridges may pass through earlier holes.
+    std::sort(holes.begin(), holes.end(), [](const Node* a, const Node* b) {
+        return a->x < b->x;
+    });
+
+    for (Node* hole : holes) {
+        outer = eliminateHole(hole, outer);
+    }
+
+    return outer;
+}
+
+Earcut::Node* Earcut::eliminateHole(Node* hole, Node* outer) {
+    Node* bridge = findHoleBridge(hole, outer);
+    if (!bridge) {
+        return outer;
+    }
+
+    Node* bridgeReverse = splitPolygon(bridge, hole);
+    filterPoints(bridgeReverse, bridgeReverse->next);
+    return filterPoints(bridge, bridge->next);
+}
+
+// David Eberly's algorithm for finding a bridge between a hole and the outer ring.
+Earcut::Node* Earcut::findHoleBridge(Node* hole, Node* outer) {
+    Node* p = outer;
+    const double hx = hole->x;
+    const double hy = hole->y;
+    double qx = -std::numeric_limits<double>::infinity();
+    Node* m = nullptr;
+
+    // Find the segment of the outer ring that is left of the hole point and closest to it on
+    // the horizontal ray through it.
+    do {
+        if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
+            const double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+            if (x <= hx && x > qx) {
+                qx = x;
+                m = p->x < p->next->x ? p : p->next;
+                if (x == hx) {
+                    // The hole touches the outer ring.
+                    return m;
+                }
+            }
+        }
+        p = p->next;
+    } while (p != outer);
+
+    if (!m) return nullptr;
+
+    // Look for points inside the triangle of the hole point, the intersection and the endpoint
+    // of the segment. If there are any, the one with the smallest angle to the ray is the
+    // connection point, as nothing can block the way to it.
+    const Node* stop = m;
+    const double mx = m->x;
+    const double my = m->y;
+    double tanMin = std::numeric_limits<double>::infinity();
+
+    p = m;
+    do {
+        if (hx >= p->x && p->x >= mx && hx != p->x &&
+            pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+            const double tan = std::abs(hy - p->y) / (hx - p->x);
+            if (locallyInside(p, hole) &&
+                (tan < tanMin || (tan == tanMin && (p->x > m->x ||
+                                                    (p->x == m->x && sectorContainsSector(m, p)))))) {
+                m = p;
+                tanMin = tan;
+            }
+        }
+        p = p->next;
+    } while (p != stop);
+
+    return m;
+}
+
+// Links a and b with a bridge. The polygon is split in two if they're on the same ring, or
+// the rings are joined if they aren't. Returns the second copy of b.
+Earcut::Node* Earcut::splitPolygon(Node* a, Node* b) {
+    assert(nodes.size() + 2 <= nodes.capacity());
+    nodes.emplace_back(a->i, a->x, a->y);
+    Node* a2 = &nodes.back();
+    nodes.emplace_back(b->i, b->x, b->y);
+    Node* b2 = &nodes.back();
+
+    Node* an = a->next;
+    Node* bp = b->prev;
+
+    a->next = b;
+    b->prev = a;
+
+    a2->next = an;
+    an->prev = a2;
+
+    b2->next = a2;
+    a2->prev = b2;
+
+    bp->next = b2;
+    b2->prev = bp;
+
+    return b2;
+}
+
+Earcut::Node* Earcut::getLeftmost(Node* start) {
+    Node* p = start;
+    Node* leftmost = start;
+    do {
+        if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y)) {
+            leftmost = p;
+        }
+        p = p->next;
+    } while (p != start);
+
+    return leftmost;
+}
+
+#pragma mark - Z-order hash
+
+void Earcut::indexCurve(Node* start) {
+    Node* p = start;
+    do {
+        if (p->z < 0) p->z = zOrder(p->x, p->y);
+        p->prevZ = p->prev;
+        p->nextZ = p->next;
+        p = p->next;
+    } while (p != start);
+
+    p->prevZ->nextZ = nullptr;
+    p->prevZ = nullptr;
+
+    sortLinked(p);
+}
+
+// Simon Tatham's linked list merge sort.
+Earcut::Node* Earcut::sortLinked(Node* list) {
+    int inSize = 1;
+    int numMerges;
+
+    do {
+        Node* p = list;
+        Node* tail = nullptr;
+        list = nullptr;
+        numMerges = 0;
+
+        while (p) {
+            numMerges++;
+
+            Node* q = p;
+            int pSize = 0;
+            for (int i = 0; i < inSize; i++) {
+                pSize++;
+                q = q->nextZ;
+                if (!q) break;
+            }
+
+            int qSize = inSize;
+            while (pSize > 0 || (qSize > 0 && q)) {
+                Node* e;
+                if (pSize != 0 && (qSize == 0 || !q || p->z <= q->z)) {
+                    e = p;
+                    p = p->nextZ;
+                    pSize--;
+                } else {
+                    e = q;
+                    q = q->nextZ;
+                    qSize--;
+                }
+
+                if (tail) {
+                    tail->nextZ = e;
+                } else {
+                    list = e;
+                }
+
+                e->prevZ = tail;
+                tail = e;
+            }
+
+            p = q;
+        }
+
+        tail->nextZ = nullptr;
+        inSize *= 2;
+    } while (numMerges > 1);
+
+    return list;
+}
+
+// Interleaves the bits of the coordinates, scaled to 15 bits each.
+int32_t Earcut::zOrder(double x_, double y_) const {
+    int32_t x = int32_t((x_ - minX) * invSize);
+    int32_t y = int32_t((y_ - minY) * invSize);
+
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+
+    y = (y | (y << 8)) & 0x00FF00FF;
+    y = (y | (y << 4)) & 0x0F0F0F0F;
+    y = (y | (y << 2)) & 0x33333333;
+    y = (y | (y << 1)) & 0x55555555;
+
+    return x | (y << 1);
+}
+
+#pragma mark - Geometry
+
+// Twice the signed area of the triangle.
+double Earcut::area(const Node* p, const Node* q, const Node* r) {
+    return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+}
+
+bool Earcut::equals(const Node* p1, const Node* p2) {
+    return p1->x == p2->x && p1->y == p2->y;
+}
+
+bool Earcut::pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy,
+                             double px, double py) {
+    return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+           (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+           (bx - px) * (cy - py) >= (cx - px) * (by - py);
+}
+
+// Whether the diagonal from a to b is inside the polygon near a.
+bool Earcut::locallyInside(const Node* a, const Node* b) {
+    return area(a->prev, a, a->next) < 0 ?
+        area(a, b, a->next) >= 0 && area(a, a->prev, b) >= 0 :
+        area(a, b, a->prev) < 0 || area(a, a->next, b) < 0;
+}
+
+// Whether the sector in vertex m contains the sector in vertex p in the same coordinates.
+bool Earcut::sectorContainsSector(const Node* m, const Node* p) {
+    return area(m->prev, m, p->prev) < 0 && area(p->next, m, m->next) < 0;
+}
+
+}
@@ -0,0 +1,86 @@
+#ifndef MBGL_GEOMETRY_EARCUT
+#define MBGL_GEOMETRY_EARCUT
+
+#include <clipper/clipper.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace mbgl {
+
+// Triangulates polygons with holes by ear clipping, following earcut.js: holes are joined to
+// the outer ring with bridges, and large polygons are indexed along a z-order curve so that
+// the ear tests only visit nearby vertices. It doesn't create new vertices, and unlike libtess2
+// it doesn't resolve self-intersections. Rings that intersect are detected instead, by
+// comparing the area of the triangles with the area of the polygon.
+class Earcut {
+public:
+    typedef std::vector<ClipperLib::Path>::const_iterator RingIterator;
+
+    // Triangulates the polygon whose outer ring is *begin and whose holes are the rings that
+    // follow it. Vertices are numbered in ring order, starting at offset, and the triangles are
+    // appended to indices. Returns false and leaves indices untouched if the rings don't form
+    // a valid polygon.
+    bool operator()(RingIterator begin, RingIterator end, uint32_t offset,
+                    std::vector<uint32_t>& indices);
+
+private:
+    struct Node {
+        Node(uint32_t i_, double x_, double y_) : i(i_), x(x_), y(y_) {}
+
+        const uint32_t i;
+        const double x;
+        const double y;
+
+        // Neighbors in the polygon ring.
+        Node* prev = nullptr;
+        Node* next = nullptr;
+
+        // Neighbors along the z-order curve.
+        int32_t z = -1;
+        Node* prevZ = nullptr;
+        Node* nextZ = nullptr;
+    };
+
+    Node* linkedList(const ClipperLib::Path&, uint32_t offset, bool clockwise);
+    Node* insertNode(uint32_t i, const ClipperLib::IntPoint&, Node* last);
+    static void removeNode(Node*);
+    static Node* filterPoints(Node* start, Node* end = nullptr);
+
+    bool earcutLinked(Node* ear, std::vector<uint32_t>& indices, int pass);
+    bool isEar(Node* ear) const;
+    bool isEarHashed(Node* ear) const;
+
+    Node* eliminateHoles(RingIterator begin, RingIterator end, uint32_t offset, Node* outer);
+    Node* eliminateHole(Node* hole, Node* outer);
+    static Node* findHoleBridge(Node* hole, Node* outer);
+    Node* splitPolygon(Node* a, Node* b);
+    static Node* getLeftmost(Node* start);
+
+    void indexCurve(Node* start);
+    static Node* sortLinked(Node* list);
+    int32_t zOrder(double x, double y) const;
+
+    static double area(const Node* p, const Node* q, const Node* r);
+    static bool equals(const Node* p1, const Node* p2);
+    static bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy,
+                                double px, double py);
+    static bool locallyInside(const Node* a, const Node* b);
+    static bool sectorContainsSector(const Node* m, const Node* p);
+
+    // Scratch space kept across polygons. Every hole adds two vertices for its bridge, and the
+    // vector is reserved up front so that the nodes never move while they're linked.
+    std::vector<Node> nodes;
+    std::vector<Node*> holes;
+
+    // Bounding box of the polygon for the z-order hash, which isn't used for small polygons.
+    bool hashed = false;
+    double minX = 0, minY = 0, invSize = 0;
+
+    // Twice the area covered by the triangles so far.
+    double triangleArea = 0;
+};
+
+}
+
+#endif
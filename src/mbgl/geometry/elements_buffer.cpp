@@ -9,13 +9,25 @@ void TriangleElementsBuffer::add(element_type a, element_type b, element_type c)
     elements[2] = c;
 }
 
+TriangleElementsBuffer::element_type *TriangleElementsBuffer::append(size_t count) {
+    return static_cast<element_type *>(addElements(count));
+}
+
 void LineElementsBuffer::add(element_type a, element_type b) {
     element_type *elements = static_cast<element_type *>(addElement());
     elements[0] = a;
     elements[1] = b;
 }
 
+LineElementsBuffer::element_type *LineElementsBuffer::append(size_t count) {
+    return static_cast<element_type *>(addElements(count));
+}
+
 void PointElementsBuffer::add(element_type a) {
     uint16_t *data = static_cast<element_type *>(addElement());
     data[0] = a;
 }
+
+PointElementsBuffer::element_type *PointElementsBuffer::append(size_t count) {
+    return static_cast<element_type *>(addElements(count));
+}
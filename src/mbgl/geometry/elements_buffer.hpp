@@ -31,6 +31,9 @@ public:
     typedef uint16_t element_type;
 
     void add(element_type a, element_type b, element_type c);
+
+    // Adds count triangles at once, and returns their elements for the caller to fill in.
+    element_type *append(size_t count);
 };
 
 
@@ -42,6 +45,9 @@ public:
     typedef uint16_t element_type;
 
     void add(element_type a, element_type b);
+
+    // Adds count lines at once, and returns their elements for the caller to fill in.
+    element_type *append(size_t count);
 };
 
 class PointElementsBuffer : public Buffer<
@@ -52,6 +58,9 @@ public:
     typedef uint16_t element_type;
 
     void add(element_type a);
+
+    // Adds count points at once, and returns their elements for the caller to fill in.
+    element_type *append(size_t count);
 };
 
 }
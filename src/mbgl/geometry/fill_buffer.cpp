@@ -11,3 +11,7 @@ void FillVertexBuffer::add(vertex_type x, vertex_type y) {
     vertices[0] = x;
     vertices[1] = y;
 }
+
+FillVertexBuffer::vertex_type *FillVertexBuffer::append(size_t count) {
+    return static_cast<vertex_type *>(addElements(count));
+}
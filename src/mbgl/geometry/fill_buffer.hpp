@@ -14,6 +14,9 @@ public:
     typedef int16_t vertex_type;
 
     void add(vertex_type x, vertex_type y);
+
+    // Adds count vertices at once, and returns their coordinates for the caller to fill in.
+    vertex_type *append(size_t count);
 };
 
 }
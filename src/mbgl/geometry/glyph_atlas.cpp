@@ -1,4 +1,6 @@
 #include <mbgl/geometry/glyph_atlas.hpp>
+#include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 
 #include <mbgl/platform/gl.hpp>
 #include <mbgl/platform/log.hpp>
@@ -6,62 +8,146 @@
 
 #include <cassert>
 #include <algorithm>
+#include <vector>
 
 
 using namespace mbgl;
 
+constexpr std::size_t GlyphAtlas::maxFaces;
+constexpr std::size_t GlyphAtlas::shardCount;
+
+GlyphAtlas::Face::Face() {
+    for (auto& block : blocks) {
+        block = nullptr;
+    }
+}
+
+GlyphAtlas::Face::~Face() {
+    for (auto& block : blocks) {
+        delete block.load();
+    }
+}
+
 GlyphAtlas::GlyphAtlas(uint16_t width_, uint16_t height_)
     : width(width_),
       height(height_),
       bin(width_, height_),
       data(new char[width_ *height_]),
       dirty(true) {
+    for (auto& face : faces) {
+        face = nullptr;
+    }
+}
+
+GlyphAtlas::~GlyphAtlas() {
+    for (auto& face : faces) {
+        delete face.load();
+    }
+}
+
+GlyphAtlas::Face* GlyphAtlas::getFace(uint32_t stackID) {
+    if (stackID >= maxFaces) {
+        return nullptr;
+    }
+
+    Face* face = faces[stackID].load(std::memory_order_acquire);
+    if (!face) {
+        std::lock_guard<std::mutex> lock(mtx);
+        face = faces[stackID].load(std::memory_order_relaxed);
+        if (!face) {
+            face = new Face;
+            faces[stackID].store(face, std::memory_order_release);
+        }
+    }
+
+    return face;
+}
+
+GlyphAtlas::GlyphValue& GlyphAtlas::getValue(Face& face, uint32_t glyph) {
+    std::atomic<Block*>& slot = face.blocks[glyph / FontStack::blockSize];
+
+    Block* block = slot.load(std::memory_order_acquire);
+    if (!block) {
+        std::lock_guard<std::mutex> lock(mtx);
+        block = slot.load(std::memory_order_relaxed);
+        if (!block) {
+            block = new Block;
+            slot.store(block, std::memory_order_release);
+        }
+    }
+
+    return (*block)[glyph % FontStack::blockSize];
+}
+
+GlyphAtlas::Shard& GlyphAtlas::getShard(uintptr_t tileUID) {
+    // Tile UIDs are addresses, so the lowest bits are mostly the same.
+    return shards[(tileUID >> 4) % shardCount];
 }
 
 void GlyphAtlas::addGlyphs(uintptr_t tileUID,
                            const std::u32string& text,
-                           const std::string& stackName,
                            const FontStack& fontStack,
                            GlyphPositions& face)
 {
-    std::lock_guard<std::mutex> lock(mtx);
+    Face* atlasFace = getFace(fontStack.getID());
+    if (!atlasFace) {
+        Log::Error(Event::OpenGL, "too many font stacks in glyph atlas");
+        return;
+    }
 
-    const std::map<uint32_t, SDFGlyph>& sdfs = fontStack.getSDFs();
+    Shard& shard = getShard(tileUID);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    std::unordered_set<GlyphValue*>& used = shard.tiles[tileUID];
 
     for (uint32_t chr : text)
     {
-        auto sdf_it = sdfs.find(chr);
-        if (sdf_it == sdfs.end()) {
+        const SDFGlyph* sdf = fontStack.getGlyph(chr);
+        if (!sdf) {
+            continue;
+        }
+
+        // The glyph bitmap has zero width.
+        if (!sdf->bitmap.size()) {
+            face.emplace(chr, Glyph{ Rect<uint16_t>{ 0, 0, 0, 0 }, sdf->metrics });
             continue;
         }
 
-        const SDFGlyph& sdf = sdf_it->second;
-        Rect<uint16_t> rect = addGlyph(tileUID, stackName, sdf);
-        face.emplace(chr, Glyph{rect, sdf.metrics});
+        GlyphValue& value = getValue(*atlasFace, chr);
+
+        // The tile's own reference keeps the glyph in place, so its rect can be read directly.
+        if (used.find(&value) != used.end() || acquire(value) || addGlyph(value, *sdf)) {
+            used.insert(&value);
+            face.emplace(chr, Glyph{ value.rect, sdf->metrics });
+        } else {
+            face.emplace(chr, Glyph{ Rect<uint16_t>{ 0, 0, 0, 0 }, sdf->metrics });
+        }
     }
 }
 
-Rect<uint16_t> GlyphAtlas::addGlyph(uintptr_t tileUID,
-                                    const std::string& stackName,
-                                    const SDFGlyph& glyph)
-{
-    // Use constant value for now.
-    const uint8_t buffer = 3;
+bool GlyphAtlas::acquire(GlyphValue& value) {
+    uint32_t refs = value.refs.load(std::memory_order_relaxed);
+    while (refs > 0) {
+        if (value.refs.compare_exchange_weak(refs, refs + 1, std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-    std::map<uint32_t, GlyphValue>& face = index[stackName];
-    std::map<uint32_t, GlyphValue>::iterator it = face.find(glyph.id);
+bool GlyphAtlas::addGlyph(GlyphValue& value, const SDFGlyph& glyph)
+{
+    std::lock_guard<std::mutex> lock(mtx);
 
-    // The glyph is already in this texture.
-    if (it != face.end()) {
-        GlyphValue& value = it->second;
-        value.ids.insert(tileUID);
-        return value.rect;
+    // The glyph is already in this texture, but was either just added by another thread, or
+    // hasn't been released yet after its last tile went away.
+    if (value.allocated) {
+        value.refs.fetch_add(1, std::memory_order_acquire);
+        return true;
     }
 
-    // The glyph bitmap has zero width.
-    if (!glyph.bitmap.size()) {
-        return Rect<uint16_t>{ 0, 0, 0, 0 };
-    }
+    // Use constant value for now.
+    const uint8_t buffer = 3;
 
     uint16_t buffered_width = glyph.metrics.width + buffer * 2;
     uint16_t buffered_height = glyph.metrics.height + buffer * 2;
@@ -79,14 +165,12 @@ Rect<uint16_t> GlyphAtlas::addGlyph(uintptr_t tileUID,
     Rect<uint16_t> rect = bin.allocate(pack_width, pack_height);
     if (rect.w == 0) {
         Log::Error(Event::OpenGL, "glyph bitmap overflow");
-        return rect;
+        return false;
     }
 
     assert(rect.x + rect.w <= width);
     assert(rect.y + rect.h <= height);
 
-    face.emplace(glyph.id, GlyphValue { rect, tileUID });
-
     // Copy the bitmap
     char *target = data.get();
     const char *source = glyph.bitmap.data();
@@ -100,43 +184,62 @@ Rect<uint16_t> GlyphAtlas::addGlyph(uintptr_t tileUID,
 
     dirty = true;
 
-    return rect;
+    // Publishing the first reference makes the rect visible to acquire().
+    value.rect = rect;
+    value.allocated = true;
+    value.refs.store(1, std::memory_order_release);
+
+    return true;
 }
 
 void GlyphAtlas::removeGlyphs(uintptr_t tileUID) {
+    std::unordered_set<GlyphValue*> used;
+
+    {
+        Shard& shard = getShard(tileUID);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.tiles.find(tileUID);
+        if (it == shard.tiles.end()) {
+            return;
+        }
+        used = std::move(it->second);
+        shard.tiles.erase(it);
+    }
+
+    std::vector<GlyphValue*> unused;
+    for (GlyphValue* value : used) {
+        if (value->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            unused.push_back(value);
+        }
+    }
+
+    if (unused.empty()) {
+        return;
+    }
+
     std::lock_guard<std::mutex> lock(mtx);
 
-    for (auto& faces : index) {
-        std::map<uint32_t, GlyphValue>& face = faces.second;
-        for (auto it = face.begin(); it != face.end(); /* we advance in the body */) {
-            GlyphValue& value = it->second;
-            value.ids.erase(tileUID);
-
-            if (!value.ids.size()) {
-                const Rect<uint16_t>& rect = value.rect;
-
-                // Clear out the bitmap.
-                char *target = data.get();
-                for (uint32_t y = 0; y < rect.h; y++) {
-                    uint32_t y1 = width * (rect.y + y) + rect.x;
-                    for (uint32_t x = 0; x < rect.w; x++) {
-                        target[y1 + x] = 0;
-                    }
-                }
-
-                dirty = true;
-
-                bin.release(rect);
-
-                // Make sure to post-increment the iterator: This will return the
-                // current iterator, but will go to the next position before we
-                // erase the element from the map. That way, the iterator stays
-                // valid.
-                face.erase(it++);
-            } else {
-                ++it;
+    for (GlyphValue* value : unused) {
+        // Another tile may have picked the glyph up again in the meantime.
+        if (value->refs.load(std::memory_order_relaxed) > 0 || !value->allocated) {
+            continue;
+        }
+
+        const Rect<uint16_t>& rect = value->rect;
+
+        // Clear out the bitmap.
+        char *target = data.get();
+        for (uint32_t y = 0; y < rect.h; y++) {
+            uint32_t y1 = width * (rect.y + y) + rect.x;
+            for (uint32_t x = 0; x < rect.w; x++) {
+                target[y1 + x] = 0;
             }
         }
+
+        dirty = true;
+
+        bin.release(rect);
+        value->allocated = false;
     }
 }
 
@@ -158,6 +261,7 @@ void GlyphAtlas::bind() {
     if (dirty) {
         std::lock_guard<std::mutex> lock(mtx);
         MBGL_CHECK_ERROR(glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, width, height, 0, GL_ALPHA, GL_UNSIGNED_BYTE, data.get()));
+        Environment::Get().getMetrics().uploaded(width * height);
         dirty = false;
 
 #if defined(DEBUG)
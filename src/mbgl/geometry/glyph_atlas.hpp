@@ -6,20 +6,25 @@
 #include <mbgl/util/noncopyable.hpp>
 
 #include <string>
-#include <set>
-#include <map>
+#include <array>
+#include <unordered_map>
+#include <unordered_set>
 #include <mutex>
 #include <atomic>
 
 namespace mbgl {
 
+// Glyphs that are already in the atlas are resolved without taking the atlas lock, so that
+// workers placing labels in different tiles don't serialize on each other. Only glyphs that need
+// to be copied into the texture, and glyphs that are released by the last tile using them, go
+// through the lock. All font stacks must come from the same GlyphStore.
 class GlyphAtlas : public util::noncopyable {
 public:
     GlyphAtlas(uint16_t width, uint16_t height);
+    ~GlyphAtlas();
 
     void addGlyphs(uintptr_t tileUID,
                    const std::u32string& text,
-                   const std::string& stackName,
                    const FontStack&,
                    GlyphPositions&);
     void removeGlyphs(uintptr_t tileUID);
@@ -31,19 +36,47 @@ public:
 
 private:
     struct GlyphValue {
-        GlyphValue(const Rect<uint16_t>& rect_, uintptr_t id)
-            : rect(rect_), ids({ id }) {}
         Rect<uint16_t> rect;
-        std::set<uintptr_t> ids;
+
+        // The number of tiles using this glyph. Once it drops to zero, the glyph may only be
+        // reused or released while holding the atlas lock.
+        std::atomic<uint32_t> refs { 0 };
+
+        // Whether the glyph currently occupies space in the texture. Guarded by the atlas lock.
+        bool allocated = false;
+    };
+
+    using Block = std::array<GlyphValue, FontStack::blockSize>;
+
+    struct Face {
+        Face();
+        ~Face();
+        std::array<std::atomic<Block*>, FontStack::blockCount> blocks;
     };
 
-    Rect<uint16_t> addGlyph(uintptr_t tileID,
-                            const std::string& stackName,
-                            const SDFGlyph&);
+    // The glyphs each tile holds a reference to. Tiles are spread across shards so that removing
+    // one tile doesn't block workers that are placing another.
+    struct Shard {
+        std::mutex mtx;
+        std::unordered_map<uintptr_t, std::unordered_set<GlyphValue*>> tiles;
+    };
+
+    static constexpr std::size_t maxFaces = 256;
+    static constexpr std::size_t shardCount = 16;
+
+    Face* getFace(uint32_t stackID);
+    GlyphValue& getValue(Face&, uint32_t glyph);
+    Shard& getShard(uintptr_t tileUID);
+
+    // Adds a reference to a glyph that is already in the texture. Returns false if the glyph
+    // isn't referenced by any tile, in which case it has to go through addGlyph().
+    static bool acquire(GlyphValue&);
+    bool addGlyph(GlyphValue&, const SDFGlyph&);
 
     std::mutex mtx;
     BinPack<uint16_t> bin;
-    std::map<std::string, std::map<uint32_t, GlyphValue>> index;
+    std::array<std::atomic<Face*>, maxFaces> faces;
+    std::array<Shard, shardCount> shards;
     std::unique_ptr<char[]> data;
     std::atomic<bool> dirty;
     uint32_t texture = 0;
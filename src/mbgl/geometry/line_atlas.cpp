@@ -1,4 +1,5 @@
 #include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 #include <mbgl/geometry/line_atlas.hpp>
 #include <mbgl/platform/gl.hpp>
 #include <mbgl/platform/log.hpp>
@@ -172,7 +173,7 @@ void LineAtlas::bind() {
             );
         }
 
-
+        Environment::Get().getMetrics().uploaded(width * height);
         dirty = false;
     }
 };
@@ -0,0 +1,80 @@
+#include <mbgl/geometry/simplify.hpp>
+
+namespace mbgl {
+
+void LineSimplifier::operator()(const GeometryBuffer::Line& line, double tolerance,
+                                std::vector<Coordinate>& result) {
+    result.clear();
+
+    const uint32_t count = uint32_t(line.size());
+    if (count <= 2) {
+        result.assign(line.begin(), line.end());
+        return;
+    }
+
+    const double sqTolerance = tolerance * tolerance;
+
+    keep.assign(count, false);
+    keep.front() = true;
+    keep.back() = true;
+
+    // Subdivide iteratively: recursion could get deep on long lines that barely need
+    // simplification.
+    stack.clear();
+    stack.emplace_back(0, count - 1);
+
+    while (!stack.empty()) {
+        const uint32_t first = stack.back().first;
+        const uint32_t last = stack.back().second;
+        stack.pop_back();
+
+        double maxSqDistance = sqTolerance;
+        uint32_t index = 0;
+
+        for (uint32_t i = first + 1; i < last; i++) {
+            const double sqDistance = sqSegmentDistance(line[i], line[first], line[last]);
+            if (sqDistance > maxSqDistance) {
+                index = i;
+                maxSqDistance = sqDistance;
+            }
+        }
+
+        if (index) {
+            keep[index] = true;
+            if (index - first > 1) stack.emplace_back(first, index);
+            if (last - index > 1) stack.emplace_back(index, last);
+        }
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (keep[i]) {
+            result.push_back(line[i]);
+        }
+    }
+}
+
+// Squared distance from p to the segment between a and b.
+double LineSimplifier::sqSegmentDistance(const Coordinate& p, const Coordinate& a, const Coordinate& b) {
+    double x = a.x;
+    double y = a.y;
+    double dx = b.x - x;
+    double dy = b.y - y;
+
+    if (dx != 0 || dy != 0) {
+        const double t = ((p.x - x) * dx + (p.y - y) * dy) / (dx * dx + dy * dy);
+        if (t > 1) {
+            x = b.x;
+            y = b.y;
+        } else if (t > 0) {
+            x += dx * t;
+            y += dy * t;
+        }
+    }
+
+    dx = p.x - x;
+    dy = p.y - y;
+
+    return dx * dx + dy * dy;
+}
+
+}
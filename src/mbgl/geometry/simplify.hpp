@@ -0,0 +1,31 @@
+#ifndef MBGL_GEOMETRY_SIMPLIFY
+#define MBGL_GEOMETRY_SIMPLIFY
+
+#include <mbgl/map/geometry_tile.hpp>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace mbgl {
+
+// Simplifies lines with the Douglas-Peucker algorithm: a point is only kept if it is further
+// than the tolerance away from the simplified line around it. The first and the last point are
+// always kept, so that closed lines stay closed.
+class LineSimplifier {
+public:
+    // Replaces the contents of result with the simplified line. The tolerance is in the units
+    // of the coordinates.
+    void operator()(const GeometryBuffer::Line&, double tolerance, std::vector<Coordinate>& result);
+
+private:
+    static double sqSegmentDistance(const Coordinate& p, const Coordinate& a, const Coordinate& b);
+
+    // Scratch space kept across lines.
+    std::vector<bool> keep;
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+};
+
+}
+
+#endif
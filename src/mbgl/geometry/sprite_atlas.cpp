@@ -1,4 +1,5 @@
 #include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 #include <mbgl/geometry/sprite_atlas.hpp>
 #include <mbgl/platform/gl.hpp>
 #include <mbgl/platform/log.hpp>
@@ -284,6 +285,7 @@ void SpriteAtlas::bind(bool linear) {
             ));
         }
 
+        Environment::Get().getMetrics().uploaded(uint64_t(width * pixelRatio) * uint64_t(height * pixelRatio) * 4);
         dirty = false;
 
 #ifndef GL_ES_VERSION_2_0
@@ -294,7 +296,9 @@ void SpriteAtlas::bind(bool linear) {
 
 SpriteAtlas::~SpriteAtlas() {
     std::lock_guard<std::recursive_mutex> lock(mtx);
-    Environment::Get().abandonTexture(texture);
-    texture = 0;
+    if (texture) {
+        Environment::Get().abandonTexture(texture);
+        texture = 0;
+    }
     ::operator delete(data), data = nullptr;
 }
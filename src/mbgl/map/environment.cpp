@@ -1,6 +1,9 @@
 #include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 #include <mbgl/storage/file_source.hpp>
+#include <mbgl/storage/response.hpp>
 #include <mbgl/platform/gl.hpp>
+#include <mbgl/util/std.hpp>
 
 #include <uv.h>
 
@@ -88,7 +91,10 @@ EnvironmentScope::~EnvironmentScope() {
 }
 
 Environment::Environment(FileSource& fs)
-    : id(makeEnvironmentID()), fileSource(fs), loop(uv_loop_new()) {
+    : id(makeEnvironmentID()),
+      fileSource(fs),
+      metrics(util::make_unique<MetricsRecorder>()),
+      loop(uv_loop_new()) {
 }
 
 Environment::~Environment() {
@@ -120,15 +126,34 @@ unsigned Environment::getID() const {
     return id;
 }
 
+namespace {
+
+std::function<void(const Response&)> timed(MetricsRecorder& metrics,
+                                           std::function<void(const Response&)> callback) {
+    const TimePoint start = Clock::now();
+    bool answered = false;
+    return [&metrics, start, callback, answered](const Response& res) mutable {
+        // Requests that were answered with a stale response may be answered again once it was
+        // revalidated; only the first answer counts.
+        if (!answered) {
+            answered = true;
+            metrics.requestCompleted(Clock::now() - start, res.status != Response::Successful);
+        }
+        callback(res);
+    };
+}
+
+} // namespace
+
 void Environment::requestAsync(const Resource& resource,
                                std::function<void(const Response&)> callback) {
-    fileSource.request(resource, *this, std::move(callback));
+    fileSource.request(resource, *this, timed(*metrics, std::move(callback)));
 }
 
 Request* Environment::request(const Resource& resource,
                               std::function<void(const Response&)> callback) {
     assert(currentlyOn(ThreadType::Map));
-    return fileSource.request(resource, loop, *this, std::move(callback));
+    return fileSource.request(resource, loop, *this, timed(*metrics, std::move(callback)));
 }
 
 void Environment::cancelRequest(Request* req) {
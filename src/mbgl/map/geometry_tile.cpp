@@ -4,6 +4,14 @@
 
 namespace mbgl {
 
+void GeometryTileFeature::decodeGeometries(GeometryBuffer& buffer) const {
+    buffer.clear();
+    for (const auto& line : getGeometries()) {
+        buffer.points.insert(buffer.points.end(), line.begin(), line.end());
+        buffer.endLine();
+    }
+}
+
 mapbox::util::optional<Value> GeometryTileFeatureExtractor::getValue(const std::string& key) const {
     if (key == "$type") {
         return Value(uint64_t(feature.getType()));
@@ -23,17 +23,73 @@ enum class FeatureType : uint8_t {
 
 typedef std::vector<std::vector<Coordinate>> GeometryCollection;
 
-class GeometryTileFeature : private util::noncopyable {
+// A flat representation of a feature's geometry: the points of all its lines or rings in
+// one array, plus the end offset of every line. Decoding into a buffer that is reused
+// across features doesn't allocate once it has grown to the size of the largest feature.
+class GeometryBuffer {
+public:
+    class Line {
+    public:
+        Line(const Coordinate* begin_, const Coordinate* end_) : first(begin_), last(end_) {}
+
+        const Coordinate* begin() const { return first; }
+        const Coordinate* end() const { return last; }
+        std::size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+        const Coordinate& operator[](std::size_t i) const { return first[i]; }
+        const Coordinate& front() const { return *first; }
+        const Coordinate& back() const { return *(last - 1); }
+
+    private:
+        const Coordinate* first;
+        const Coordinate* last;
+    };
+
+    std::size_t lineCount() const { return ends.size(); }
+
+    Line line(std::size_t i) const {
+        return Line(points.data() + (i ? ends[i - 1] : 0), points.data() + ends[i]);
+    }
+
+    void clear() {
+        points.clear();
+        ends.clear();
+    }
+
+    // Terminates the line that consists of all points added since the previous line.
+    void endLine() { ends.push_back(points.size()); }
+
+    std::vector<Coordinate> points;
+    std::vector<uint32_t> ends;
+};
+
+// Features are lightweight views into their layer, so they may be copied; layers own
+// them and hand them out by reference.
+class GeometryTileFeature {
 public:
     virtual FeatureType getType() const = 0;
     virtual mapbox::util::optional<Value> getValue(const std::string& key) const = 0;
     virtual GeometryCollection getGeometries() const = 0;
+
+    // Replaces the contents of the buffer with this feature's geometry.
+    virtual void decodeGeometries(GeometryBuffer&) const;
+
+    // Returns the index into the layer's value table of this feature's value for the
+    // given key index, or -1 if the feature has no such key. Only meaningful for layers
+    // that expose a value table.
+    virtual int32_t getValueIndex(uint32_t) const { return -1; }
 };
 
 class GeometryTileLayer : private util::noncopyable {
 public:
     virtual std::size_t featureCount() const = 0;
-    virtual util::ptr<const GeometryTileFeature> getFeature(std::size_t) const = 0;
+    virtual const GeometryTileFeature& getFeature(std::size_t) const = 0;
+
+    // Layers that intern their property keys and values expose them so that filters can
+    // be resolved against the layer once rather than against every feature. Layers that
+    // don't return nullptr here, and their features are queried by key name instead.
+    virtual const std::vector<Value>* getValueTable() const { return nullptr; }
+    virtual int32_t getKeyIndex(const std::string&) const { return -1; }
 };
 
 class GeometryTile : private util::noncopyable {
@@ -1,10 +1,13 @@
 #include <mbgl/map/annotation.hpp>
 #include <mbgl/map/live_tile_data.hpp>
 #include <mbgl/map/live_tile.hpp>
+#include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 #include <mbgl/map/tile_parser.hpp>
 #include <mbgl/map/source.hpp>
 #include <mbgl/map/vector_tile.hpp>
 #include <mbgl/platform/log.hpp>
+#include <mbgl/util/std.hpp>
 
 using namespace mbgl;
 
@@ -27,39 +30,55 @@ LiveTileData::LiveTileData(const TileID& id_,
 LiveTileData::~LiveTileData() {}
 
 void LiveTileData::parse() {
-    if (state != State::loaded) {
+    if (state != State::loaded && state != State::partial) {
         return;
     }
 
-    const LiveTile* tile = annotationManager.getTile(id);
+    const TimePoint start = Clock::now();
+    std::size_t features = 0;
+
+    try {
+        if (state == State::loaded) {
+            const LiveTile* tile = annotationManager.getTile(id);
+
+            if (!tile) {
+                // Clear the style so that we don't have a cycle in the shared_ptr references.
+                style.reset();
+
+                state = State::obsolete;
+                return;
+            }
 
-    if (tile) {
-        try {
             if (!style) {
                 throw std::runtime_error("style isn't present in LiveTileData object anymore");
             }
 
             // Parsing creates state that is encapsulated in TileParser. While parsing,
             // the TileParser object writes results into this objects. All other state
-            // is going to be discarded afterwards.
-            TileParser parser(*tile, *this, style, glyphAtlas, glyphStore, spriteAtlas, sprite);
+            // is going to be discarded once the symbols have been placed.
+            parser = util::make_unique<TileParser>(*tile, *this, style, glyphAtlas, glyphStore,
+                                                   spriteAtlas, sprite);
 
             // Clear the style so that we don't have a cycle in the shared_ptr references.
             style.reset();
 
-            parser.parse();
-        } catch (const std::exception& ex) {
-            Log::Error(Event::ParseTile, "Live-parsing [%d/%d/%d] failed: %s", id.z, id.x, id.y, ex.what());
-            state = State::obsolete;
-            return;
+            parser->parse();
+            features = parser->featuresDecoded();
         }
-    } else {
-        // Clear the style so that we don't have a cycle in the shared_ptr references.
-        style.reset();
 
+        if (!placeSymbols()) {
+            env.getMetrics().tileParsed(Clock::now() - start, features, 0);
+            return;
+        }
+    } catch (const std::exception& ex) {
+        Log::Error(Event::ParseTile, "Live-parsing [%d/%d/%d] failed: %s", id.z, id.x, id.y, ex.what());
+        parser.reset();
         state = State::obsolete;
+        return;
     }
 
+    env.getMetrics().tileParsed(Clock::now() - start, features, verticesGenerated);
+
     if (state != State::obsolete) {
         state = State::parsed;
     }
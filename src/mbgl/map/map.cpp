@@ -1,10 +1,12 @@
 #include <mbgl/map/map.hpp>
 #include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 #include <mbgl/map/view.hpp>
 #include <mbgl/map/map_data.hpp>
 #include <mbgl/map/still_image.hpp>
 #include <mbgl/platform/platform.hpp>
 #include <mbgl/map/source.hpp>
+#include <mbgl/map/tile_cache.hpp>
 #include <mbgl/renderer/painter.hpp>
 #include <mbgl/map/annotation.hpp>
 #include <mbgl/map/sprite.hpp>
@@ -61,18 +63,20 @@ const static bool uvVersionCheck = []() {
 using namespace mbgl;
 
 Map::Map(View& view_, FileSource& fileSource_)
-    : env(util::make_unique<Environment>(fileSource_)),
+    : tileCacheBudget(TileCache::defaultBudget),
+      env(util::make_unique<Environment>(fileSource_)),
       scope(util::make_unique<EnvironmentScope>(*env, ThreadType::Main, "Main")),
       view(view_),
       transform(view_),
       fileSource(fileSource_),
       glyphAtlas(util::make_unique<GlyphAtlas>(1024, 1024)),
-      glyphStore(std::make_shared<GlyphStore>(*env)),
+      glyphStore(std::make_shared<GlyphStore>(*env, [this] { triggerUpdate(); })),
       spriteAtlas(util::make_unique<SpriteAtlas>(512, 512)),
       lineAtlas(util::make_unique<LineAtlas>(512, 512)),
       texturePool(std::make_shared<TexturePool>()),
       painter(util::make_unique<Painter>(*spriteAtlas, *glyphAtlas, *lineAtlas)),
       annotationManager(util::make_unique<AnnotationManager>()),
+      tileCache(util::make_unique<TileCache>()),
       data(util::make_unique<MapData>()),
       updated(static_cast<UpdateType>(Update::Nothing))
 {
@@ -92,8 +96,12 @@ Map::~Map() {
         "MapandMain");
 
     // Explicitly reset all pointers.
+    if (sprite) {
+        sprite->cancel();
+    }
     sprite.reset();
     glyphStore.reset();
+    tileCache.reset();
     style.reset();
     workers.reset();
     painter.reset();
@@ -128,7 +136,11 @@ void Map::start(bool startPaused, Mode renderMode) {
         assert(Environment::currentlyOn(ThreadType::Map));
 
         // Remove all of these to make sure they are destructed in the correct thread.
+        tileCache->clear();
         style.reset();
+        if (sprite) {
+            sprite->cancel();
+        }
 
         // It's now safe to destroy/join the workers since there won't be any more callbacks that
         // could dispatch to the worker pool.
@@ -276,7 +288,7 @@ void Map::run() {
     view.activate();
     view.discard();
 
-    workers = util::make_unique<Worker>(env->loop, 4);
+    workers = util::make_unique<Worker>(env->loop);
 
     setup();
     prepare();
@@ -453,7 +465,7 @@ util::ptr<Sprite> Map::getSprite() {
     const float pixelRatio = state.getPixelRatio();
     const std::string &sprite_url = style->getSpriteURL();
     if (!sprite || !sprite->hasPixelRatio(pixelRatio)) {
-        sprite = Sprite::Create(sprite_url, pixelRatio, *env);
+        sprite = Sprite::Create(sprite_url, pixelRatio, *env, getWorker(), [this] { triggerUpdate(); });
     }
 
     return sprite;
@@ -650,6 +662,7 @@ void Map::updateAnnotationTiles(const std::vector<TileID>& ids) {
     if (!style) return;
     for (const auto &source : style->sources) {
         if (source->info.type == SourceType::Annotations) {
+            tileCache->clear(*source);
             source->invalidateTiles(ids);
         }
     }
@@ -716,9 +729,21 @@ Duration Map::getDefaultTransitionDuration() {
 void Map::updateTiles() {
     assert(Environment::currentlyOn(ThreadType::Map));
     if (!style) return;
+
+    // Tiles are prefetched for where the map will be once the animation or the gesture that's
+    // moving it ends, or in half a second if it keeps flinging.
+    TransformState predicted;
+    const bool moving = prefetchEnabled &&
+                        transform.predictState(predicted, std::chrono::milliseconds(500));
+
     for (const auto& source : style->sources) {
         source->update(*this, getWorker(), style, *glyphAtlas, *glyphStore,
-                               *spriteAtlas, getSprite(), *texturePool, [this]() {
+                               *spriteAtlas, getSprite(), *texturePool, *tileCache, [this]() {
+            assert(Environment::currentlyOn(ThreadType::Map));
+            triggerUpdate();
+        });
+        source->prefetch(*this, getWorker(), style, *glyphAtlas, *glyphStore, *spriteAtlas,
+                         getSprite(), *tileCache, moving ? &predicted : nullptr, [this]() {
             assert(Environment::currentlyOn(ThreadType::Map));
             triggerUpdate();
         });
@@ -736,6 +761,8 @@ void Map::update() {
 void Map::reloadStyle() {
     assert(Environment::currentlyOn(ThreadType::Map));
 
+    // Cached tiles refer to the sources of the previous style.
+    tileCache->clear();
     style = std::make_shared<Style>();
 
     const auto styleInfo = data->getStyleInfo();
@@ -745,7 +772,7 @@ void Map::reloadStyle() {
         // We have a style URL
         env->request({ Resource::Kind::JSON, styleInfo.url }, [this, base](const Response &res) {
             if (res.status == Response::Successful) {
-                loadStyleJSON(res.data, base);
+                loadStyleJSON(*res.data, base);
             } else {
                 Log::Error(Event::Setup, "loading style failed: %s", res.message.c_str());
             }
@@ -760,6 +787,7 @@ void Map::loadStyleJSON(const std::string& json, const std::string& base) {
     assert(Environment::currentlyOn(ThreadType::Map));
 
     sprite.reset();
+    tileCache->clear();
     style = std::make_shared<Style>();
     style->base = base;
     style->loadJSON((const uint8_t *)json.c_str());
@@ -854,7 +882,10 @@ void Map::render() {
     assert(style);
     assert(painter);
 
+    const TimePoint start = Clock::now();
+    const uint64_t calls = painter->glCalls;
     painter->render(*style, state, data->getAnimationTime());
+    env->getMetrics().frameRendered(Clock::now() - start, painter->glCalls - calls);
 
     // Schedule another rerender when we definitely need a next frame.
     if (transform.needsTransition() || style->hasTransitions()) {
@@ -862,24 +893,31 @@ void Map::render() {
     }
 }
 
-void Map::setSourceTileCacheSize(size_t size) {
-    if (size != getSourceTileCacheSize()) {
+void Map::setTileCacheBudget(size_t budget) {
+    if (budget != getTileCacheBudget()) {
+        tileCacheBudget = budget;
         invokeTask([=] {
-            sourceCacheSize = size;
-            if (!style) return;
-            for (const auto &source : style->sources) {
-                source->setCacheSize(sourceCacheSize);
-            }
+            tileCache->setBudget(budget);
             env->performCleanup();
         });
     }
 }
 
-void Map::onLowMemory() {
+void Map::setPrefetchEnabled(bool enabled) {
+    prefetchEnabled = enabled;
+}
+
+MapMetrics Map::getMetrics() const {
+    return env->getMetrics().snapshot();
+}
+
+void Map::onLowMemory(MemoryPressure pressure) {
     invokeTask([=] {
-        if (!style) return;
-        for (const auto &source : style->sources) {
-            source->onLowMemory();
+        tileCache->onLowMemory(pressure);
+        if (style) {
+            for (const auto &source : style->sources) {
+                source->onLowMemory();
+            }
         }
         env->performCleanup();
     });
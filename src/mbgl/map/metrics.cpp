@@ -0,0 +1,158 @@
+#include <mbgl/map/metrics.hpp>
+
+#include <rapidjson/prettywriter.h>
+#include <rapidjson/stringbuffer.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace mbgl {
+
+const std::size_t Histogram::bucketsPerPowerOfTwo;
+const std::size_t Histogram::bucketCount;
+
+Duration Histogram::bucketLimit(std::size_t index) {
+    const double us = std::pow(2.0, double(index + 1) / bucketsPerPowerOfTwo);
+    return std::chrono::duration_cast<Duration>(std::chrono::duration<double, std::micro>(us));
+}
+
+void Histogram::record(Duration duration) {
+    if (duration < Duration::zero()) {
+        duration = Duration::zero();
+    }
+
+    const double us = std::chrono::duration<double, std::micro>(duration).count();
+    const double estimate = us > 1 ? std::ceil(std::log2(us) * bucketsPerPowerOfTwo) - 1 : 0;
+    std::size_t index = std::min<std::size_t>(std::max(estimate, 0.0), bucketCount - 1);
+
+    // The logarithm is subject to rounding errors close to the bucket limits.
+    while (index > 0 && duration <= bucketLimit(index - 1)) {
+        index--;
+    }
+    while (index < bucketCount - 1 && duration > bucketLimit(index)) {
+        index++;
+    }
+
+    buckets[index]++;
+    samples++;
+    total += duration;
+    minimum = std::min(minimum, duration);
+    maximum = std::max(maximum, duration);
+}
+
+Duration Histogram::mean() const {
+    return samples ? total / Duration::rep(samples) : Duration::zero();
+}
+
+Duration Histogram::quantile(double q) const {
+    if (!samples) {
+        return Duration::zero();
+    }
+
+    const uint64_t rank = std::max<uint64_t>(1, std::ceil(std::min(std::max(q, 0.0), 1.0) * samples));
+    uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucketCount; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(bucketLimit(i), maximum);
+        }
+    }
+
+    return maximum;
+}
+
+namespace {
+
+using Writer = rapidjson::PrettyWriter<rapidjson::StringBuffer>;
+
+double milliseconds(Duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+void writeHistogram(Writer& writer, const Histogram& histogram) {
+    writer.StartObject();
+    writer.String("count");
+    writer.Uint64(histogram.count());
+    writer.String("mean");
+    writer.Double(milliseconds(histogram.mean()));
+    writer.String("min");
+    writer.Double(milliseconds(histogram.min()));
+    writer.String("max");
+    writer.Double(milliseconds(histogram.max()));
+    writer.String("p50");
+    writer.Double(milliseconds(histogram.quantile(0.5)));
+    writer.String("p90");
+    writer.Double(milliseconds(histogram.quantile(0.9)));
+    writer.String("p99");
+    writer.Double(milliseconds(histogram.quantile(0.99)));
+    writer.EndObject();
+}
+
+}
+
+// Durations are written in milliseconds.
+std::string MapMetrics::toJSON() const {
+    rapidjson::StringBuffer buffer;
+    Writer writer(buffer);
+
+    writer.StartObject();
+
+    writer.String("requests");
+    writer.StartObject();
+    writer.String("count");
+    writer.Uint64(requests);
+    writer.String("errors");
+    writer.Uint64(requestErrors);
+    writer.String("time");
+    writeHistogram(writer, requestTime);
+    writer.EndObject();
+
+    writer.String("tileCache");
+    writer.StartObject();
+    writer.String("hits");
+    writer.Uint64(tileCacheHits);
+    writer.String("misses");
+    writer.Uint64(tileCacheMisses);
+    writer.EndObject();
+
+    writer.String("parse");
+    writer.StartObject();
+    writer.String("features");
+    writer.Uint64(featuresParsed);
+    writer.String("vertices");
+    writer.Uint64(verticesGenerated);
+    writer.String("time");
+    writeHistogram(writer, tileParseTime);
+    writer.String("buckets");
+    writer.StartObject();
+    for (const auto& bucket : bucketParseTime) {
+        writer.String(bucket.first.c_str());
+        writeHistogram(writer, bucket.second);
+    }
+    writer.EndObject();
+    writer.EndObject();
+
+    writer.String("tileFirstRenderTime");
+    writeHistogram(writer, tileFirstRenderTime);
+
+    writer.String("uploadBytes");
+    writer.Uint64(uploadBytes);
+
+    writer.String("frames");
+    writer.StartObject();
+    writer.String("count");
+    writer.Uint64(frames);
+    writer.String("time");
+    writeHistogram(writer, frameTime);
+    writer.String("glCalls");
+    writer.Uint64(glCalls);
+    writer.String("lastFrameGLCalls");
+    writer.Uint64(lastFrameGLCalls);
+    writer.EndObject();
+
+    writer.EndObject();
+
+    return buffer.GetString();
+}
+
+}
@@ -0,0 +1,58 @@
+#include <mbgl/map/metrics_recorder.hpp>
+
+namespace mbgl {
+
+void MetricsRecorder::requestCompleted(Duration duration, bool failed) {
+    std::lock_guard<std::mutex> lock(mtx);
+    metrics.requests++;
+    if (failed) {
+        metrics.requestErrors++;
+    }
+    metrics.requestTime.record(duration);
+}
+
+void MetricsRecorder::tileCacheLookup(bool hit) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (hit) {
+        metrics.tileCacheHits++;
+    } else {
+        metrics.tileCacheMisses++;
+    }
+}
+
+void MetricsRecorder::tileParsed(Duration duration, uint64_t features, uint64_t vertices) {
+    std::lock_guard<std::mutex> lock(mtx);
+    metrics.tileParseTime.record(duration);
+    metrics.featuresParsed += features;
+    metrics.verticesGenerated += vertices;
+}
+
+void MetricsRecorder::bucketParsed(const std::string& type, Duration duration) {
+    std::lock_guard<std::mutex> lock(mtx);
+    metrics.bucketParseTime[type].record(duration);
+}
+
+void MetricsRecorder::tileRendered(Duration sinceRequest) {
+    std::lock_guard<std::mutex> lock(mtx);
+    metrics.tileFirstRenderTime.record(sinceRequest);
+}
+
+void MetricsRecorder::uploaded(uint64_t bytes) {
+    std::lock_guard<std::mutex> lock(mtx);
+    metrics.uploadBytes += bytes;
+}
+
+void MetricsRecorder::frameRendered(Duration duration, uint64_t glCalls) {
+    std::lock_guard<std::mutex> lock(mtx);
+    metrics.frames++;
+    metrics.frameTime.record(duration);
+    metrics.glCalls += glCalls;
+    metrics.lastFrameGLCalls = glCalls;
+}
+
+MapMetrics MetricsRecorder::snapshot() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return metrics;
+}
+
+}
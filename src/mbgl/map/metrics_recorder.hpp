@@ -0,0 +1,32 @@
+#ifndef MBGL_MAP_METRICS_RECORDER
+#define MBGL_MAP_METRICS_RECORDER
+
+#include <mbgl/map/metrics.hpp>
+#include <mbgl/util/noncopyable.hpp>
+
+#include <mutex>
+
+namespace mbgl {
+
+// Collects the metrics of a single environment. Events are recorded from the map thread, the
+// tile workers and the file source callbacks, so all methods may be called from any thread.
+class MetricsRecorder : private util::noncopyable {
+public:
+    void requestCompleted(Duration, bool failed);
+    void tileCacheLookup(bool hit);
+    void tileParsed(Duration, uint64_t features, uint64_t vertices);
+    void bucketParsed(const std::string& type, Duration);
+    void tileRendered(Duration sinceRequest);
+    void uploaded(uint64_t bytes);
+    void frameRendered(Duration, uint64_t glCalls);
+
+    MapMetrics snapshot() const;
+
+private:
+    mutable std::mutex mtx;
+    MapMetrics metrics;
+};
+
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include <mbgl/map/map.hpp>
 #include <mbgl/map/raster_tile_data.hpp>
+#include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 #include <mbgl/style/style.hpp>
 
 using namespace mbgl;
@@ -17,7 +19,15 @@ void RasterTileData::parse() {
         return;
     }
 
-    if (bucket.setImage(data)) {
+    const TimePoint start = Clock::now();
+    const bool decoded = bucket.setImage(*data);
+    const Duration duration = Clock::now() - start;
+
+    MetricsRecorder& metrics = env.getMetrics();
+    metrics.tileParsed(duration, 0, 0);
+    metrics.bucketParsed("raster", duration);
+
+    if (decoded) {
         state = State::parsed;
     } else {
         state = State::invalid;
@@ -1,8 +1,10 @@
 #include <mbgl/map/source.hpp>
 #include <mbgl/map/map.hpp>
 #include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 #include <mbgl/map/transform.hpp>
 #include <mbgl/map/tile.hpp>
+#include <mbgl/map/tile_cache.hpp>
 #include <mbgl/renderer/painter.hpp>
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/raster.hpp>
@@ -144,7 +146,7 @@ void Source::load(const std::string& accessToken,
         }
 
         rapidjson::Document d;
-        d.Parse<0>(res.data.c_str());
+        d.Parse<0>(res.data->c_str());
 
         if (d.HasParseError()) {
             Log::Warning(Event::General, "Invalid source TileJSON; Parse Error at %d: %s", d.GetErrorOffset(), d.GetParseError());
@@ -188,6 +190,9 @@ void Source::finishRender(Painter &painter) {
     for (const auto& pair : tiles) {
         Tile &tile = *pair.second;
         painter.renderTileDebug(tile);
+        if (tile.data && tile.data->ready()) {
+            tile.data->rendered();
+        }
     }
 }
 
@@ -219,10 +224,14 @@ TileData::State Source::addTile(Map &map, Worker &worker,
                                 util::ptr<Style> style, GlyphAtlas &glyphAtlas,
                                 GlyphStore &glyphStore, SpriteAtlas &spriteAtlas,
                                 util::ptr<Sprite> sprite, TexturePool &texturePool,
-                                const TileID &id, std::function<void()> callback) {
+                                TileCache &cache, const TileID &id, double priority,
+                                std::function<void()> callback) {
     const TileData::State state = hasTile(id);
 
     if (state != TileData::State::invalid) {
+        // The viewport moved; make sure tiles that are still queued for parsing are picked up
+        // in order of their distance to the new center.
+        tiles.find(id)->second->data->setPriority(priority);
         return state;
     }
 
@@ -244,25 +253,50 @@ TileData::State Source::addTile(Map &map, Worker &worker,
         new_tile.data.reset();
     }
 
-    if (!new_tile.data) {
-        new_tile.data = cache.get(id.to_uint64());
+    // A tile that was prefetched for this viewport is taken over once its data has arrived.
+    // While it's still loading, the request for the visible tile is coalesced with the prefetch
+    // request, which is canceled afterwards.
+    util::ptr<TileData> prefetch_data;
+    auto prefetch_it = prefetching.find(id);
+    if (prefetch_it != prefetching.end()) {
+        prefetch_data = std::move(prefetch_it->second);
+        prefetching.erase(prefetch_it);
+
+        if (!new_tile.data && prefetch_data->state != TileData::State::loading &&
+            !prefetch_data->isModified()) {
+            new_tile.data = std::move(prefetch_data);
+            tile_data.emplace(new_tile.data->id, new_tile.data);
+        }
     }
 
     if (!new_tile.data) {
+        new_tile.data = cache.get(*this, id.to_uint64());
+        Environment::Get().getMetrics().tileCacheLookup(bool(new_tile.data));
+        if (new_tile.data && new_tile.data->isModified()) {
+            new_tile.data.reset();
+        }
+    }
+
+    if (new_tile.data) {
+        new_tile.data->setPriority(priority);
+    } else {
         // If we don't find working tile data, we're just going to load it.
         if (info.type == SourceType::Vector) {
             new_tile.data =
                 std::make_shared<VectorTileData>(normalized_id, map.getMaxZoom(), style, glyphAtlas,
                                                  glyphStore, spriteAtlas, sprite, info);
+            new_tile.data->setPriority(priority);
             new_tile.data->request(worker, map.getState().getPixelRatio(), callback);
         } else if (info.type == SourceType::Raster) {
             new_tile.data = std::make_shared<RasterTileData>(normalized_id, texturePool, info);
+            new_tile.data->setPriority(priority);
             new_tile.data->request(worker, map.getState().getPixelRatio(), callback);
         } else if (info.type == SourceType::Annotations) {
             AnnotationManager& annotationManager = map.getAnnotationManager();
             new_tile.data = std::make_shared<LiveTileData>(normalized_id, annotationManager,
                                                            map.getMaxZoom(), style, glyphAtlas,
                                                            glyphStore, spriteAtlas, sprite, info);
+            new_tile.data->setPriority(priority);
             new_tile.data->reparse(worker, callback);
         } else {
             throw std::runtime_error("source type not implemented");
@@ -270,9 +304,32 @@ TileData::State Source::addTile(Map &map, Worker &worker,
         tile_data.emplace(new_tile.data->id, new_tile.data);
     }
 
+    if (prefetch_data) {
+        prefetch_data->cancel();
+    }
+
     return new_tile.data->state;
 }
 
+bool Source::prefetched(const TileID& id, TileCache& cache) {
+    auto it = prefetching.find(id);
+    if (it == prefetching.end()) {
+        return false;
+    }
+
+    // Tiles that wait for glyphs or sprite images stay here until they're resumed.
+    if (it->second->ready()) {
+        cache.add(*this, id.to_uint64(), it->second);
+        prefetching.erase(it);
+    }
+
+    return true;
+}
+
+double Source::tileDistance(const TileID& id, const vec2<double>& center) {
+    return std::fabs(id.x - center.x) + std::fabs(id.y - center.y);
+}
+
 double Source::getZoom(const TransformState& state) const {
     double offset = std::log(util::tileSize / info.tile_size) / std::log(2);
     return state.getZoom() + offset;
@@ -296,8 +353,7 @@ std::forward_list<TileID> Source::coveringTiles(const TransformState& state) con
 
     covering_tiles.sort([&center](const TileID& a, const TileID& b) {
         // Sorts by distance from the box center
-        return std::fabs(a.x - center.x) + std::fabs(a.y - center.y) <
-               std::fabs(b.x - center.x) + std::fabs(b.y - center.y);
+        return tileDistance(a, center) < tileDistance(b, center);
     });
 
     return covering_tiles;
@@ -360,14 +416,29 @@ void Source::update(Map &map,
                     SpriteAtlas &spriteAtlas,
                     util::ptr<Sprite> sprite,
                     TexturePool &texturePool,
+                    TileCache &cache,
                     std::function<void()> callback) {
     if (!loaded || map.getTime() <= updated) {
         return;
     }
 
+    // Tiles that were loaded from an expired response and changed on the server are replaced.
+    util::erase_if(tiles, [this](std::pair<const TileID, std::unique_ptr<Tile>> &pair) {
+        const util::ptr<TileData>& data = pair.second->data;
+        if (data && data->isModified()) {
+            tile_data.erase(data->id);
+            return true;
+        }
+        return false;
+    });
+
     int32_t zoom = std::floor(getZoom(map.getState()));
     std::forward_list<TileID> required = coveringTiles(map.getState());
 
+    // All covering tiles share one zoom level; their distance to the viewport center is used as
+    // the parsing priority.
+    const vec2<double> center = map.getState().cornersToBox(required.empty() ? zoom : required.front().z).center;
+
     // Determine the overzooming/underzooming amounts.
     int32_t minCoveringZoom = util::clamp<int32_t>(zoom - 10, info.min_zoom, info.max_zoom);
     int32_t maxCoveringZoom = util::clamp<int32_t>(zoom + 1,  info.min_zoom, info.max_zoom);
@@ -380,7 +451,8 @@ void Source::update(Map &map,
     // Add existing child/parent tiles if the actual tile is not yet loaded
     for (const auto& id : required) {
         const TileData::State state = addTile(map, worker, style, glyphAtlas, glyphStore,
-                                              spriteAtlas, sprite, texturePool, id, callback);
+                                              spriteAtlas, sprite, texturePool, cache, id,
+                                              tileDistance(id, center), callback);
 
         if (state != TileData::State::parsed) {
             // The tile we require is not yet loaded. Try to find a parent or
@@ -398,33 +470,24 @@ void Source::update(Map &map,
         }
     }
 
-    if (info.type != SourceType::Raster && cache.getSize() == 0) {
-        size_t conservativeCacheSize = ((float)map.getState().getWidth()  / util::tileSize) *
-                                       ((float)map.getState().getHeight() / util::tileSize) *
-                                       (map.getMaxZoom() - map.getMinZoom() + 1) *
-                                       0.5;
-        cache.setSize(conservativeCacheSize);
-    }
-
-    auto& tileCache = cache;
     auto& type = info.type;
 
     // Remove tiles that we definitely don't need, i.e. tiles that are not on
     // the required list.
     std::set<TileID> retain_data;
-    util::erase_if(tiles, [&retain, &retain_data, &tileCache, &type](std::pair<const TileID, std::unique_ptr<Tile>> &pair) {
+    util::erase_if(tiles, [this, &retain, &retain_data, &cache, &type](std::pair<const TileID, std::unique_ptr<Tile>> &pair) {
         Tile &tile = *pair.second;
         bool obsolete = std::find(retain.begin(), retain.end(), tile.id) == retain.end();
         if (!obsolete) {
             retain_data.insert(tile.data->id);
         } else if (type != SourceType::Raster && tile.data->ready()) {
-            tileCache.add(tile.id.to_uint64(), tile.data);
+            cache.add(*this, tile.id.to_uint64(), tile.data);
         }
         return obsolete;
     });
 
     // Remove all the expired pointers from the set.
-    util::erase_if(tile_data, [&retain_data, &tileCache](std::pair<const TileID, std::weak_ptr<TileData>> &pair) {
+    util::erase_if(tile_data, [this, &retain_data, &cache](std::pair<const TileID, std::weak_ptr<TileData>> &pair) {
         const util::ptr<TileData> tile = pair.second.lock();
         if (!tile) {
             return true;
@@ -432,7 +495,7 @@ void Source::update(Map &map,
 
         bool obsolete = retain_data.find(tile->id) == retain_data.end();
         if (obsolete) {
-            if (!tileCache.has(tile->id.to_uint64())) {
+            if (!cache.has(*this, tile->id.to_uint64())) {
                 tile->cancel();
             }
             return true;
@@ -441,23 +504,130 @@ void Source::update(Map &map,
         }
     });
 
+    // Tiles that had to wait for glyphs or sprite images continue parsing once these are loaded.
+    for (auto& pair : tiles) {
+        if (pair.second->data) {
+            pair.second->data->resume(worker, callback);
+        }
+    }
+
     updated = map.getTime();
 }
 
+void Source::prefetch(Map &map,
+                      Worker &worker,
+                      util::ptr<Style> style,
+                      GlyphAtlas &glyphAtlas,
+                      GlyphStore &glyphStore,
+                      SpriteAtlas &spriteAtlas,
+                      util::ptr<Sprite> sprite,
+                      TileCache &cache,
+                      const TransformState *predicted,
+                      std::function<void()> callback) {
+    // Raster tiles aren't kept in the tile cache, and annotation tiles don't need loading.
+    if (!loaded || info.type != SourceType::Vector) {
+        return;
+    }
+
+    // Pairs of tiles and their parsing priority. The parents are fewer, and can stand in for
+    // the tiles while these are still loading, so they are requested first.
+    std::vector<std::pair<TileID, double>> predictedTiles;
+
+    std::forward_list<TileID> covering;
+    if (predicted && coveringZoomLevel(*predicted) >= info.min_zoom) {
+        covering = coveringTiles(*predicted);
+    }
+
+    if (!covering.empty()) {
+        const int32_t zoom = covering.front().z;
+
+        if (zoom > info.min_zoom) {
+            const vec2<double> center = predicted->cornersToBox(zoom - 1).center;
+            std::set<TileID> parents;
+            for (const auto& id : covering) {
+                const TileID parent = id.parent(zoom - 1);
+                if (parents.insert(parent).second) {
+                    predictedTiles.emplace_back(parent, tileDistance(parent, center));
+                }
+            }
+        }
+
+        const vec2<double> center = predicted->cornersToBox(zoom).center;
+        for (const auto& id : covering) {
+            predictedTiles.emplace_back(id, tileDistance(id, center));
+        }
+    }
+
+    // Prefetched tiles are parsed after all visible ones.
+    const double prefetchPriority = 1000;
+
+    std::weak_ptr<Source> weak = shared_from_this();
+    const auto parsed = [weak, &cache, callback](const TileID& id) -> std::function<void()> {
+        return [weak, id, &cache, callback] {
+            // Prefetched tiles that became visible in the meantime need to be drawn.
+            auto source = weak.lock();
+            if (source && !source->prefetched(id, cache)) {
+                callback();
+            }
+        };
+    };
+
+    std::set<TileID> retain;
+    for (const auto& pair : predictedTiles) {
+        const TileID& id = pair.first;
+        retain.insert(id);
+
+        if (prefetching.find(id) != prefetching.end() ||
+            hasTile(id) != TileData::State::invalid ||
+            cache.has(*this, id.to_uint64())) {
+            continue;
+        }
+
+        const TileID normalized_id = id.normalized();
+        auto it = tile_data.find(normalized_id);
+        if (it != tile_data.end() && !it->second.expired()) {
+            continue;
+        }
+
+        auto data = std::make_shared<VectorTileData>(normalized_id, map.getMaxZoom(), style,
+                                                     glyphAtlas, glyphStore, spriteAtlas, sprite,
+                                                     info);
+        data->setPriority(prefetchPriority + pair.second);
+        data->request(worker, map.getState().getPixelRatio(), parsed(id), Resource::Prefetch);
+        prefetching.emplace(id, std::move(data));
+    }
+
+    // The map is headed somewhere else; stop downloading the tiles of the previous prediction.
+    // Tiles that have arrived already are parsed into the cache anyway.
+    util::erase_if(prefetching, [&retain](std::pair<const TileID, util::ptr<TileData>> &pair) {
+        const TileData::State state = pair.second->state;
+        if (retain.find(pair.first) == retain.end() &&
+            (state == TileData::State::initial || state == TileData::State::loading)) {
+            pair.second->cancel();
+            return true;
+        }
+        return false;
+    });
+
+    for (auto& pair : prefetching) {
+        pair.second->resume(worker, parsed(pair.first));
+    }
+}
+
 void Source::invalidateTiles(const std::vector<TileID>& ids) {
-    cache.clear();
     for (auto& id : ids) {
         tiles.erase(id);
         tile_data.erase(id);
+        prefetching.erase(id);
     }
 }
 
-void Source::setCacheSize(size_t size) {
-    cache.setSize(size);
-}
-
 void Source::onLowMemory() {
-    cache.clear();
+    for (const auto& pair : tiles) {
+        if (pair.second->data) {
+            pair.second->data->releaseData();
+        }
+    }
 }
 
 }
@@ -3,11 +3,11 @@
 
 #include <mbgl/map/tile_id.hpp>
 #include <mbgl/map/tile_data.hpp>
-#include <mbgl/map/tile_cache.hpp>
 #include <mbgl/style/types.hpp>
 
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/mat4.hpp>
+#include <mbgl/util/vec.hpp>
 #include <mbgl/util/ptr.hpp>
 #include <mbgl/util/chrono.hpp>
 
@@ -28,6 +28,7 @@ class GlyphStore;
 class SpriteAtlas;
 class Sprite;
 class TexturePool;
+class TileCache;
 class Style;
 class Painter;
 class StyleLayer;
@@ -62,7 +63,15 @@ public:
               std::function<void()> callback);
 
     void update(Map &, Worker &, util::ptr<Style>, GlyphAtlas &, GlyphStore &,
-                SpriteAtlas &, util::ptr<Sprite>, TexturePool &, std::function<void()> callback);
+                SpriteAtlas &, util::ptr<Sprite>, TexturePool &, TileCache &,
+                std::function<void()> callback);
+
+    // Loads the tiles of a viewport the map is about to show, and their parents, into the tile
+    // cache. Requests are sent at a low priority, and the ones that are still loading are
+    // canceled once they're no longer predicted. A null state cancels all of them.
+    void prefetch(Map &, Worker &, util::ptr<Style>, GlyphAtlas &, GlyphStore &,
+                  SpriteAtlas &, util::ptr<Sprite>, TileCache &,
+                  const TransformState *predicted, std::function<void()> callback);
 
     void invalidateTiles(const std::vector<TileID>&);
 
@@ -73,7 +82,7 @@ public:
 
     std::forward_list<Tile *> getLoadedTiles() const;
 
-    void setCacheSize(size_t);
+    // Releases the raw data of the tiles in use. Cached tiles are handled by the TileCache.
     void onLowMemory();
 
     SourceInfo info;
@@ -84,13 +93,19 @@ private:
     bool findLoadedParent(const TileID& id, int32_t minCoveringZoom, std::forward_list<TileID>& retain);
     int32_t coveringZoomLevel(const TransformState&) const;
     std::forward_list<TileID> coveringTiles(const TransformState&) const;
+    static double tileDistance(const TileID&, const vec2<double>& center);
 
     TileData::State addTile(Map &, Worker &, util::ptr<Style>, GlyphAtlas &,
                             GlyphStore &, SpriteAtlas &, util::ptr<Sprite>, TexturePool &,
-                            const TileID &, std::function<void()> callback);
+                            TileCache &, const TileID &, double priority,
+                            std::function<void()> callback);
 
     TileData::State hasTile(const TileID& id);
 
+    // Moves a prefetched tile into the tile cache once it's parsed. Returns false if the tile
+    // isn't being prefetched anymore.
+    bool prefetched(const TileID& id, TileCache &);
+
     double getZoom(const TransformState &state) const;
 
     bool loaded = false;
@@ -100,7 +115,10 @@ private:
 
     std::map<TileID, std::unique_ptr<Tile>> tiles;
     std::map<TileID, std::weak_ptr<TileData>> tile_data;
-    TileCache cache;
+
+    // Tiles that are loading for a predicted viewport. They are moved into the tile cache once
+    // parsed, or taken over by addTile() when they become visible before that.
+    std::map<TileID, util::ptr<TileData>> prefetching;
 };
 
 }
@@ -9,6 +9,7 @@
 #include <mbgl/storage/resource.hpp>
 #include <mbgl/storage/response.hpp>
 #include <mbgl/util/uv_detail.hpp>
+#include <mbgl/util/worker.hpp>
 #include <mbgl/util/std.hpp>
 
 #include <rapidjson/document.h>
@@ -24,9 +25,10 @@ SpritePosition::SpritePosition(uint16_t x_, uint16_t y_, uint16_t width_, uint16
       sdf(sdf_) {
 }
 
-util::ptr<Sprite> Sprite::Create(const std::string &base_url, float pixelRatio, Environment &env) {
+util::ptr<Sprite> Sprite::Create(const std::string &base_url, float pixelRatio, Environment &env,
+                                 Worker &worker, std::function<void()> callback) {
     util::ptr<Sprite> sprite(std::make_shared<Sprite>(Key(), base_url, pixelRatio));
-    sprite->load(env);
+    sprite->load(env, worker, callback);
     return sprite;
 }
 
@@ -37,19 +39,13 @@ Sprite::Sprite(const Key &, const std::string& base_url, float pixelRatio_)
       jsonURL(base_url + (pixelRatio_ > 1 ? "@2x" : "") + ".json"),
       raster(),
       loadedImage(false),
-      loadedJSON(false),
-      future(promise.get_future()) {
+      loadedJSON(false) {
 }
 
 bool Sprite::hasPixelRatio(float ratio) const {
     return pixelRatio == (ratio > 1 ? 2 : 1);
 }
 
-
-void Sprite::waitUntilLoaded() const {
-    future.wait();
-}
-
 Sprite::operator bool() const {
     return valid && isLoaded() && !pos.empty();
 }
@@ -58,18 +54,17 @@ Sprite::operator bool() const {
 // Note: This is a separate function that must be called exactly once after creation
 // The reason this isn't part of the constructor is that calling shared_from_this() in
 // the constructor fails.
-void Sprite::load(Environment &env) {
+void Sprite::load(Environment &env_, Worker &worker, std::function<void()> callback) {
     if (!valid) {
         // Treat a non-existent sprite as a successfully loaded empty sprite.
         loadedImage = true;
         loadedJSON = true;
-        promise.set_value();
         return;
     }
 
     util::ptr<Sprite> sprite = shared_from_this();
 
-    env.request({ Resource::Kind::JSON, jsonURL }, [sprite](const Response &res) {
+    env_.request({ Resource::Kind::JSON, jsonURL }, [sprite, callback](const Response &res) {
         if (res.status == Response::Successful) {
             sprite->body = res.data;
             sprite->parseJSON();
@@ -77,24 +72,40 @@ void Sprite::load(Environment &env) {
             Log::Warning(Event::Sprite, "Failed to load sprite info: %s", res.message.c_str());
         }
         sprite->loadedJSON = true;
-        sprite->complete();
+        sprite->complete(callback);
     });
 
-    env.request({ Resource::Kind::Image, spriteURL }, [sprite](const Response &res) {
+    env = &env_;
+    imageRequest = env_.request({ Resource::Kind::Image, spriteURL }, [sprite, callback, &worker](const Response &res) {
+        sprite->imageRequest = nullptr;
         if (res.status == Response::Successful) {
             sprite->image = res.data;
-            sprite->parseImage();
+            // Decoding a large sprite sheet would stall the map thread.
+            sprite->imageTask = worker.send([sprite] { sprite->parseImage(); }, [sprite, callback] {
+                sprite->loadedImage = true;
+                sprite->complete(callback);
+            });
         } else {
             Log::Warning(Event::Sprite, "Failed to load sprite image: %s", res.message.c_str());
+            sprite->loadedImage = true;
+            sprite->complete(callback);
         }
-        sprite->loadedImage = true;
-        sprite->complete();
     });
 }
 
-void Sprite::complete() {
-    if (loadedImage && loadedJSON) {
-        promise.set_value();
+void Sprite::cancel() {
+    if (imageRequest) {
+        env->cancelRequest(imageRequest);
+        imageRequest = nullptr;
+    }
+    if (auto task = imageTask.lock()) {
+        task->cancel();
+    }
+}
+
+void Sprite::complete(const std::function<void()>& callback) {
+    if (loadedImage && loadedJSON && callback) {
+        callback();
     }
 }
 
@@ -103,17 +114,17 @@ bool Sprite::isLoaded() const {
 }
 
 void Sprite::parseImage() {
-    raster = util::make_unique<util::Image>(image);
+    raster = util::make_unique<util::Image>(*image);
     if (!*raster) {
         raster.reset();
     }
-    image.clear();
+    image.reset();
 }
 
 void Sprite::parseJSON() {
     rapidjson::Document d;
-    d.Parse<0>(body.c_str());
-    body.clear();
+    d.Parse<0>(body->c_str());
+    body.reset();
 
     if (d.HasParseError()) {
         Log::Warning(Event::Sprite, "sprite JSON is invalid");
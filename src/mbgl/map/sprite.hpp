@@ -10,11 +10,15 @@
 #include <iosfwd>
 #include <string>
 #include <unordered_map>
-#include <future>
+#include <functional>
+#include <memory>
 
 namespace mbgl {
 
 class Environment;
+class Worker;
+class WorkTask;
+class Request;
 
 class SpritePosition {
 public:
@@ -34,20 +38,26 @@ public:
 class Sprite : public std::enable_shared_from_this<Sprite>, private util::noncopyable {
 private:
     struct Key {};
-    void load(Environment &env);
+    void load(Environment &env, Worker &worker, std::function<void()> callback);
 
 public:
     Sprite(const Key &, const std::string& base_url, float pixelRatio);
+
+    // The callback is invoked on the map thread once both the sprite image and JSON have loaded.
+    // The image is decoded on the worker.
     static util::ptr<Sprite>
-    Create(const std::string &base_url, float pixelRatio, Environment &env);
+    Create(const std::string &base_url, float pixelRatio, Environment &env, Worker &worker,
+           std::function<void()> callback = nullptr);
 
     const SpritePosition &getSpritePosition(const std::string& name) const;
 
     bool hasPixelRatio(float ratio) const;
 
-    void waitUntilLoaded() const;
     bool isLoaded() const;
 
+    // Stops loading the sprite. Must be called before the worker is destroyed.
+    void cancel();
+
     operator bool() const;
 
 private:
@@ -62,19 +72,18 @@ public:
 private:
     void parseJSON();
     void parseImage();
-    void complete();
+    void complete(const std::function<void()>& callback);
 
 private:
-    std::string body;
-    std::string image;
+    std::shared_ptr<const std::string> body;
+    std::shared_ptr<const std::string> image;
+    Environment* env = nullptr;
+    Request* imageRequest = nullptr;
+    std::weak_ptr<WorkTask> imageTask;
     std::atomic<bool> loadedImage;
     std::atomic<bool> loadedJSON;
     std::unordered_map<std::string, SpritePosition> pos;
     const SpritePosition empty;
-
-    std::promise<void> promise;
-    std::future<void> future;
-
 };
 
 }
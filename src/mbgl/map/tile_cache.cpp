@@ -1,59 +1,98 @@
 #include <mbgl/map/tile_cache.hpp>
 
 #include <cassert>
+#include <iterator>
 
 namespace mbgl {
 
-void TileCache::setSize(size_t size_) {
-    size = size_;
+const std::size_t TileCache::defaultBudget;
 
-    while (orderedKeys.size() > size) {
-        auto key = orderedKeys.front();
-        orderedKeys.pop_front();
-        tiles.erase(key);
-    }
-
-    assert(orderedKeys.size() <= size);
+TileCache::TileCache(std::size_t budget_) : budget(budget_) {}
 
-    tiles.reserve(size);
+void TileCache::setBudget(std::size_t budget_) {
+    budget = budget_;
+    evict();
 }
 
-void TileCache::add(uint64_t key, std::shared_ptr<TileData> data) {
-
-    assert(tiles.find(key) == tiles.end());
+void TileCache::add(const Source& source, uint64_t key, std::shared_ptr<TileData> data) {
+    assert(index.find({ &source, key }) == index.end());
+    assert(data->ready());
 
-    tiles.emplace(key, data);
-    orderedKeys.push_back(key);
-
-    if (orderedKeys.size() > size) {
-        get(orderedKeys.front());
-    }
+    const std::size_t cost = data->getBytes();
+    entries.push_back({ &source, key, std::move(data), cost });
+    index.emplace(Key { &source, key }, std::prev(entries.end()));
+    bytes += cost;
 
-    assert(orderedKeys.size() <= size);
+    evict();
 };
 
-std::shared_ptr<TileData> TileCache::get(uint64_t key) {
-
+std::shared_ptr<TileData> TileCache::get(const Source& source, uint64_t key) {
     std::shared_ptr<TileData> data;
 
-    auto it = tiles.find(key);
-    if (it != tiles.end()) {
-        data = it->second;
-        tiles.erase(it);
-        orderedKeys.remove(key);
+    auto it = index.find({ &source, key });
+    if (it != index.end()) {
+        data = std::move(it->second->data);
+        erase(it->second);
         assert(data->ready());
     }
 
     return data;
 };
 
-bool TileCache::has(uint64_t key) {
-    return tiles.find(key) != tiles.end();
+bool TileCache::has(const Source& source, uint64_t key) const {
+    return index.find({ &source, key }) != index.end();
+}
+
+void TileCache::clear(const Source& source) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->source == &source) {
+            erase(it++);
+        } else {
+            ++it;
+        }
+    }
 }
 
 void TileCache::clear() {
-    orderedKeys.clear();
-    tiles.clear();
+    index.clear();
+    entries.clear();
+    bytes = 0;
+}
+
+void TileCache::onLowMemory(MemoryPressure pressure) {
+    if (pressure == MemoryPressure::Critical) {
+        clear();
+        return;
+    }
+
+    for (auto it = entries.begin(); it != entries.end();) {
+        // Tiles that haven't been drawn yet still have all of their geometry in client memory.
+        // They are more expensive to keep than the ones that only hold GPU buffers.
+        if (pressure == MemoryPressure::High && it->data->clientBytes() > 0) {
+            erase(it++);
+            continue;
+        }
+
+        it->data->releaseData();
+        bytes -= it->bytes;
+        it->bytes = it->data->getBytes();
+        bytes += it->bytes;
+        ++it;
+    }
+}
+
+void TileCache::erase(Entries::iterator it) {
+    bytes -= it->bytes;
+    index.erase({ it->source, it->key });
+    entries.erase(it);
+}
+
+void TileCache::evict() {
+    while (!entries.empty() && (budget == 0 || bytes > budget)) {
+        erase(entries.begin());
+    }
+
+    assert(!entries.empty() || bytes == 0);
 }
 
 };
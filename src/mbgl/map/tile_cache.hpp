@@ -2,27 +2,68 @@
 #define MBGL_MAP_TILE_CACHE
 
 #include <mbgl/map/tile_data.hpp>
+#include <mbgl/map/memory_pressure.hpp>
+#include <mbgl/util/noncopyable.hpp>
 
+#include <functional>
 #include <list>
 #include <unordered_map>
 
 namespace mbgl {
 
-class TileCache {
+class Source;
+
+// Keeps tiles that left the viewport around for reuse. The cache is shared by all sources of a
+// map, and evicts the least recently cached tiles once the tiles together exceed the budget.
+class TileCache : private util::noncopyable {
 public:
-    TileCache(size_t size_ = 0) : size(size_) {}
+    static const std::size_t defaultBudget = 64 * 1024 * 1024;
+
+    explicit TileCache(std::size_t budget = defaultBudget);
+
+    // Both in bytes. A budget of 0 disables the cache.
+    void setBudget(std::size_t);
+    std::size_t getBudget() const { return budget; }
+    std::size_t getBytes() const { return bytes; }
 
-    void setSize(size_t);
-    size_t getSize() const { return size; };
-    void add(uint64_t key, std::shared_ptr<TileData> data);
-    std::shared_ptr<TileData> get(uint64_t key);
-    bool has(uint64_t key);
+    std::size_t size() const { return entries.size(); }
+
+    void add(const Source&, uint64_t key, std::shared_ptr<TileData> data);
+    std::shared_ptr<TileData> get(const Source&, uint64_t key);
+    bool has(const Source&, uint64_t key) const;
+
+    void clear(const Source&);
     void clear();
+
+    void onLowMemory(MemoryPressure);
+
 private:
-    std::unordered_map<uint64_t, std::shared_ptr<TileData>> tiles;
-    std::list<uint64_t> orderedKeys;
+    struct Entry {
+        const Source* source;
+        uint64_t key;
+        std::shared_ptr<TileData> data;
+        std::size_t bytes;
+    };
+
+    using Key = std::pair<const Source*, uint64_t>;
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            return std::hash<const Source*>()(key.first) ^ std::hash<uint64_t>()(key.second);
+        }
+    };
+
+    // Entries are ordered from the least to the most recently cached one.
+    using Entries = std::list<Entry>;
+
+    void erase(Entries::iterator);
+    void evict();
+
+    Entries entries;
+    std::unordered_map<Key, Entries::iterator, KeyHash> index;
 
-    size_t size;
+    std::size_t budget;
+    std::size_t bytes = 0;
 };
 
 };
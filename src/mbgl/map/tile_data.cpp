@@ -1,5 +1,6 @@
 #include <mbgl/map/tile_data.hpp>
 #include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 #include <mbgl/map/source.hpp>
 
 #include <mbgl/storage/file_source.hpp>
@@ -27,18 +28,31 @@ const std::string TileData::toString() const {
     return std::string { "[tile " } + name + "]";
 }
 
-void TileData::request(Worker& worker, float pixelRatio, std::function<void()> callback) {
+void TileData::request(Worker& worker, float pixelRatio, std::function<void()> callback,
+                       Resource::Priority requestPriority) {
     std::string url = source.tileURL(id, pixelRatio);
     state = State::loading;
 
-    req = env.request({ Resource::Kind::Tile, url }, [url, callback, &worker, this](const Response &res) {
-        req = nullptr;
+    const Resource resource { Resource::Kind::Tile, url, requestPriority,
+                              Resource::StaleWhileRevalidate };
+    req = env.request(resource, [url, callback, &worker, this](const Response &res) {
+        // The request stays alive after a stale response, until it's revalidated.
+        if (!res.stale) {
+            req = nullptr;
+        }
 
         if (res.status != Response::Successful) {
             Log::Error(Event::HttpRequest, "[%s] tile loading failed: %s", url.c_str(), res.message.c_str());
             return;
         }
 
+        if (state != State::loading) {
+            // This tile was loaded from a stale response, and the tile changed in the meantime.
+            modified = true;
+            callback();
+            return;
+        }
+
         state = State::loaded;
         data = res.data;
 
@@ -55,11 +69,50 @@ void TileData::cancel() {
         env.cancelRequest(req);
         req = nullptr;
     }
+    if (auto task = workTask.lock()) {
+        task->cancel();
+    }
+}
+
+std::size_t TileData::getBytes() const {
+    return (data ? data->size() : 0) + clientBytes() + serverBytes();
+}
+
+void TileData::releaseData() {
+    if (state == State::parsed) {
+        data.reset();
+    }
+}
+
+void TileData::rendered() {
+    if (!drawn) {
+        drawn = true;
+        env.getMetrics().tileRendered(Clock::now() - created);
+    }
+}
+
+void TileData::setPriority(double priority_) {
+    priority = priority_;
+    if (auto task = workTask.lock()) {
+        task->setPriority(priority);
+    }
+}
+
+void TileData::resume(Worker& worker, std::function<void()> callback) {
+    // A tile that's still queued or being parsed has its parse task pending.
+    if (state != State::partial || !workTask.expired()) {
+        return;
+    }
+
+    requestDependencies();
+    if (dependenciesLoaded()) {
+        reparse(worker, callback);
+    }
 }
 
 void TileData::reparse(Worker& worker, std::function<void()> callback) {
     util::ptr<TileData> tile = shared_from_this();
-    worker.send(
+    workTask = worker.send(
         [tile]() {
             EnvironmentScope scope(tile->env, ThreadType::TileWorker, "TileWorker_" + tile->name);
             tile->parse();
@@ -68,5 +121,6 @@ void TileData::reparse(Worker& worker, std::function<void()> callback) {
              // `tile` is bound in this lambda to ensure that if it's the last owning pointer,
              // destruction happens on the map thread, not the worker thread.
             callback();
-        });
+        },
+        priority);
 }
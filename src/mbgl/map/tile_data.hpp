@@ -4,11 +4,14 @@
 #include <mbgl/map/tile_id.hpp>
 #include <mbgl/renderer/debug_bucket.hpp>
 #include <mbgl/geometry/debug_font_buffer.hpp>
+#include <mbgl/storage/resource.hpp>
 
+#include <mbgl/util/chrono.hpp>
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/ptr.hpp>
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <functional>
 
@@ -20,6 +23,7 @@ class SourceInfo;
 class StyleLayer;
 class Request;
 class Worker;
+class WorkTask;
 
 class TileData : public std::enable_shared_from_this<TileData>,
              private util::noncopyable {
@@ -29,6 +33,7 @@ public:
         initial,
         loading,
         loaded,
+        partial,
         parsed,
         obsolete
     };
@@ -36,17 +41,50 @@ public:
     TileData(const TileID&, const SourceInfo&);
     ~TileData();
 
-    void request(Worker&, float pixelRatio, std::function<void ()> callback);
+    void request(Worker&, float pixelRatio, std::function<void ()> callback,
+                 Resource::Priority = Resource::Visible);
     void reparse(Worker&, std::function<void ()> callback);
     void cancel();
     const std::string toString() const;
 
+    // Lower values are parsed first. Applies to parsing work that is already queued, too.
+    void setPriority(double);
+
+    // Continues parsing a partially parsed tile once the resources it's waiting for have loaded.
+    void resume(Worker&, std::function<void ()> callback);
+
     inline bool ready() const {
         return state == State::parsed;
     }
 
+    // Tiles are loaded from expired responses while these are revalidated. When the tile changed
+    // on the server, the tile has to be loaded again; the source replaces it on its next update.
+    inline bool isModified() const {
+        return modified;
+    }
+
+    // Estimated memory held by the tile. Geometry buffers are held in client memory until the
+    // tile is drawn for the first time, and on the GPU afterwards. These must be called on the
+    // map thread, and never while the tile is being parsed.
+    std::size_t getBytes() const;
+    virtual std::size_t clientBytes() const { return 0; }
+    virtual std::size_t serverBytes() const { return 0; }
+
+    // Drops the raw tile data of a parsed tile. Parsed tiles are never parsed again.
+    void releaseData();
+
+    // Called on the map thread after a parsed tile was drawn. Records the time from the
+    // creation of the tile until it was drawn for the first time.
+    void rendered();
+
     // Override this in the child class.
     virtual void parse() = 0;
+
+    // Tiles that may end up in the partial state override these. They are called on the map
+    // thread, and never while the tile is being parsed.
+    virtual void requestDependencies() {}
+    virtual bool dependenciesLoaded() const { return true; }
+
     virtual void render(Painter &painter, const StyleLayer &layer_desc, const mat4 &matrix) = 0;
     virtual bool hasData(StyleLayer const &layer_desc) const = 0;
 
@@ -59,7 +97,14 @@ protected:
     Environment& env;
 
     Request *req = nullptr;
-    std::string data;
+    std::shared_ptr<const std::string> data;
+    bool modified = false;
+
+    double priority = 0;
+    std::weak_ptr<WorkTask> workTask;
+
+    const TimePoint created = Clock::now();
+    bool drawn = false;
 
     // Contains the tile ID string for painting debug information.
     DebugFontBuffer debugFontBuffer;
@@ -8,6 +8,9 @@
 #include <mbgl/renderer/line_bucket.hpp>
 #include <mbgl/renderer/symbol_bucket.hpp>
 #include <mbgl/renderer/raster_bucket.hpp>
+#include <mbgl/geometry/fill_buffer.hpp>
+#include <mbgl/geometry/line_buffer.hpp>
+#include <mbgl/geometry/elements_buffer.hpp>
 #include <mbgl/util/raster.hpp>
 #include <mbgl/util/constants.hpp>
 #include <mbgl/util/token.hpp>
@@ -20,9 +23,23 @@
 #include <mbgl/util/utf.hpp>
 
 #include <locale>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace mbgl {
 
+struct TileParser::StagingBuffers {
+    FillVertexBuffer fillVertexBuffer;
+    LineVertexBuffer lineVertexBuffer;
+    TriangleElementsBuffer triangleElementsBuffer;
+    LineElementsBuffer lineElementsBuffer;
+    PointElementsBuffer pointElementsBuffer;
+};
+
+TileParser::LayerBucket::LayerBucket(const StyleBucket& desc_, std::unique_ptr<Bucket> bucket_,
+                                     std::unique_ptr<StagingBuffers> staging_, const GeometryTileLayer& layer)
+    : desc(desc_), bucket(std::move(bucket_)), staging(std::move(staging_)), filter(desc.filter, layer) {}
+
 // Note: This destructor is seemingly empty, but we need to declare it anyway
 // because this object has a std::unique_ptr<> of a forward-declare type in
 // its header file.
@@ -51,36 +68,173 @@ TileParser::TileParser(const GeometryTile& geometryTile_,
 bool TileParser::obsolete() const { return tile.state == TileData::State::obsolete; }
 
 void TileParser::parse() {
+    // Buckets are grouped by source layer, so that each source layer's features are
+    // iterated, and their geometries decoded, only once no matter how many style layers
+    // draw from it. Symbol buckets are placed in style order after all features have been
+    // added, since they share the collision index.
+    std::vector<std::string> sourceLayers;
+    std::unordered_map<std::string, std::vector<LayerBucket>> layerBuckets;
+    std::unordered_set<std::string> bucketNames;
+
     for (const auto& layer_desc : style->layers) {
+        if (layer_desc->isBackground()) {
+            // background is a special, fake bucket
+            continue;
+        }
+
+        if (!layer_desc->bucket) {
+            Log::Warning(Event::ParseTile, "layer '%s' does not have buckets", layer_desc->id.c_str());
+            continue;
+        }
+
+        // This is a singular layer. Check if this bucket already exists. If not,
+        // parse this bucket.
+        const StyleBucket& bucketDesc = *layer_desc->bucket;
+        if (tile.buckets.find(bucketDesc.name) != tile.buckets.end() ||
+            !bucketNames.insert(bucketDesc.name).second) {
+            continue;
+        }
+
+        // Bucket creation might fail because the data tile may not contain any data that
+        // falls into this bucket.
+        auto staging = util::make_unique<StagingBuffers>();
+        std::unique_ptr<Bucket> bucket = createBucket(bucketDesc, *staging);
+        if (!bucket) {
+            continue;
+        }
+
+        if (bucketDesc.type == StyleLayerType::Symbol) {
+            symbolBuckets.push_back(static_cast<SymbolBucket*>(bucket.get()));
+        }
+
+        auto layer = geometryTile.getLayer(bucketDesc.source_layer);
+        auto& buckets = layerBuckets[bucketDesc.source_layer];
+        if (buckets.empty()) {
+            sourceLayers.push_back(bucketDesc.source_layer);
+        }
+        buckets.emplace_back(bucketDesc, std::move(bucket), std::move(staging), *layer);
+    }
+
+    for (const auto& sourceLayer : sourceLayers) {
         // Cancel early when parsing.
         if (obsolete()) {
+            symbolBuckets.clear();
             return;
         }
 
-        if (layer_desc->isBackground()) {
-            // background is a special, fake bucket
-            continue;
+        addFeatures(*geometryTile.getLayer(sourceLayer), layerBuckets[sourceLayer]);
+    }
+
+    for (const auto& sourceLayer : sourceLayers) {
+        for (auto& layerBucket : layerBuckets[sourceLayer]) {
+            moveToTile(layerBucket);
+            parsedBuckets[layerBucket.desc.name] = std::move(layerBucket.bucket);
+        }
+    }
+}
+
+bool TileParser::dependenciesLoaded() const {
+    for (auto symbolBucket : symbolBuckets) {
+        if (!symbolBucket->dependenciesLoaded(glyphStore, *sprite)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TileParser::requestDependencies() {
+    for (auto symbolBucket : symbolBuckets) {
+        symbolBucket->requestDependencies(glyphStore);
+    }
+}
+
+bool TileParser::placeSymbols() {
+    if (obsolete()) {
+        return true;
+    }
+
+    if (!dependenciesLoaded()) {
+        return false;
+    }
+
+    const TimePoint start = Clock::now();
+    for (auto symbolBucket : symbolBuckets) {
+        if (obsolete()) {
+            return true;
         }
 
-        if (layer_desc->bucket) {
-            // This is a singular layer. Check if this bucket already exists. If not,
-            // parse this bucket.
-            auto bucket_it = tile.buckets.find(layer_desc->bucket->name);
-            if (bucket_it == tile.buckets.end()) {
-                // We need to create this bucket since it doesn't exist yet.
-                std::unique_ptr<Bucket> bucket = createBucket(*layer_desc->bucket);
-                if (bucket) {
-                    // Bucket creation might fail because the data tile may not
-                    // contain any data that falls into this bucket.
-                    tile.buckets[layer_desc->bucket->name] = std::move(bucket);
-                }
+        symbolBucket->placeFeatures(
+            reinterpret_cast<uintptr_t>(&tile), spriteAtlas, *sprite, glyphAtlas, glyphStore);
+        vertices += symbolBucket->vertexCount();
+    }
+    symbolTime += Clock::now() - start;
+    vertices += tile.fillVertexBuffer.index() + tile.lineVertexBuffer.index();
+
+    for (auto& bucket : parsedBuckets) {
+        tile.buckets[bucket.first] = std::move(bucket.second);
+    }
+    parsedBuckets.clear();
+
+    return true;
+}
+
+void TileParser::addFeatures(const GeometryTileLayer& layer, std::vector<LayerBucket>& buckets) {
+
+    for (std::size_t i = 0; i < layer.featureCount(); i++) {
+        if (obsolete())
+            return;
+
+        const auto& feature = layer.getFeature(i);
+        bool decodedFeature = false;
+
+        for (auto& layerBucket : buckets) {
+            if (!layerBucket.filter.evaluate(feature))
+                continue;
+
+            Bucket& bucket = *layerBucket.bucket;
+            const StyleLayerType type = layerBucket.desc.type;
+
+            // Symbol features without text or icon don't need their geometry.
+            if (type == StyleLayerType::Symbol && !static_cast<SymbolBucket&>(bucket).addFeature(feature))
+                continue;
+
+            if (!decodedFeature) {
+                feature.decodeGeometries(geometry);
+                decodedFeature = true;
+                decoded++;
+            }
+            consumed++;
+
+            const TimePoint start = Clock::now();
+            if (type == StyleLayerType::Fill) {
+                static_cast<FillBucket&>(bucket).addGeometry(geometry);
+                fillTime += Clock::now() - start;
+            } else if (type == StyleLayerType::Line) {
+                static_cast<LineBucket&>(bucket).addGeometry(geometry);
+                lineTime += Clock::now() - start;
+            } else if (type == StyleLayerType::Symbol) {
+                static_cast<SymbolBucket&>(bucket).addGeometry(geometry);
+                symbolTime += Clock::now() - start;
             }
-        } else {
-            Log::Warning(Event::ParseTile, "layer '%s' does not have buckets", layer_desc->id.c_str());
         }
     }
 }
 
+void TileParser::moveToTile(LayerBucket& layerBucket) {
+    if (layerBucket.desc.type == StyleLayerType::Fill) {
+        static_cast<FillBucket&>(*layerBucket.bucket).moveTo(tile.fillVertexBuffer,
+                                                             tile.triangleElementsBuffer,
+                                                             tile.lineElementsBuffer);
+    } else if (layerBucket.desc.type == StyleLayerType::Line) {
+        static_cast<LineBucket&>(*layerBucket.bucket).moveTo(tile.lineVertexBuffer,
+                                                             tile.triangleElementsBuffer,
+                                                             tile.pointElementsBuffer);
+    }
+
+    // The bucket doesn't draw from the staging buffers anymore.
+    layerBucket.staging.reset();
+}
+
 template <typename T>
 struct PropertyEvaluator {
     typedef T result_type;
@@ -113,7 +267,7 @@ void applyLayoutProperty(PropertyKey key, const ClassProperties &classProperties
     }
 }
 
-std::unique_ptr<Bucket> TileParser::createBucket(const StyleBucket &bucketDesc) {
+std::unique_ptr<Bucket> TileParser::createBucket(const StyleBucket &bucketDesc, StagingBuffers& staging) {
     // Skip this bucket if we are to not render this
     if (tile.id.z < std::floor(bucketDesc.min_zoom) && std::floor(bucketDesc.min_zoom) < tile.source.max_zoom) return nullptr;
     if (tile.id.z >= std::ceil(bucketDesc.max_zoom)) return nullptr;
@@ -122,11 +276,11 @@ std::unique_ptr<Bucket> TileParser::createBucket(const StyleBucket &bucketDesc)
     auto layer = geometryTile.getLayer(bucketDesc.source_layer);
     if (layer) {
         if (bucketDesc.type == StyleLayerType::Fill) {
-            return createFillBucket(*layer, bucketDesc);
+            return createFillBucket(bucketDesc, staging);
         } else if (bucketDesc.type == StyleLayerType::Line) {
-            return createLineBucket(*layer, bucketDesc);
+            return createLineBucket(bucketDesc, staging);
         } else if (bucketDesc.type == StyleLayerType::Symbol) {
-            return createSymbolBucket(*layer, bucketDesc);
+            return createSymbolBucket(bucketDesc);
         } else if (bucketDesc.type == StyleLayerType::Raster) {
             return nullptr;
         } else {
@@ -144,36 +298,18 @@ std::unique_ptr<Bucket> TileParser::createBucket(const StyleBucket &bucketDesc)
     return nullptr;
 }
 
-template <class Bucket>
-void TileParser::addBucketGeometries(Bucket& bucket, const GeometryTileLayer& layer, const FilterExpression &filter) {
-    for (std::size_t i = 0; i < layer.featureCount(); i++) {
-        auto feature = layer.getFeature(i);
-
-        if (obsolete())
-            return;
-
-        GeometryTileFeatureExtractor extractor(*feature);
-        if (!evaluate(filter, extractor))
-            continue;
-
-        bucket->addGeometry(feature->getGeometries());
-    }
-}
-
-std::unique_ptr<Bucket> TileParser::createFillBucket(const GeometryTileLayer& layer,
-                                                     const StyleBucket& bucket_desc) {
-    auto bucket = util::make_unique<FillBucket>(tile.fillVertexBuffer,
-                                                tile.triangleElementsBuffer,
-                                                tile.lineElementsBuffer);
-    addBucketGeometries(bucket, layer, bucket_desc.filter);
-    return std::move(bucket);
+std::unique_ptr<Bucket> TileParser::createFillBucket(const StyleBucket&, StagingBuffers& staging) {
+    return util::make_unique<FillBucket>(staging.fillVertexBuffer,
+                                         staging.triangleElementsBuffer,
+                                         staging.lineElementsBuffer,
+                                         FillBucket::Triangulation::Earcut,
+                                         &arena);
 }
 
-std::unique_ptr<Bucket> TileParser::createLineBucket(const GeometryTileLayer& layer,
-                                                     const StyleBucket& bucket_desc) {
-    auto bucket = util::make_unique<LineBucket>(tile.lineVertexBuffer,
-                                                tile.triangleElementsBuffer,
-                                                tile.pointElementsBuffer);
+std::unique_ptr<Bucket> TileParser::createLineBucket(const StyleBucket& bucket_desc, StagingBuffers& staging) {
+    auto bucket = util::make_unique<LineBucket>(staging.lineVertexBuffer,
+                                                staging.triangleElementsBuffer,
+                                                staging.pointElementsBuffer);
 
     const float z = tile.id.z;
     auto& layout = bucket->layout;
@@ -182,13 +318,18 @@ std::unique_ptr<Bucket> TileParser::createLineBucket(const GeometryTileLayer& la
     applyLayoutProperty(PropertyKey::LineJoin, bucket_desc.layout, layout.join, z);
     applyLayoutProperty(PropertyKey::LineMiterLimit, bucket_desc.layout, layout.miter_limit, z);
     applyLayoutProperty(PropertyKey::LineRoundLimit, bucket_desc.layout, layout.round_limit, z);
+    applyLayoutProperty(PropertyKey::LineSimplify, bucket_desc.layout, layout.simplify, z);
+
+    if (layout.simplify) {
+        // The tile is drawn magnified up to 2^depth times before it gets replaced, so keep the
+        // error of the simplified lines below half a pixel at that scale.
+        bucket->tolerance = 0.5 * 4096 / tile.source.tile_size / std::pow(2.0, tile.depth);
+    }
 
-    addBucketGeometries(bucket, layer, bucket_desc.filter);
     return std::move(bucket);
 }
 
-std::unique_ptr<Bucket> TileParser::createSymbolBucket(const GeometryTileLayer& layer,
-                                                       const StyleBucket& bucket_desc) {
+std::unique_ptr<Bucket> TileParser::createSymbolBucket(const StyleBucket& bucket_desc) {
     auto bucket = util::make_unique<SymbolBucket>(*collision);
 
     const float z = tile.id.z;
@@ -232,8 +373,6 @@ std::unique_ptr<Bucket> TileParser::createSymbolBucket(const GeometryTileLayer&
     applyLayoutProperty(PropertyKey::TextOffset, bucket_desc.layout, layout.text.offset, z);
     applyLayoutProperty(PropertyKey::TextAllowOverlap, bucket_desc.layout, layout.text.allow_overlap, z);
 
-    bucket->addFeatures(
-        layer, bucket_desc.filter, reinterpret_cast<uintptr_t>(&tile), spriteAtlas, *sprite, glyphAtlas, glyphStore);
     return std::move(bucket);
 }
 }
@@ -4,15 +4,20 @@
 #include <mbgl/map/geometry_tile.hpp>
 #include <mbgl/map/vector_tile.hpp>
 #include <mbgl/style/filter_expression.hpp>
+#include <mbgl/style/filter_program.hpp>
 #include <mbgl/style/class_properties.hpp>
 #include <mbgl/style/style_bucket.hpp>
 #include <mbgl/text/glyph.hpp>
+#include <mbgl/util/arena.hpp>
+#include <mbgl/util/chrono.hpp>
 #include <mbgl/util/ptr.hpp>
 #include <mbgl/util/noncopyable.hpp>
 
 #include <cstdint>
 #include <iosfwd>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace mbgl {
 
@@ -30,6 +35,7 @@ class StyleLayoutLine;
 class StyleLayoutSymbol;
 class VectorTileData;
 class Collision;
+class SymbolBucket;
 
 class TileParser : private util::noncopyable {
 public:
@@ -43,18 +49,62 @@ public:
     ~TileParser();
 
 public:
+    // Adds all features of the tile to their buckets. Symbols are only placed by
+    // placeSymbols(), since they may have to wait for glyphs and sprite images.
     void parse();
 
+    // Places the symbols of all buckets and hands the buckets over to the tile. Returns false,
+    // without doing anything, while glyphs or sprite images that are needed are still loading.
+    bool placeSymbols();
+
+    // Requests the glyphs needed for placing the symbols. Must be called on the map thread.
+    void requestDependencies();
+    bool dependenciesLoaded() const;
+
+    // The number of features whose geometry was decoded, and the number of times a
+    // feature was added to a bucket. Features shared by several buckets are only decoded once.
+    std::size_t featuresDecoded() const { return decoded; }
+    std::size_t featuresConsumed() const { return consumed; }
+
+    // Time spent adding features to buckets of each type, including symbol placement. The
+    // number of vertices is known once the symbols have been placed.
+    Duration fillParseTime() const { return fillTime; }
+    Duration lineParseTime() const { return lineTime; }
+    Duration symbolParseTime() const { return symbolTime; }
+    std::size_t verticesGenerated() const { return vertices; }
+
+    // Scratch memory for the buckets while they are being filled. Fill buckets rewind it after
+    // each feature they tessellate, and the rest is freed in one go along with the parser.
+    const util::Arena& getArena() const { return arena; }
+
 private:
+    // Buffers that a fill or line bucket is filled into on its own, since the buckets of a
+    // source layer are filled at the same time. They're appended to the tile's buffers
+    // afterwards, so that each bucket's geometry is contiguous.
+    struct StagingBuffers;
+
+    // A bucket that is filled during the single pass over its source layer.
+    struct LayerBucket {
+        LayerBucket(const StyleBucket& desc_, std::unique_ptr<Bucket> bucket_,
+                    std::unique_ptr<StagingBuffers> staging, const GeometryTileLayer& layer);
+
+        const StyleBucket& desc;
+        std::unique_ptr<Bucket> bucket;
+        std::unique_ptr<StagingBuffers> staging;
+        FilterProgram filter;
+    };
+
     bool obsolete() const;
 
-    std::unique_ptr<Bucket> createBucket(const StyleBucket&);
-    std::unique_ptr<Bucket> createFillBucket(const GeometryTileLayer&, const StyleBucket&);
-    std::unique_ptr<Bucket> createLineBucket(const GeometryTileLayer&, const StyleBucket&);
-    std::unique_ptr<Bucket> createSymbolBucket(const GeometryTileLayer&, const StyleBucket&);
+    std::unique_ptr<Bucket> createBucket(const StyleBucket&, StagingBuffers&);
+    std::unique_ptr<Bucket> createFillBucket(const StyleBucket&, StagingBuffers&);
+    std::unique_ptr<Bucket> createLineBucket(const StyleBucket&, StagingBuffers&);
+    std::unique_ptr<Bucket> createSymbolBucket(const StyleBucket&);
+
+    void addFeatures(const GeometryTileLayer&, std::vector<LayerBucket>&);
+    void moveToTile(LayerBucket&);
 
-    template <class Bucket>
-    void addBucketGeometries(Bucket&, const GeometryTileLayer&, const FilterExpression&);
+    util::Arena arena;
 
     const GeometryTile& geometryTile;
     VectorTileData& tile;
@@ -67,6 +117,21 @@ private:
     util::ptr<Sprite> sprite;
 
     std::unique_ptr<Collision> collision;
+
+    // Buckets that have been filled by parse(), but aren't owned by the tile yet.
+    std::unordered_map<std::string, std::unique_ptr<Bucket>> parsedBuckets;
+    std::vector<SymbolBucket*> symbolBuckets;
+
+    // Reused for all features of the tile.
+    GeometryBuffer geometry;
+
+    std::size_t decoded = 0;
+    std::size_t consumed = 0;
+
+    Duration fillTime = Duration::zero();
+    Duration lineTime = Duration::zero();
+    Duration symbolTime = Duration::zero();
+    std::size_t vertices = 0;
 };
 
 }
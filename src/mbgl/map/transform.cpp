@@ -64,6 +64,7 @@ void Transform::_moveBy(const double dx, const double dy, const Duration duratio
     constrain(final.scale, final.y);
 
     if (duration == Duration::zero()) {
+        trackMotion(current.scale, final.x, final.y);
         current.x = final.x;
         current.y = final.y;
     } else {
@@ -220,6 +221,7 @@ void Transform::_setScaleXY(const double new_scale, const double xn, const doubl
     constrain(final.scale, final.y);
 
     if (duration == Duration::zero()) {
+        trackMotion(final.scale, final.x, final.y);
         current.scale = final.scale;
         current.x = final.x;
         current.y = final.y;
@@ -266,6 +268,28 @@ void Transform::constrain(double& scale, double& y) const {
     if (y < -max_y) y = -max_y;
 }
 
+void Transform::trackMotion(const double new_scale, const double xn, const double yn) {
+    // This is only called internally, so we don't need a lock here.
+
+    // Gestures move the map in small steps. Steps that are too far apart belong to different
+    // gestures, or the gesture paused in between.
+    const TimePoint now = Clock::now();
+    const double seconds = std::chrono::duration<double>(now - motionTime).count();
+
+    if (current.gestureInProgress && motionTime != TimePoint::min() &&
+        seconds > 0 && seconds < 0.1) {
+        // Positions are relative to the scale; compare them at the new one.
+        const double factor = new_scale / current.scale;
+        velocityX = (xn - current.x * factor) / seconds;
+        velocityY = (yn - current.y * factor) / seconds;
+        velocityZoom = std::log2(factor) / seconds;
+    } else {
+        velocityX = velocityY = velocityZoom = 0;
+    }
+
+    motionTime = now;
+}
+
 #pragma mark - Angle
 
 void Transform::rotateBy(const double start_x, const double start_y, const double end_x,
@@ -422,6 +446,41 @@ void Transform::setGestureInProgress(bool inProgress) {
     current.gestureInProgress = inProgress;
 }
 
+#pragma mark - Prediction
+
+bool Transform::predictState(TransformState& state, const Duration lookahead) const {
+    std::lock_guard<std::recursive_mutex> lock(mtx);
+
+    if (transitionFrameFn) {
+        state = final;
+    } else {
+        const bool moving = velocityX != 0 || velocityY != 0 || velocityZoom != 0;
+        if (!current.gestureInProgress || !moving ||
+            Clock::now() - motionTime > std::chrono::milliseconds(100)) {
+            return false;
+        }
+
+        const double seconds = std::chrono::duration<double>(lookahead).count();
+
+        state = current;
+        state.scale = util::clamp(current.scale * std::pow(2.0, velocityZoom * seconds),
+                                  min_scale, max_scale);
+
+        const double factor = state.scale / current.scale;
+        state.x = current.x * factor + velocityX * seconds;
+        state.y = current.y * factor + velocityY * seconds;
+
+        constrain(state.scale, state.y);
+    }
+
+    // Only the current state keeps these up to date.
+    const double s = state.scale * util::tileSize;
+    state.Bc = s / 360;
+    state.Cc = s / util::M2PI;
+
+    return true;
+}
+
 #pragma mark - Transform state
 
 const TransformState Transform::currentState() const {
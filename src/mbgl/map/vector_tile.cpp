@@ -31,11 +31,33 @@ Value parseValue(pbf data) {
 
 VectorTileFeature::VectorTileFeature(pbf feature_pbf, const VectorTileLayer& layer_)
     : layer(layer_) {
+    tagsBegin = tagsEnd = layer.tags.size();
+
     while (feature_pbf.next()) {
         if (feature_pbf.tag == 1) { // id
             id = feature_pbf.varint<uint64_t>();
         } else if (feature_pbf.tag == 2) { // tags
-            tags_pbf = feature_pbf.message();
+            pbf tags_pbf = feature_pbf.message();
+            while (tags_pbf) {
+                uint32_t tag_key = tags_pbf.varint();
+
+                if (layer.keys.size() <= tag_key) {
+                    throw std::runtime_error("feature referenced out of range key");
+                }
+
+                if (!tags_pbf) {
+                    throw std::runtime_error("uneven number of feature tag ids");
+                }
+
+                uint32_t tag_val = tags_pbf.varint();
+                if (layer.values.size() <= tag_val) {
+                    throw std::runtime_error("feature referenced out of range value");
+                }
+
+                layer.tags.push_back(tag_key);
+                layer.tags.push_back(tag_val);
+            }
+            tagsEnd = layer.tags.size();
         } else if (feature_pbf.tag == 3) { // type
             type = (FeatureType)feature_pbf.varint();
         } else if (feature_pbf.tag == 4) { // geometry
@@ -52,42 +74,54 @@ mapbox::util::optional<Value> VectorTileFeature::getValue(const std::string& key
         return mapbox::util::optional<Value>();
     }
 
-    pbf tags = tags_pbf;
-    while (tags) {
-        uint32_t tag_key = tags.varint();
-
-        if (layer.keys.size() <= tag_key) {
-            throw std::runtime_error("feature referenced out of range key");
-        }
+    return getValue(keyIter->second);
+}
 
-        if (!tags) {
-            throw std::runtime_error("uneven number of feature tag ids");
-        }
+mapbox::util::optional<Value> VectorTileFeature::getValue(uint32_t keyIndex) const {
+    const int32_t valueIndex = getValueIndex(keyIndex);
+    if (valueIndex < 0) {
+        return mapbox::util::optional<Value>();
+    }
 
-        uint32_t tag_val = tags.varint();
-        if (layer.values.size() <= tag_val) {
-            throw std::runtime_error("feature referenced out of range value");
-        }
+    return layer.values[valueIndex];
+}
 
-        if (tag_key == keyIter->second) {
-            return layer.values[tag_val];
+int32_t VectorTileFeature::getValueIndex(uint32_t keyIndex) const {
+    const uint32_t* tags = layer.tags.data();
+    for (uint32_t i = tagsBegin; i < tagsEnd; i += 2) {
+        if (tags[i] == keyIndex) {
+            return tags[i + 1];
         }
     }
 
-    return mapbox::util::optional<Value>();
+    return -1;
 }
 
 GeometryCollection VectorTileFeature::getGeometries() const {
+    GeometryBuffer buffer;
+    decodeGeometries(buffer);
+
+    GeometryCollection lines;
+    lines.reserve(buffer.lineCount());
+    for (std::size_t i = 0; i < buffer.lineCount(); i++) {
+        const auto line = buffer.line(i);
+        lines.emplace_back(line.begin(), line.end());
+    }
+
+    return lines;
+}
+
+void VectorTileFeature::decodeGeometries(GeometryBuffer& buffer) const {
+    buffer.clear();
+
     pbf data(geometry_pbf);
     uint8_t cmd = 1;
     uint32_t length = 0;
     int32_t x = 0;
     int32_t y = 0;
 
-    GeometryCollection lines;
-
-    lines.emplace_back();
-    std::vector<Coordinate>* line = &lines.back();
+    std::vector<Coordinate>& points = buffer.points;
+    std::size_t lineStart = 0;
 
     while (data.data < data.end) {
         if (length == 0) {
@@ -102,16 +136,17 @@ GeometryCollection VectorTileFeature::getGeometries() const {
             x += data.svarint();
             y += data.svarint();
 
-            if (cmd == 1 && !line->empty()) { // moveTo
-                lines.emplace_back();
-                line = &lines.back();
+            if (cmd == 1 && points.size() > lineStart) { // moveTo
+                buffer.endLine();
+                lineStart = points.size();
             }
 
-            line->emplace_back(x, y);
+            points.emplace_back(x, y);
 
         } else if (cmd == 7) { // closePolygon
-            if (!line->empty()) {
-                line->push_back((*line)[0]);
+            if (points.size() > lineStart) {
+                const Coordinate first = points[lineStart];
+                points.push_back(first);
             }
 
         } else {
@@ -119,7 +154,7 @@ GeometryCollection VectorTileFeature::getGeometries() const {
         }
     }
 
-    return lines;
+    buffer.endLine();
 }
 
 VectorTile::VectorTile(pbf tile_pbf) {
@@ -146,7 +181,7 @@ VectorTileLayer::VectorTileLayer(pbf layer_pbf) {
         if (layer_pbf.tag == 1) { // name
             name = layer_pbf.string();
         } else if (layer_pbf.tag == 2) { // feature
-            features.push_back(layer_pbf.message());
+            featurePBFs.push_back(layer_pbf.message());
         } else if (layer_pbf.tag == 3) { // keys
             keys.emplace(layer_pbf.string(), keys.size());
         } else if (layer_pbf.tag == 4) { // values
@@ -159,8 +194,31 @@ VectorTileLayer::VectorTileLayer(pbf layer_pbf) {
     }
 }
 
-util::ptr<const GeometryTileFeature> VectorTileLayer::getFeature(std::size_t i) const {
-    return std::make_shared<VectorTileFeature>(features.at(i), *this);
+void VectorTileLayer::index() const {
+    // Features are decoded in a second pass because the keys and values they refer to
+    // may appear after them in the layer message.
+    features.clear();
+    tags.clear();
+    features.reserve(featurePBFs.size());
+    for (const auto& feature_pbf : featurePBFs) {
+        features.emplace_back(feature_pbf, *this);
+    }
+    indexed = true;
+}
+
+const GeometryTileFeature& VectorTileLayer::getFeature(std::size_t i) const {
+    if (!indexed) {
+        index();
+    }
+    return features.at(i);
+}
+
+int32_t VectorTileLayer::getKeyIndex(const std::string& key) const {
+    auto keyIter = keys.find(key);
+    if (keyIter == keys.end()) {
+        return -1;
+    }
+    return keyIter->second;
 }
 
 }
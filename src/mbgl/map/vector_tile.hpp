@@ -5,6 +5,7 @@
 #include <mbgl/util/pbf.hpp>
 
 #include <map>
+#include <unordered_map>
 
 namespace mbgl {
 
@@ -17,12 +18,22 @@ public:
     FeatureType getType() const override { return type; }
     mapbox::util::optional<Value> getValue(const std::string&) const override;
     GeometryCollection getGeometries() const override;
+    void decodeGeometries(GeometryBuffer&) const override;
+
+    int32_t getValueIndex(uint32_t keyIndex) const override;
+
+    // Looks up a value by the layer-local key index, as returned by VectorTileLayer::getKeyIndex().
+    mapbox::util::optional<Value> getValue(uint32_t keyIndex) const;
 
 private:
     const VectorTileLayer& layer;
     uint64_t id = 0;
     FeatureType type = FeatureType::Unknown;
-    pbf tags_pbf;
+
+    // Range of this feature's (key, value) index pairs in the layer's flat tag array.
+    uint32_t tagsBegin = 0;
+    uint32_t tagsEnd = 0;
+
     pbf geometry_pbf;
 };
 
@@ -30,18 +41,31 @@ class VectorTileLayer : public GeometryTileLayer {
 public:
     VectorTileLayer(pbf);
 
-    std::size_t featureCount() const override { return features.size(); }
-    util::ptr<const GeometryTileFeature> getFeature(std::size_t) const override;
+    std::size_t featureCount() const override { return featurePBFs.size(); }
+    const GeometryTileFeature& getFeature(std::size_t) const override;
+
+    const std::vector<Value>* getValueTable() const override { return &values; }
+    int32_t getKeyIndex(const std::string&) const override;
 
 private:
     friend class VectorTile;
     friend class VectorTileFeature;
 
+    // Decodes all features and their tags into flat arrays. Features are indexed lazily
+    // the first time they are accessed, and only once, since most layers of a tile are
+    // read by several style buckets or not at all. A layer is only ever accessed from the
+    // thread that parses its tile.
+    void index() const;
+
     std::string name;
     uint32_t extent = 4096;
-    std::map<std::string, uint32_t> keys;
+    std::unordered_map<std::string, uint32_t> keys;
     std::vector<Value> values;
-    std::vector<pbf> features;
+    std::vector<pbf> featurePBFs;
+
+    mutable bool indexed = false;
+    mutable std::vector<VectorTileFeature> features;
+    mutable std::vector<uint32_t> tags;
 };
 
 class VectorTile : public GeometryTile {
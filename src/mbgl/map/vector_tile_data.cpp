@@ -1,12 +1,16 @@
 #include <mbgl/map/vector_tile_data.hpp>
 #include <mbgl/map/tile_parser.hpp>
+#include <mbgl/map/vector_tile.hpp>
 #include <mbgl/util/std.hpp>
 #include <mbgl/style/style_layer.hpp>
 #include <mbgl/style/style_bucket.hpp>
 #include <mbgl/map/source.hpp>
+#include <mbgl/map/environment.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
 #include <mbgl/geometry/glyph_atlas.hpp>
 #include <mbgl/platform/log.hpp>
 #include <mbgl/util/pbf.hpp>
+#include <mbgl/util/constants.hpp>
 
 using namespace mbgl;
 
@@ -32,37 +36,108 @@ VectorTileData::~VectorTileData() {
 }
 
 void VectorTileData::parse() {
-    if (state != State::loaded) {
+    if (state != State::loaded && state != State::partial) {
         return;
     }
 
+    const TimePoint start = Clock::now();
+    std::size_t features = 0;
+
     try {
-        if (!style) {
-            throw std::runtime_error("style isn't present in VectorTileData object anymore");
-        }
+        if (state == State::loaded) {
+            if (!style) {
+                throw std::runtime_error("style isn't present in VectorTileData object anymore");
+            }
 
-        // Parsing creates state that is encapsulated in TileParser. While parsing,
-        // the TileParser object writes results into this objects. All other state
-        // is going to be discarded afterwards.
-        VectorTile vectorTile(pbf((const uint8_t *)data.data(), data.size()));
-        const VectorTile* vt = &vectorTile;
-        TileParser parser(*vt, *this, style, glyphAtlas, glyphStore, spriteAtlas, sprite);
+            // Parsing creates state that is encapsulated in TileParser. While parsing,
+            // the TileParser object writes results into this objects. All other state
+            // is going to be discarded once the symbols have been placed.
+            geometryTile = util::make_unique<VectorTile>(pbf((const uint8_t *)data->data(), data->size()));
+            parser = util::make_unique<TileParser>(*geometryTile, *this, style, glyphAtlas,
+                                                   glyphStore, spriteAtlas, sprite);
 
-        // Clear the style so that we don't have a cycle in the shared_ptr references.
-        style.reset();
+            // Clear the style so that we don't have a cycle in the shared_ptr references.
+            style.reset();
 
-        parser.parse();
+            parser->parse();
+
+            featuresDecoded = parser->featuresDecoded();
+            featuresConsumed = parser->featuresConsumed();
+            features = featuresDecoded;
+            if (debug::tileParseWarnings) {
+                const util::Arena& arena = parser->getArena();
+                Log::Info(Event::ParseTile, "[%d/%d/%d] decoded %u features, consumed %u, "
+                          "%u allocations from %u arena chunks",
+                          id.z, id.x, id.y, unsigned(featuresDecoded), unsigned(featuresConsumed),
+                          unsigned(arena.allocations()), unsigned(arena.chunks()));
+                Log::Info(Event::ParseTile, "[%d/%d/%d] used/allocated buffer elements: "
+                          "%u/%u fill vertices, %u/%u line vertices, %u/%u triangles, "
+                          "%u/%u lines, %u/%u points",
+                          id.z, id.x, id.y,
+                          unsigned(fillVertexBuffer.index()), unsigned(fillVertexBuffer.capacity()),
+                          unsigned(lineVertexBuffer.index()), unsigned(lineVertexBuffer.capacity()),
+                          unsigned(triangleElementsBuffer.index()), unsigned(triangleElementsBuffer.capacity()),
+                          unsigned(lineElementsBuffer.index()), unsigned(lineElementsBuffer.capacity()),
+                          unsigned(pointElementsBuffer.index()), unsigned(pointElementsBuffer.capacity()));
+            }
+        }
+
+        if (!placeSymbols()) {
+            env.getMetrics().tileParsed(Clock::now() - start, features, 0);
+            return;
+        }
     } catch (const std::exception& ex) {
         Log::Error(Event::ParseTile, "Parsing [%d/%d/%d] failed: %s", id.z, id.x, id.y, ex.what());
+        parser.reset();
+        geometryTile.reset();
         state = State::obsolete;
         return;
     }
 
+    env.getMetrics().tileParsed(Clock::now() - start, features, verticesGenerated);
+
     if (state != State::obsolete) {
         state = State::parsed;
     }
 }
 
+bool VectorTileData::placeSymbols() {
+    if (!parser->placeSymbols()) {
+        if (state != State::obsolete) {
+            state = State::partial;
+        }
+        return false;
+    }
+
+    MetricsRecorder& metrics = env.getMetrics();
+    const std::pair<const char*, Duration> bucketTimes[] = {
+        { "fill", parser->fillParseTime() },
+        { "line", parser->lineParseTime() },
+        { "symbol", parser->symbolParseTime() },
+    };
+    for (const auto& bucketTime : bucketTimes) {
+        // Tiles without buckets of a type would skew the distribution towards zero.
+        if (bucketTime.second > Duration::zero()) {
+            metrics.bucketParsed(bucketTime.first, bucketTime.second);
+        }
+    }
+    verticesGenerated = parser->verticesGenerated();
+
+    parser.reset();
+    geometryTile.reset();
+    return true;
+}
+
+void VectorTileData::requestDependencies() {
+    if (parser) {
+        parser->requestDependencies();
+    }
+}
+
+bool VectorTileData::dependenciesLoaded() const {
+    return !parser || parser->dependenciesLoaded();
+}
+
 void VectorTileData::render(Painter &painter, const StyleLayer &layer_desc, const mat4 &matrix) {
     if (state == State::parsed && layer_desc.bucket) {
         auto databucket_it = buckets.find(layer_desc.bucket->name);
@@ -83,3 +158,23 @@ bool VectorTileData::hasData(const StyleLayer &layer_desc) const {
     }
     return false;
 }
+
+std::size_t VectorTileData::clientBytes() const {
+    std::size_t bytes = fillVertexBuffer.clientBytes() + lineVertexBuffer.clientBytes() +
+                        triangleElementsBuffer.clientBytes() + lineElementsBuffer.clientBytes() +
+                        pointElementsBuffer.clientBytes();
+    for (const auto& pair : buckets) {
+        bytes += pair.second->clientBytes();
+    }
+    return bytes;
+}
+
+std::size_t VectorTileData::serverBytes() const {
+    std::size_t bytes = fillVertexBuffer.serverBytes() + lineVertexBuffer.serverBytes() +
+                        triangleElementsBuffer.serverBytes() + lineElementsBuffer.serverBytes() +
+                        pointElementsBuffer.serverBytes();
+    for (const auto& pair : buckets) {
+        bytes += pair.second->serverBytes();
+    }
+    return bytes;
+}
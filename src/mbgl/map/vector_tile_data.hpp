@@ -15,6 +15,7 @@
 namespace mbgl {
 
 class Bucket;
+class VectorTile;
 class Painter;
 class SourceInfo;
 class StyleLayer;
@@ -42,8 +43,17 @@ public:
     void parse() override;
     void render(Painter &painter, const StyleLayer &layer_desc, const mat4 &matrix) override;
     bool hasData(StyleLayer const& layer_desc) const override;
+    std::size_t clientBytes() const override;
+    std::size_t serverBytes() const override;
+
+    void requestDependencies() override;
+    bool dependenciesLoaded() const override;
 
 protected:
+    // Places the symbols of the parsed tile. Returns false, and leaves the tile in the partial
+    // state, if the parser has to wait for glyphs or sprite images.
+    bool placeSymbols();
+
     // Holds the actual geometries in this tile.
     FillVertexBuffer fillVertexBuffer;
     LineVertexBuffer lineVertexBuffer;
@@ -62,8 +72,20 @@ protected:
     util::ptr<Sprite> sprite;
     util::ptr<Style> style;
 
+    // Kept while the tile is partially parsed.
+    std::unique_ptr<VectorTile> geometryTile;
+    std::unique_ptr<TileParser> parser;
+
 public:
     const float depth;
+
+    // Number of feature geometries decoded during the last parse, and the number of
+    // times a feature was added to a bucket.
+    std::atomic<std::size_t> featuresDecoded { 0 };
+    std::atomic<std::size_t> featuresConsumed { 0 };
+
+    // Number of vertices in the buffers of the tile and its symbol buckets.
+    std::atomic<std::size_t> verticesGenerated { 0 };
 };
 
 }
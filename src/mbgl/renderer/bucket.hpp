@@ -4,6 +4,8 @@
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/mat4.hpp>
 
+#include <cstddef>
+
 namespace mbgl {
 
 class Painter;
@@ -16,6 +18,11 @@ public:
     virtual bool hasData() const = 0;
     virtual ~Bucket() {}
 
+    // Buckets that own buffers, rather than writing to the buffers of their tile, report their
+    // size here.
+    virtual std::size_t clientBytes() const { return 0; }
+    virtual std::size_t serverBytes() const { return 0; }
+
 };
 
 }
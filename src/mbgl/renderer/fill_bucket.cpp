@@ -5,6 +5,7 @@
 #include <mbgl/style/style.hpp>
 #include <mbgl/style/style_layout.hpp>
 #include <mbgl/util/std.hpp>
+#include <mbgl/util/arena.hpp>
 #include <mbgl/platform/gl.hpp>
 #include <mbgl/platform/log.hpp>
 
@@ -16,26 +17,39 @@ using namespace mbgl;
 
 
 
-void *FillBucket::alloc(void *, unsigned int size) {
+void *FillBucket::alloc(void *arena, unsigned int size) {
+    if (arena) {
+        return static_cast<util::Arena *>(arena)->allocate(size);
+    }
     return ::malloc(size);
 }
 
-void *FillBucket::realloc(void *, void *ptr, unsigned int size) {
+void *FillBucket::realloc(void *arena, void *ptr, unsigned int size) {
+    if (arena) {
+        return static_cast<util::Arena *>(arena)->reallocate(ptr, size);
+    }
     return ::realloc(ptr, size);
 }
 
-void FillBucket::free(void *, void *ptr) {
-    ::free(ptr);
+void FillBucket::free(void *arena, void *ptr) {
+    if (arena) {
+        static_cast<util::Arena *>(arena)->deallocate(ptr);
+    } else {
+        ::free(ptr);
+    }
 }
 
 FillBucket::FillBucket(FillVertexBuffer &vertexBuffer_,
                        TriangleElementsBuffer &triangleElementsBuffer_,
-                       LineElementsBuffer &lineElementsBuffer_)
-    : allocator(new TESSalloc{
+                       LineElementsBuffer &lineElementsBuffer_,
+                       Triangulation triangulation_,
+                       util::Arena *arena)
+    : triangulation(triangulation_),
+      allocator(TESSalloc{
           &alloc,
           &realloc,
           &free,
-          nullptr, // userData
+          arena,   // userData
           64,      // meshEdgeBucketSize
           64,      // meshVertexBucketSize
           32,      // meshFaceBucketSize
@@ -43,28 +57,28 @@ FillBucket::FillBucket(FillVertexBuffer &vertexBuffer_,
           8,       // regionBucketSize
           128,     // extraVertices allocated for the priority queue.
       }),
-      tesselator(tessNewTess(allocator)),
-      vertexBuffer(vertexBuffer_),
-      triangleElementsBuffer(triangleElementsBuffer_),
-      lineElementsBuffer(lineElementsBuffer_),
+      vertexBuffer(&vertexBuffer_),
+      triangleElementsBuffer(&triangleElementsBuffer_),
+      lineElementsBuffer(&lineElementsBuffer_),
       vertex_start(vertexBuffer_.index()),
       triangle_elements_start(triangleElementsBuffer_.index()),
-      line_elements_start(lineElementsBuffer.index()) {
-    assert(tesselator);
+      line_elements_start(lineElementsBuffer_.index()) {
 }
 
 FillBucket::~FillBucket() {
-    if (tesselator) {
+    // A tessellator that lives in an arena is given back after every feature.
+    if (tesselator && !allocator.userData) {
         tessDeleteTess(tesselator);
     }
-    if (allocator) {
-        delete allocator;
-    }
 }
 
-void FillBucket::addGeometry(const GeometryCollection& geometryCollection) {
-    for (auto& line_ : geometryCollection) {
-        for (auto& v : line_) {
+void FillBucket::addGeometry(const GeometryBuffer& geometry) {
+    if (triangulation == Triangulation::Earcut && triangulate(geometry)) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < geometry.lineCount(); i++) {
+        for (const auto& v : geometry.line(i)) {
             line.emplace_back(v.x, v.y);
         }
         if (line.size()) {
@@ -83,7 +97,6 @@ void FillBucket::tessellate() {
     }
     hasVertices = false;
 
-    std::vector<std::vector<ClipperLib::IntPoint>> polygons;
     clipper.Execute(ClipperLib::ctUnion, polygons, ClipperLib::pftPositive);
     clipper.Clear();
 
@@ -100,38 +113,31 @@ void FillBucket::tessellate() {
         throw geometry_too_long_exception();
     }
 
-    if (!lineGroups.size() || (lineGroups.back()->vertex_length + total_vertex_count > 65535)) {
-        // Move to a new group because the old one can't hold the geometry.
-        lineGroups.emplace_back(util::make_unique<LineGroup>());
+    // With an arena, everything libtess2 allocates for this feature is given back once the
+    // triangles are in the buffers. That includes the tessellator: its region pool grows while
+    // tessellating, so one that is kept across features would point into rewound memory.
+    util::Arena *arena = static_cast<util::Arena *>(allocator.userData);
+    const util::Arena::Mark mark = arena ? arena->mark() : util::Arena::Mark();
+
+    if (!tesselator) {
+        tesselator = tessNewTess(&allocator);
+        if (!tesselator) {
+            throw std::bad_alloc();
+        }
     }
 
-    assert(lineGroups.back());
-    LineGroup& lineGroup = *lineGroups.back();
-    uint32_t lineIndex = lineGroup.vertex_length;
+    LineGroup& lineGroup = addOutlines(polygons, polygons.size(), total_vertex_count);
 
     for (const auto& polygon : polygons) {
-        const size_t group_count = polygon.size();
-        assert(group_count >= 3);
-
-        std::vector<TESSreal> clipped_line;
+        clipped_line.clear();
         for (const auto& pt : polygon) {
             clipped_line.push_back(pt.X);
             clipped_line.push_back(pt.Y);
-            vertexBuffer.add(pt.X, pt.Y);
-        }
-
-        for (size_t i = 0; i < group_count; i++) {
-            const size_t prev_i = (i == 0 ? group_count : i) - 1;
-            lineElementsBuffer.add(lineIndex + prev_i, lineIndex + i);
         }
 
-        lineIndex += group_count;
-
         tessAddContour(tesselator, vertexSize, clipped_line.data(), stride, (int)clipped_line.size() / vertexSize);
     }
 
-    lineGroup.elements_length += total_vertex_count;
-
     if (tessTesselate(tesselator, TESS_WINDING_POSITIVE, TESS_POLYGONS, vertices_per_group, vertexSize, 0)) {
         const TESSreal *vertices = tessGetVertices(tesselator);
         const size_t vertex_count = tessGetVertexCount(tesselator);
@@ -139,9 +145,11 @@ void FillBucket::tessellate() {
         const TESSindex *elements = tessGetElements(tesselator);
         const int triangle_count = tessGetElementCount(tesselator);
 
+        triangleElementsBuffer->reserve(triangle_count);
+
         for (size_t i = 0; i < vertex_count; ++i) {
             if (vertex_indices[i] == TESS_UNDEF) {
-                vertexBuffer.add(std::round(vertices[i * 2]), std::round(vertices[i * 2 + 1]));
+                vertexBuffer->add(std::round(vertices[i * 2]), std::round(vertices[i * 2 + 1]));
                 vertex_indices[i] = (TESSindex)total_vertex_count;
                 total_vertex_count++;
             }
@@ -167,7 +175,7 @@ void FillBucket::tessellate() {
                 const TESSindex c = vertex_indices[element_group[2]];
 
                 if (a != TESS_UNDEF && b != TESS_UNDEF && c != TESS_UNDEF) {
-                    triangleElementsBuffer.add(triangleIndex + a, triangleIndex + b, triangleIndex + c);
+                    triangleElementsBuffer->add(triangleIndex + a, triangleIndex + b, triangleIndex + c);
                 } else {
 #if defined(DEBUG)
                     // TODO: We're missing a vertex that was not part of the line.
@@ -193,6 +201,130 @@ void FillBucket::tessellate() {
     // in the tessellation step. They won't be part of the actual lines, but
     // we need to skip over them anyway if we draw the next group.
     lineGroup.vertex_length += total_vertex_count;
+
+    if (arena) {
+        tesselator = nullptr;
+        arena->rewind(mark);
+    }
+}
+
+// Triangulates the feature with earcut if its rings form valid polygons. Vector tiles list each
+// polygon's outer ring, which has a positive area, before its holes. Returns false without
+// adding anything if the feature needs to go through Clipper and libtess2 instead.
+bool FillBucket::triangulate(const GeometryBuffer& geometry) {
+    // Collect the rings without repeated points, and skip the ones that don't cover any area.
+    // The rings beyond ring_count are kept, so that the next features can reuse their memory.
+    size_t ring_count = 0;
+    size_t total_vertex_count = 0;
+    for (size_t i = 0; i < geometry.lineCount(); i++) {
+        if (ring_count == rings.size()) {
+            rings.emplace_back();
+        }
+        auto& ring = rings[ring_count];
+        ring.clear();
+
+        for (const auto& v : geometry.line(i)) {
+            const ClipperLib::IntPoint pt(v.x, v.y);
+            if (ring.empty() || ring.back() != pt) {
+                ring.push_back(pt);
+            }
+        }
+        if (ring.size() > 1 && ring.front() == ring.back()) {
+            ring.pop_back();
+        }
+
+        const double area = ring.size() >= 3 ? ClipperLib::Area(ring) : 0;
+        if (area < 0 && ring_count == 0) {
+            // A hole without an outer ring.
+            return false;
+        } else if (area != 0) {
+            total_vertex_count += ring.size();
+            ring_count++;
+        }
+    }
+    if (ring_count == 0) {
+        return true;
+    }
+
+    if (total_vertex_count > 65535) {
+        return false;
+    }
+
+    triangles.clear();
+    uint32_t offset = 0;
+    const auto rings_end = rings.cbegin() + ring_count;
+    for (auto outer = rings.cbegin(); outer != rings_end;) {
+        uint32_t polygon_offset = offset;
+        auto holes = outer + 1;
+        offset += uint32_t(outer->size());
+        while (holes != rings_end && ClipperLib::Area(*holes) < 0) {
+            offset += uint32_t(holes->size());
+            ++holes;
+        }
+
+        if (!earcut(outer, holes, polygon_offset, triangles)) {
+            return false;
+        }
+        outer = holes;
+    }
+
+    addOutlines(rings, ring_count, total_vertex_count).vertex_length += total_vertex_count;
+
+    if (!triangleGroups.size() || (triangleGroups.back()->vertex_length + total_vertex_count > 65535)) {
+        // Move to a new group because the old one can't hold the geometry.
+        triangleGroups.emplace_back(util::make_unique<TriangleGroup>());
+    }
+
+    assert(triangleGroups.back());
+    TriangleGroup& triangleGroup = *triangleGroups.back();
+    const uint32_t triangleIndex = triangleGroup.vertex_length;
+
+    TriangleElementsBuffer::element_type *elements = triangleElementsBuffer->append(triangles.size() / 3);
+    for (const uint32_t index : triangles) {
+        *elements++ = triangleIndex + index;
+    }
+
+    triangleGroup.vertex_length += total_vertex_count;
+    triangleGroup.elements_length += triangles.size() / 3;
+
+    return true;
+}
+
+// Adds the vertices of the first rings, and the elements that draw them as outlines. The
+// caller adds the vertex count to the line group once it added all of its vertices.
+FillBucket::LineGroup& FillBucket::addOutlines(const std::vector<std::vector<ClipperLib::IntPoint>>& rings_,
+                                               size_t ring_count, size_t total_vertex_count) {
+    if (!lineGroups.size() || (lineGroups.back()->vertex_length + total_vertex_count > 65535)) {
+        // Move to a new group because the old one can't hold the geometry.
+        lineGroups.emplace_back(util::make_unique<LineGroup>());
+    }
+
+    assert(lineGroups.back());
+    LineGroup& lineGroup = *lineGroups.back();
+    uint32_t lineIndex = lineGroup.vertex_length;
+
+    // Every vertex starts one line of the outline.
+    FillVertexBuffer::vertex_type *vertices = vertexBuffer->append(total_vertex_count);
+    LineElementsBuffer::element_type *elements = lineElementsBuffer->append(total_vertex_count);
+
+    for (size_t r = 0; r < ring_count; r++) {
+        const auto& polygon = rings_[r];
+        const size_t group_count = polygon.size();
+        assert(group_count >= 3);
+
+        for (size_t i = 0; i < group_count; i++) {
+            const size_t prev_i = (i == 0 ? group_count : i) - 1;
+            *vertices++ = polygon[i].X;
+            *vertices++ = polygon[i].Y;
+            *elements++ = lineIndex + prev_i;
+            *elements++ = lineIndex + i;
+        }
+
+        lineIndex += group_count;
+    }
+
+    lineGroup.elements_length += total_vertex_count;
+    return lineGroup;
 }
 
 void FillBucket::render(Painter &painter, const StyleLayer &layer_desc, const TileID &id,
@@ -200,42 +332,62 @@ void FillBucket::render(Painter &painter, const StyleLayer &layer_desc, const Ti
     painter.renderFill(*this, layer_desc, id, matrix);
 }
 
+void FillBucket::moveTo(FillVertexBuffer &vertexBuffer_,
+                        TriangleElementsBuffer &triangleElementsBuffer_,
+                        LineElementsBuffer &lineElementsBuffer_) {
+    const size_t vertex_start_ = vertexBuffer_.index();
+    const size_t triangle_elements_start_ = triangleElementsBuffer_.index();
+    const size_t line_elements_start_ = lineElementsBuffer_.index();
+
+    // Element indices are relative to their group's vertices, so they are still valid.
+    vertexBuffer_.appendFrom(*vertexBuffer, vertex_start);
+    triangleElementsBuffer_.appendFrom(*triangleElementsBuffer, triangle_elements_start);
+    lineElementsBuffer_.appendFrom(*lineElementsBuffer, line_elements_start);
+
+    vertexBuffer = &vertexBuffer_;
+    triangleElementsBuffer = &triangleElementsBuffer_;
+    lineElementsBuffer = &lineElementsBuffer_;
+    vertex_start = vertex_start_;
+    triangle_elements_start = triangle_elements_start_;
+    line_elements_start = line_elements_start_;
+}
+
 bool FillBucket::hasData() const {
     return !triangleGroups.empty() || !lineGroups.empty();
 }
 
 void FillBucket::drawElements(PlainShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer->itemSize);
     for (auto& group : triangleGroups) {
         assert(group);
-        group->array[0].bind(shader, vertexBuffer, triangleElementsBuffer, vertex_index);
+        group->array[0].bind(shader, *vertexBuffer, *triangleElementsBuffer, vertex_index);
         MBGL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, group->elements_length * 3, GL_UNSIGNED_SHORT, elements_index));
-        vertex_index += group->vertex_length * vertexBuffer.itemSize;
-        elements_index += group->elements_length * triangleElementsBuffer.itemSize;
+        vertex_index += group->vertex_length * vertexBuffer->itemSize;
+        elements_index += group->elements_length * triangleElementsBuffer->itemSize;
     }
 }
 
 void FillBucket::drawElements(PatternShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer->itemSize);
     for (auto& group : triangleGroups) {
         assert(group);
-        group->array[1].bind(shader, vertexBuffer, triangleElementsBuffer, vertex_index);
+        group->array[1].bind(shader, *vertexBuffer, *triangleElementsBuffer, vertex_index);
         MBGL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, group->elements_length * 3, GL_UNSIGNED_SHORT, elements_index));
-        vertex_index += group->vertex_length * vertexBuffer.itemSize;
-        elements_index += group->elements_length * triangleElementsBuffer.itemSize;
+        vertex_index += group->vertex_length * vertexBuffer->itemSize;
+        elements_index += group->elements_length * triangleElementsBuffer->itemSize;
     }
 }
 
 void FillBucket::drawVertices(OutlineShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(line_elements_start * lineElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(line_elements_start * lineElementsBuffer->itemSize);
     for (auto& group : lineGroups) {
         assert(group);
-        group->array[0].bind(shader, vertexBuffer, lineElementsBuffer, vertex_index);
+        group->array[0].bind(shader, *vertexBuffer, *lineElementsBuffer, vertex_index);
         MBGL_CHECK_ERROR(glDrawElements(GL_LINES, group->elements_length * 2, GL_UNSIGNED_SHORT, elements_index));
-        vertex_index += group->vertex_length * vertexBuffer.itemSize;
-        elements_index += group->elements_length * lineElementsBuffer.itemSize;
+        vertex_index += group->vertex_length * vertexBuffer->itemSize;
+        elements_index += group->elements_length * lineElementsBuffer->itemSize;
     }
 }
@@ -4,6 +4,7 @@
 #include <mbgl/renderer/bucket.hpp>
 #include <mbgl/map/geometry_tile.hpp>
 #include <mbgl/geometry/elements_buffer.hpp>
+#include <mbgl/geometry/earcut.hpp>
 
 #include <clipper/clipper.hpp>
 #include <libtess2/tesselator.h>
@@ -17,6 +18,10 @@
 
 namespace mbgl {
 
+namespace util {
+class Arena;
+}
+
 class FillVertexBuffer;
 class OutlineShader;
 class PlainShader;
@@ -32,40 +37,68 @@ class FillBucket : public Bucket {
     typedef ElementGroup<1> LineGroup;
 
 public:
+    // How the polygons are turned into triangles.
+    enum class Triangulation : uint8_t {
+        // Ear clipping for valid polygons, and Clipper and libtess2 for the others.
+        Earcut,
+        // Clipper and libtess2 for all polygons.
+        LibTess,
+    };
+
+    // libtess2 allocates from the arena, if there is one, and its memory is rewound after each
+    // feature. No geometry may be added once the arena is gone. Nothing else may add to the
+    // buffers while the bucket is being filled, since its geometry has to be contiguous.
     FillBucket(FillVertexBuffer &vertexBuffer,
                TriangleElementsBuffer &triangleElementsBuffer,
-               LineElementsBuffer &lineElementsBuffer);
+               LineElementsBuffer &lineElementsBuffer,
+               Triangulation triangulation = Triangulation::Earcut,
+               util::Arena *arena = nullptr);
     ~FillBucket() override;
 
     void render(Painter &painter, const StyleLayer &layer_desc, const TileID &id,
                 const mat4 &matrix) override;
     bool hasData() const override;
 
-    void addGeometry(const GeometryCollection&);
+    void addGeometry(const GeometryBuffer&);
     void tessellate();
 
+    // Appends the geometry to the given buffers, and draws from them from now on.
+    void moveTo(FillVertexBuffer&, TriangleElementsBuffer&, LineElementsBuffer&);
+
     void drawElements(PlainShader& shader);
     void drawElements(PatternShader& shader);
     void drawVertices(OutlineShader& shader);
 
 private:
-    TESSalloc *allocator;
-    TESStesselator *tesselator;
+    bool triangulate(const GeometryBuffer&);
+    LineGroup& addOutlines(const std::vector<std::vector<ClipperLib::IntPoint>>&, size_t ring_count, size_t vertex_count);
+
+    const Triangulation triangulation;
+    Earcut earcut;
+
+    TESSalloc allocator;
+    // Created when the first feature needs it, and for every feature with an arena.
+    TESStesselator *tesselator = nullptr;
     ClipperLib::Clipper clipper;
 
-    FillVertexBuffer& vertexBuffer;
-    TriangleElementsBuffer& triangleElementsBuffer;
-    LineElementsBuffer& lineElementsBuffer;
+    FillVertexBuffer* vertexBuffer;
+    TriangleElementsBuffer* triangleElementsBuffer;
+    LineElementsBuffer* lineElementsBuffer;
 
     // hold information on where the vertices are located in the FillBuffer
-    const size_t vertex_start;
-    const size_t triangle_elements_start;
-    const size_t line_elements_start;
+    size_t vertex_start;
+    size_t triangle_elements_start;
+    size_t line_elements_start;
 
     std::vector<std::unique_ptr<TriangleGroup>> triangleGroups;
     std::vector<std::unique_ptr<LineGroup>> lineGroups;
 
+    // Scratch space kept across features so that they don't need to be reallocated.
     std::vector<ClipperLib::IntPoint> line;
+    std::vector<std::vector<ClipperLib::IntPoint>> rings;
+    std::vector<std::vector<ClipperLib::IntPoint>> polygons;
+    std::vector<TESSreal> clipped_line;
+    std::vector<uint32_t> triangles;
     bool hasVertices = false;
 
     static const int vertexSize = 2;
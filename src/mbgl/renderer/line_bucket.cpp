@@ -17,9 +17,9 @@ using namespace mbgl;
 LineBucket::LineBucket(LineVertexBuffer &vertexBuffer_,
                        TriangleElementsBuffer &triangleElementsBuffer_,
                        PointElementsBuffer &pointElementsBuffer_)
-    : vertexBuffer(vertexBuffer_),
-      triangleElementsBuffer(triangleElementsBuffer_),
-      pointElementsBuffer(pointElementsBuffer_),
+    : vertexBuffer(&vertexBuffer_),
+      triangleElementsBuffer(&triangleElementsBuffer_),
+      pointElementsBuffer(&pointElementsBuffer_),
       vertex_start(vertexBuffer_.index()),
       triangle_elements_start(triangleElementsBuffer_.index()),
       point_elements_start(pointElementsBuffer_.index()) {
@@ -29,20 +29,19 @@ LineBucket::~LineBucket() {
     // Do not remove. header file only contains forward definitions to unique pointers.
 }
 
-struct TriangleElement {
-    TriangleElement(uint16_t a_, uint16_t b_, uint16_t c_) : a(a_), b(b_), c(c_) {}
-    uint16_t a, b, c;
-};
-
-typedef uint16_t PointElement;
-
-void LineBucket::addGeometry(const GeometryCollection& geometryCollection) {
-    for (auto& line : geometryCollection) {
-        addGeometry(line);
+void LineBucket::addGeometry(const GeometryBuffer& geometry) {
+    const bool simplify = layout.simplify && tolerance > 0;
+    for (std::size_t i = 0; i < geometry.lineCount(); i++) {
+        if (simplify) {
+            simplifier(geometry.line(i), tolerance, simplified);
+            addGeometry(GeometryBuffer::Line(simplified.data(), simplified.data() + simplified.size()));
+        } else {
+            addGeometry(geometry.line(i));
+        }
     }
 }
 
-void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
+void LineBucket::addGeometry(const GeometryBuffer::Line& vertices) {
     // TODO: use roundLimit
     // const float roundLimit = geometry.round_limit;
 
@@ -81,10 +80,13 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         nextNormal = util::normal<double>(currentVertex, lastVertex);
     }
 
-    int32_t start_vertex = (int32_t)vertexBuffer.index();
+    int32_t start_vertex = (int32_t)vertexBuffer->index();
 
-    std::vector<TriangleElement> triangle_store;
-    std::vector<PointElement> point_store;
+    // Miter joins and caps add two vertices per point, and round and bevel joins up to four.
+    vertexBuffer->reserve((layout.join == JoinType::Miter ? 2 : 4) * vertices.size());
+
+    triangle_store.clear();
+    point_store.clear();
 
     for (size_t i = 0; i < vertices.size(); ++i) {
         if (nextNormal) prevNormal = { -nextNormal.x, -nextNormal.y };
@@ -152,7 +154,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         // Add offset square begin cap.
         if (!prevVertex && beginCap == CapType::Square) {
             // Add first vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    flip * (prevNormal.x + prevNormal.y), flip * (-prevNormal.x + prevNormal.y), // extrude normal
                                    0, 0, distance) - start_vertex; // texture normal
 
@@ -160,7 +162,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             e1 = e2; e2 = e3;
 
             // Add second vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    flip * (prevNormal.x - prevNormal.y), flip * (prevNormal.x + prevNormal.y), // extrude normal
                                    0, 1, distance) - start_vertex; // texture normal
 
@@ -171,7 +173,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         // Add offset square end cap.
         else if (!nextVertex && endCap == CapType::Square) {
             // Add first vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    nextNormal.x - flip * nextNormal.y, flip * nextNormal.x + nextNormal.y, // extrude normal
                                    0, 0, distance) - start_vertex; // texture normal
 
@@ -179,7 +181,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             e1 = e2; e2 = e3;
 
             // Add second vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    nextNormal.x + flip * nextNormal.y, -flip * nextNormal.x + nextNormal.y, // extrude normal
                                    0, 1, distance) - start_vertex; // texture normal
 
@@ -205,7 +207,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             }
 
             // Add first vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    flip * joinNormal.x, flip * joinNormal.y, // extrude normal
                                    0, 0, distance) - start_vertex; // texture normal
 
@@ -213,7 +215,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             e1 = e2; e2 = e3;
 
             // Add second vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    -flip * joinNormal.x, -flip * joinNormal.y, // extrude normal
                                    0, 1, distance) - start_vertex; // texture normal
 
@@ -229,7 +231,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         else {
             // Close up the previous line
             // Add first vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    flip * prevNormal.y, -flip * prevNormal.x, // extrude normal
                                    0, 0, distance) - start_vertex; // texture normal
 
@@ -237,7 +239,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             e1 = e2; e2 = e3;
 
             // Add second vertex.
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    -flip * prevNormal.y, flip * prevNormal.x, // extrude normal
                                    0, 1, distance) - start_vertex; // texture normal
 
@@ -267,7 +269,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
 
             // Start the new quad.
             // Add first vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    -flip * nextNormal.y, flip * nextNormal.x, // extrude normal
                                    0, 0, distance) - start_vertex; // texture normal
 
@@ -275,7 +277,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
             e1 = e2; e2 = e3;
 
             // Add second vertex
-            e3 = (int32_t)vertexBuffer.add(currentVertex.x, currentVertex.y, // vertex pos
+            e3 = (int32_t)vertexBuffer->add(currentVertex.x, currentVertex.y, // vertex pos
                                    flip * nextNormal.y, -flip * nextNormal.x, // extrude normal
                                    0, 1, distance) - start_vertex; // texture normal
 
@@ -284,7 +286,7 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
         }
     }
 
-    size_t end_vertex = vertexBuffer.index();
+    size_t end_vertex = vertexBuffer->index();
     size_t vertex_count = end_vertex - start_vertex;
 
     // Store the triangle/line groups.
@@ -296,12 +298,11 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
 
         assert(triangleGroups.back());
         triangle_group_type& group = *triangleGroups.back();
+        TriangleElementsBuffer::element_type *elements = triangleElementsBuffer->append(triangle_store.size());
         for (const auto& triangle : triangle_store) {
-            triangleElementsBuffer.add(
-                group.vertex_length + triangle.a,
-                group.vertex_length + triangle.b,
-                group.vertex_length + triangle.c
-            );
+            *elements++ = group.vertex_length + triangle.a;
+            *elements++ = group.vertex_length + triangle.b;
+            *elements++ = group.vertex_length + triangle.c;
         }
 
         group.vertex_length += vertex_count;
@@ -317,8 +318,9 @@ void LineBucket::addGeometry(const std::vector<Coordinate>& vertices) {
 
         assert(pointGroups.back());
         point_group_type& group = *pointGroups.back();
+        PointElementsBuffer::element_type *elements = pointElementsBuffer->append(point_store.size());
         for (const auto point : point_store) {
-            pointElementsBuffer.add(group.vertex_length + point);
+            *elements++ = group.vertex_length + point;
         }
 
         group.vertex_length += vertex_count;
@@ -331,6 +333,26 @@ void LineBucket::render(Painter &painter, const StyleLayer &layer_desc, const Ti
     painter.renderLine(*this, layer_desc, id, matrix);
 }
 
+void LineBucket::moveTo(LineVertexBuffer &vertexBuffer_,
+                        TriangleElementsBuffer &triangleElementsBuffer_,
+                        PointElementsBuffer &pointElementsBuffer_) {
+    const size_t vertex_start_ = vertexBuffer_.index();
+    const size_t triangle_elements_start_ = triangleElementsBuffer_.index();
+    const size_t point_elements_start_ = pointElementsBuffer_.index();
+
+    // Element indices are relative to their group's vertices, so they are still valid.
+    vertexBuffer_.appendFrom(*vertexBuffer, vertex_start);
+    triangleElementsBuffer_.appendFrom(*triangleElementsBuffer, triangle_elements_start);
+    pointElementsBuffer_.appendFrom(*pointElementsBuffer, point_elements_start);
+
+    vertexBuffer = &vertexBuffer_;
+    triangleElementsBuffer = &triangleElementsBuffer_;
+    pointElementsBuffer = &pointElementsBuffer_;
+    vertex_start = vertex_start_;
+    triangle_elements_start = triangle_elements_start_;
+    point_elements_start = point_elements_start_;
+}
+
 bool LineBucket::hasData() const {
     return !triangleGroups.empty() || !pointGroups.empty();
 }
@@ -348,61 +370,61 @@ bool LineBucket::hasPoints() const {
 }
 
 void LineBucket::drawLines(LineShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer->itemSize);
     for (auto& group : triangleGroups) {
         assert(group);
         if (!group->elements_length) {
             continue;
         }
-        group->array[0].bind(shader, vertexBuffer, triangleElementsBuffer, vertex_index);
+        group->array[0].bind(shader, *vertexBuffer, *triangleElementsBuffer, vertex_index);
         MBGL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, group->elements_length * 3, GL_UNSIGNED_SHORT, elements_index));
-        vertex_index += group->vertex_length * vertexBuffer.itemSize;
-        elements_index += group->elements_length * triangleElementsBuffer.itemSize;
+        vertex_index += group->vertex_length * vertexBuffer->itemSize;
+        elements_index += group->elements_length * triangleElementsBuffer->itemSize;
     }
 }
 
 void LineBucket::drawLineSDF(LineSDFShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer->itemSize);
     for (auto& group : triangleGroups) {
         assert(group);
         if (!group->elements_length) {
             continue;
         }
-        group->array[2].bind(shader, vertexBuffer, triangleElementsBuffer, vertex_index);
+        group->array[2].bind(shader, *vertexBuffer, *triangleElementsBuffer, vertex_index);
         MBGL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, group->elements_length * 3, GL_UNSIGNED_SHORT, elements_index));
-        vertex_index += group->vertex_length * vertexBuffer.itemSize;
-        elements_index += group->elements_length * triangleElementsBuffer.itemSize;
+        vertex_index += group->vertex_length * vertexBuffer->itemSize;
+        elements_index += group->elements_length * triangleElementsBuffer->itemSize;
     }
 }
 
 void LineBucket::drawLinePatterns(LinepatternShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(triangle_elements_start * triangleElementsBuffer->itemSize);
     for (auto& group : triangleGroups) {
         assert(group);
         if (!group->elements_length) {
             continue;
         }
-        group->array[1].bind(shader, vertexBuffer, triangleElementsBuffer, vertex_index);
+        group->array[1].bind(shader, *vertexBuffer, *triangleElementsBuffer, vertex_index);
         MBGL_CHECK_ERROR(glDrawElements(GL_TRIANGLES, group->elements_length * 3, GL_UNSIGNED_SHORT, elements_index));
-        vertex_index += group->vertex_length * vertexBuffer.itemSize;
-        elements_index += group->elements_length * triangleElementsBuffer.itemSize;
+        vertex_index += group->vertex_length * vertexBuffer->itemSize;
+        elements_index += group->elements_length * triangleElementsBuffer->itemSize;
     }
 }
 
 void LineBucket::drawPoints(LinejoinShader& shader) {
-    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer.itemSize);
-    char *elements_index = BUFFER_OFFSET(point_elements_start * pointElementsBuffer.itemSize);
+    char *vertex_index = BUFFER_OFFSET(vertex_start * vertexBuffer->itemSize);
+    char *elements_index = BUFFER_OFFSET(point_elements_start * pointElementsBuffer->itemSize);
     for (auto& group : pointGroups) {
         assert(group);
         if (!group->elements_length) {
             continue;
         }
-        group->array[0].bind(shader, vertexBuffer, pointElementsBuffer, vertex_index);
+        group->array[0].bind(shader, *vertexBuffer, *pointElementsBuffer, vertex_index);
         MBGL_CHECK_ERROR(glDrawElements(GL_POINTS, group->elements_length, GL_UNSIGNED_SHORT, elements_index));
-        vertex_index += group->vertex_length * vertexBuffer.itemSize;
-        elements_index += group->elements_length * pointElementsBuffer.itemSize;
+        vertex_index += group->vertex_length * vertexBuffer->itemSize;
+        elements_index += group->elements_length * pointElementsBuffer->itemSize;
     }
 }
@@ -6,6 +6,7 @@
 #include <mbgl/geometry/vao.hpp>
 #include <mbgl/geometry/elements_buffer.hpp>
 #include <mbgl/geometry/line_buffer.hpp>
+#include <mbgl/geometry/simplify.hpp>
 #include <mbgl/style/style_bucket.hpp>
 #include <mbgl/style/style_layout.hpp>
 #include <mbgl/util/vec.hpp>
@@ -27,6 +28,8 @@ class LineBucket : public Bucket {
     typedef ElementGroup<1> point_group_type;
 
 public:
+    // Nothing else may add to the buffers while the bucket is being filled, since its geometry
+    // has to be contiguous.
     LineBucket(LineVertexBuffer &vertexBuffer,
                TriangleElementsBuffer &triangleElementsBuffer,
                PointElementsBuffer &pointElementsBuffer);
@@ -36,8 +39,11 @@ public:
                 const mat4 &matrix) override;
     bool hasData() const override;
 
-    void addGeometry(const GeometryCollection&);
-    void addGeometry(const std::vector<Coordinate>& line);
+    void addGeometry(const GeometryBuffer&);
+    void addGeometry(const GeometryBuffer::Line&);
+
+    // Appends the geometry to the given buffers, and draws from them from now on.
+    void moveTo(LineVertexBuffer&, TriangleElementsBuffer&, PointElementsBuffer&);
 
     bool hasPoints() const;
 
@@ -49,17 +55,36 @@ public:
 public:
     StyleLayoutLine layout;
 
+    // Lines are simplified with this tolerance, in tile units, before their joins are built
+    // if the layout asks for it.
+    double tolerance = 0;
+
 private:
-    LineVertexBuffer& vertexBuffer;
-    TriangleElementsBuffer& triangleElementsBuffer;
-    PointElementsBuffer& pointElementsBuffer;
+    LineVertexBuffer* vertexBuffer;
+    TriangleElementsBuffer* triangleElementsBuffer;
+    PointElementsBuffer* pointElementsBuffer;
 
-    const size_t vertex_start;
-    const size_t triangle_elements_start;
-    const size_t point_elements_start;
+    size_t vertex_start;
+    size_t triangle_elements_start;
+    size_t point_elements_start;
 
     std::vector<std::unique_ptr<triangle_group_type>> triangleGroups;
     std::vector<std::unique_ptr<point_group_type>> pointGroups;
+
+    struct TriangleElement {
+        TriangleElement(uint16_t a_, uint16_t b_, uint16_t c_) : a(a_), b(b_), c(c_) {}
+        uint16_t a, b, c;
+    };
+
+    typedef uint16_t PointElement;
+
+    // Scratch space for the elements of the line that is being added. Kept across lines so
+    // that adding a line doesn't allocate once they have grown large enough.
+    std::vector<TriangleElement> triangle_store;
+    std::vector<PointElement> point_store;
+
+    LineSimplifier simplifier;
+    std::vector<Coordinate> simplified;
 };
 
 }
@@ -1,5 +1,6 @@
 #include <mbgl/renderer/painter.hpp>
 #include <mbgl/platform/log.hpp>
+#include <mbgl/renderer/fill_bucket.hpp>
 #include <mbgl/style/style.hpp>
 #include <mbgl/style/style_layer.hpp>
 #include <mbgl/style/style_bucket.hpp>
@@ -18,6 +19,7 @@
 
 #include <cassert>
 #include <algorithm>
+#include <tuple>
 #include <iostream>
 
 using namespace mbgl;
@@ -72,6 +74,15 @@ void Painter::setup() {
     assert(gaussianShader);
 
 
+    // The context may be new, so the cached state has to match GL's defaults for the calls
+    // below to take effect.
+    gl_depthTest = false;
+    gl_stencilTest = false;
+    gl_stencilFunc = GL_ALWAYS;
+    gl_stencilRef = 0;
+    gl_stencilFuncMask = ~0u;
+    gl_stencilMask = ~0u;
+
     // Blending
     // We are blending new pixels on top of old pixels. Since we have depth testing
     // and are drawing opaque fragments first front-to-back, then translucent
@@ -85,11 +96,11 @@ void Painter::setup() {
     MBGL_CHECK_ERROR(glClearStencil(0x0));
 
     // Stencil test
-    MBGL_CHECK_ERROR(glEnable(GL_STENCIL_TEST));
+    stencilTest(true);
     MBGL_CHECK_ERROR(glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE));
 
     // Depth test
-    glDepthFunc(GL_LEQUAL);
+    MBGL_CHECK_ERROR(glDepthFunc(GL_LEQUAL));
 }
 
 void Painter::setupShaders() {
@@ -132,6 +143,7 @@ void Painter::resize() {
         gl_viewport = state.getFramebufferDimensions();
         assert(gl_viewport[0] > 0 && gl_viewport[1] > 0);
         MBGL_CHECK_ERROR(glViewport(0, 0, gl_viewport[0], gl_viewport[1]));
+        glCalls++;
     }
 }
 
@@ -142,6 +154,7 @@ void Painter::setDebug(bool enabled) {
 void Painter::useProgram(uint32_t program) {
     if (gl_program != program) {
         MBGL_CHECK_ERROR(glUseProgram(program));
+        glCalls++;
         gl_program = program;
     }
 }
@@ -149,6 +162,7 @@ void Painter::useProgram(uint32_t program) {
 void Painter::lineWidth(float line_width) {
     if (gl_lineWidth != line_width) {
         MBGL_CHECK_ERROR(glLineWidth(line_width));
+        glCalls++;
         gl_lineWidth = line_width;
     }
 }
@@ -156,6 +170,7 @@ void Painter::lineWidth(float line_width) {
 void Painter::depthMask(bool value) {
     if (gl_depthMask != value) {
         MBGL_CHECK_ERROR(glDepthMask(value ? GL_TRUE : GL_FALSE));
+        glCalls++;
         gl_depthMask = value;
     }
 }
@@ -163,10 +178,45 @@ void Painter::depthMask(bool value) {
 void Painter::depthRange(const float near, const float far) {
     if (gl_depthRange[0] != near || gl_depthRange[1] != far) {
         MBGL_CHECK_ERROR(glDepthRange(near, far));
+        glCalls++;
         gl_depthRange = {{ near, far }};
     }
 }
 
+void Painter::depthTest(bool enabled) {
+    if (gl_depthTest != enabled) {
+        MBGL_CHECK_ERROR(enabled ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST));
+        glCalls++;
+        gl_depthTest = enabled;
+    }
+}
+
+void Painter::stencilTest(bool enabled) {
+    if (gl_stencilTest != enabled) {
+        MBGL_CHECK_ERROR(enabled ? glEnable(GL_STENCIL_TEST) : glDisable(GL_STENCIL_TEST));
+        glCalls++;
+        gl_stencilTest = enabled;
+    }
+}
+
+void Painter::stencilFunc(GLenum func, GLint ref, GLuint mask) {
+    if (gl_stencilFunc != func || gl_stencilRef != ref || gl_stencilFuncMask != mask) {
+        MBGL_CHECK_ERROR(glStencilFunc(func, ref, mask));
+        glCalls++;
+        gl_stencilFunc = func;
+        gl_stencilRef = ref;
+        gl_stencilFuncMask = mask;
+    }
+}
+
+void Painter::stencilMask(GLuint mask) {
+    if (gl_stencilMask != mask) {
+        MBGL_CHECK_ERROR(glStencilMask(mask));
+        glCalls++;
+        gl_stencilMask = mask;
+    }
+}
+
 
 void Painter::changeMatrix() {
     // Initialize projection matrix
@@ -185,17 +235,19 @@ void Painter::changeMatrix() {
 
 void Painter::clear() {
     gl::group group("clear");
-    MBGL_CHECK_ERROR(glStencilMask(0xFF));
+    stencilMask(0xFF);
     depthMask(true);
 
     MBGL_CHECK_ERROR(glClearColor(0, 0, 0, 0));
     MBGL_CHECK_ERROR(glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+    glCalls += 2;
 }
 
 void Painter::setOpaque() {
     if (pass != RenderPass::Opaque) {
         pass = RenderPass::Opaque;
         MBGL_CHECK_ERROR(glDisable(GL_BLEND));
+        glCalls++;
     }
 }
 
@@ -203,6 +255,7 @@ void Painter::setTranslucent() {
     if (pass != RenderPass::Translucent) {
         pass = RenderPass::Translucent;
         MBGL_CHECK_ERROR(glEnable(GL_BLEND));
+        glCalls++;
     }
 }
 
@@ -213,7 +266,8 @@ void Painter::setStrata(float value) {
 void Painter::prepareTile(const Tile& tile) {
     const GLint ref = (GLint)tile.clip.reference.to_ulong();
     const GLuint mask = (GLuint)tile.clip.mask.to_ulong();
-    MBGL_CHECK_ERROR(glStencilFunc(GL_EQUAL, ref, mask));
+    stencilTest(true);
+    stencilFunc(GL_EQUAL, ref, mask);
 }
 
 void Painter::render(const Style& style, TransformState state_, TimePoint time) {
@@ -260,6 +314,7 @@ void Painter::render(const Style& style, TransformState state_, TimePoint time)
         setStrata(i * strata_thickness);
         renderLayer(**it);
     }
+    drawOpaqueFills();
     if (debug::renderTree) {
         Log::Info(Event::Render, "%*s%s", --indent * 4, "", "}");
     }
@@ -291,6 +346,55 @@ void Painter::render(const Style& style, TransformState state_, TimePoint time)
     }
 }
 
+void Painter::drawOpaqueFills() {
+    if (opaqueFills.empty()) {
+        return;
+    }
+
+    gl::group group("opaque fills");
+
+    // Counts the stencil function, matrix, color and depth range changes that drawing the fills
+    // in their current order takes.
+    const auto stateChanges = [this] {
+        std::size_t changes = 4;
+        for (auto prev = opaqueFills.begin(), it = prev + 1; it != opaqueFills.end(); prev = it++) {
+            changes += (it->stencilRef != prev->stencilRef || it->stencilMask != prev->stencilMask);
+            changes += (it->matrix != prev->matrix);
+            changes += (it->color != prev->color);
+            changes += (it->strata != prev->strata);
+        }
+        return changes;
+    };
+
+    // The fills were recorded layer by layer, so consecutive fills mostly differ in their tile's
+    // stencil function and matrix. Grouping them by tile instead sets these once per tile, but
+    // changes the color and depth range for every fill. Whichever takes fewer changes is drawn.
+    // Both orders keep the fills of a tile front to back.
+    const std::size_t layerChanges = stateChanges();
+    std::sort(opaqueFills.begin(), opaqueFills.end(), [](const OpaqueFill& a, const OpaqueFill& b) {
+        return std::tie(a.stencilRef, a.stencilMask, a.strata) < std::tie(b.stencilRef, b.stencilMask, b.strata);
+    });
+    if (stateChanges() >= layerChanges) {
+        std::sort(opaqueFills.begin(), opaqueFills.end(), [](const OpaqueFill& a, const OpaqueFill& b) {
+            return std::tie(a.strata, a.stencilRef, a.stencilMask) < std::tie(b.strata, b.stencilRef, b.stencilMask);
+        });
+    }
+
+    useProgram(plainShader->program);
+    stencilTest(true);
+    depthMask(true);
+    for (const auto& fill : opaqueFills) {
+        stencilFunc(GL_EQUAL, fill.stencilRef, fill.stencilMask);
+        plainShader->u_matrix = fill.matrix;
+        plainShader->u_color = fill.color;
+        depthRange(fill.strata + strata_epsilon, 1.0f);
+        fill.bucket->drawElements(*plainShader);
+        glCalls++;
+    }
+
+    opaqueFills.clear();
+}
+
 void Painter::renderLayer(const StyleLayer &layer_desc) {
     if (layer_desc.bucket->visibility == VisibilityType::None) return;
     if (layer_desc.type == StyleLayerType::Background) {
@@ -358,7 +462,16 @@ void Painter::renderTileLayer(const Tile& tile, const StyleLayer &layer_desc, co
     assert(tile.data);
     if (tile.data->hasData(layer_desc) || layer_desc.type == StyleLayerType::Raster) {
         gl::group group(std::string { "render " } + tile.data->name);
-        prepareTile(tile);
+        if (pass == RenderPass::Opaque) {
+            // Only fills draw in the opaque pass. They are recorded with their tile's clip, and
+            // set up the stencil test when they're drawn.
+            assert(layer_desc.type == StyleLayerType::Fill);
+            tileStencilRef = (GLint)tile.clip.reference.to_ulong();
+            tileStencilMask = (GLuint)tile.clip.mask.to_ulong();
+        } else if (layer_desc.type != StyleLayerType::Symbol) {
+            // Symbols aren't clipped to their tile, so they don't need its stencil mask.
+            prepareTile(tile);
+        }
         tile.data->render(*this, layer_desc, matrix);
     }
 }
@@ -437,10 +550,10 @@ void Painter::renderBackground(const StyleLayer &layer_desc) {
         backgroundArray.bind(*plainShader, backgroundBuffer, BUFFER_OFFSET(0));
     }
 
-    MBGL_CHECK_ERROR(glDisable(GL_STENCIL_TEST));
+    stencilTest(false);
     depthRange(strata + strata_epsilon, 1.0f);
     MBGL_CHECK_ERROR(glDrawArrays(GL_TRIANGLE_STRIP, 0, 4));
-    MBGL_CHECK_ERROR(glEnable(GL_STENCIL_TEST));
+    glCalls++;
 }
 
 mat4 Painter::translatedMatrix(const mat4& matrix, const std::array<float, 2> &translation, const TileID &id, TranslateAnchorType anchor) {
@@ -138,6 +138,9 @@ private:
 
     void prepareTile(const Tile& tile);
 
+    // Draws the opaque fills that were recorded in the opaque pass.
+    void drawOpaqueFills();
+
     template <typename BucketProperties, typename StyleProperties>
     void renderSDF(SymbolBucket &bucket,
                    const TileID &id,
@@ -154,6 +157,10 @@ public:
     void lineWidth(float lineWidth);
     void depthMask(bool value);
     void depthRange(float near, float far);
+    void depthTest(bool enabled);
+    void stencilTest(bool enabled);
+    void stencilFunc(GLenum func, GLint ref, GLuint mask);
+    void stencilMask(GLuint mask);
 
 public:
     mat4 projMatrix;
@@ -185,13 +192,43 @@ private:
     bool gl_depthMask = true;
     std::array<uint16_t, 2> gl_viewport = {{ 0, 0 }};
     std::array<float, 2> gl_depthRange = {{ 0, 1 }};
+    bool gl_depthTest = false;
+    bool gl_stencilTest = false;
+    GLenum gl_stencilFunc = GL_ALWAYS;
+    GLint gl_stencilRef = 0;
+    GLuint gl_stencilFuncMask = ~0u;
+    GLuint gl_stencilMask = ~0u;
     float strata = 0;
     RenderPass pass = RenderPass::Opaque;
     const float strata_epsilon = 1.0f / (1 << 16);
 
+    // The stencil function arguments of the tile whose layer is being rendered.
+    GLint tileStencilRef = 0;
+    GLuint tileStencilMask = 0;
+
+    // Opaque fills are recorded while the layers are visited in the opaque pass, and drawn
+    // after all of them. Opaque fragments are resolved by the depth test, so these draws can
+    // be reordered to share state. They all use the plain shader.
+    struct OpaqueFill {
+        FillBucket* bucket;
+        mat4 matrix;
+        Color color;
+        GLint stencilRef;
+        GLuint stencilMask;
+        float strata;
+    };
+
+    // Kept across frames, so that recording doesn't allocate once it has grown.
+    std::vector<OpaqueFill> opaqueFills;
+
 public:
     FrameHistory frameHistory;
 
+    // GL state changes and draw calls made by the painter, which the map records in its
+    // metrics for every frame. A bucket's draw counts as one call, and uniform uploads and
+    // buffer bindings aren't counted.
+    uint64_t glCalls = 0;
+
     SpriteAtlas& spriteAtlas;
     GlyphAtlas& glyphAtlas;
     LineAtlas& lineAtlas;
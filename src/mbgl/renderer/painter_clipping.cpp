@@ -11,9 +11,11 @@ void Painter::drawClippingMasks(const std::set<Source*>& sources) {
     gl::group group("clipping masks");
 
     useProgram(plainShader->program);
-    MBGL_CHECK_ERROR(glDisable(GL_DEPTH_TEST));
+    stencilTest(true);
+    depthTest(false);
     depthMask(false);
     MBGL_CHECK_ERROR(glColorMask(false, false, false, false));
+    glCalls++;
     depthRange(1.0f, 1.0f);
 
     coveringPlainArray.bind(*plainShader, tileStencilBuffer, BUFFER_OFFSET(0));
@@ -22,10 +24,11 @@ void Painter::drawClippingMasks(const std::set<Source*>& sources) {
         source->drawClippingMasks(*this);
     }
 
-    MBGL_CHECK_ERROR(glEnable(GL_DEPTH_TEST));
+    depthTest(true);
     MBGL_CHECK_ERROR(glColorMask(true, true, true, true));
+    glCalls++;
     depthMask(true);
-    MBGL_CHECK_ERROR(glStencilMask(0x0));
+    stencilMask(0x0);
 }
 
 void Painter::drawClippingMask(const mat4& matrix, const ClipID &clip) {
@@ -33,8 +36,9 @@ void Painter::drawClippingMask(const mat4& matrix, const ClipID &clip) {
 
     const GLint ref = (GLint)(clip.reference.to_ulong());
     const GLuint mask = (GLuint)(clip.mask.to_ulong());
-    MBGL_CHECK_ERROR(glStencilFunc(GL_ALWAYS, ref, mask));
-    MBGL_CHECK_ERROR(glStencilMask(mask));
+    stencilFunc(GL_ALWAYS, ref, mask);
+    stencilMask(mask);
 
     MBGL_CHECK_ERROR(glDrawArrays(GL_TRIANGLES, 0, (GLsizei)tileStencilBuffer.index()));
+    glCalls++;
 }
@@ -19,7 +19,7 @@ void Painter::renderTileDebug(const Tile& tile) {
 void Painter::renderDebugText(DebugBucket& bucket, const mat4 &matrix) {
     gl::group group("debug text");
 
-    MBGL_CHECK_ERROR(glDisable(GL_DEPTH_TEST));
+    depthTest(false);
 
     useProgram(plainShader->program);
     plainShader->u_matrix = matrix;
@@ -28,19 +28,23 @@ void Painter::renderDebugText(DebugBucket& bucket, const mat4 &matrix) {
     plainShader->u_color = {{ 1.0f, 1.0f, 1.0f, 1.0f }};
     lineWidth(4.0f * state.getPixelRatio());
     bucket.drawLines(*plainShader);
+    glCalls++;
 
 #ifndef GL_ES_VERSION_2_0
     // Draw line "end caps"
     MBGL_CHECK_ERROR(glPointSize(2));
+    glCalls++;
     bucket.drawPoints(*plainShader);
+    glCalls++;
 #endif
 
     // Draw black text.
     plainShader->u_color = {{ 0.0f, 0.0f, 0.0f, 1.0f }};
     lineWidth(2.0f * state.getPixelRatio());
     bucket.drawLines(*plainShader);
+    glCalls++;
 
-    MBGL_CHECK_ERROR(glEnable(GL_DEPTH_TEST));
+    depthTest(true);
 }
 
 void Painter::renderDebugFrame(const mat4 &matrix) {
@@ -49,7 +53,7 @@ void Painter::renderDebugFrame(const mat4 &matrix) {
     // Disable depth test and don't count this towards the depth buffer,
     // but *don't* disable stencil test, as we want to clip the red tile border
     // to the tile viewport.
-    MBGL_CHECK_ERROR(glDisable(GL_DEPTH_TEST));
+    depthTest(false);
 
     useProgram(plainShader->program);
     plainShader->u_matrix = matrix;
@@ -59,8 +63,9 @@ void Painter::renderDebugFrame(const mat4 &matrix) {
     plainShader->u_color = {{ 1.0f, 0.0f, 0.0f, 1.0f }};
     lineWidth(4.0f * state.getPixelRatio());
     MBGL_CHECK_ERROR(glDrawArrays(GL_LINE_STRIP, 0, (GLsizei)tileBorderBuffer.index()));
+    glCalls++;
 
-    MBGL_CHECK_ERROR(glEnable(GL_DEPTH_TEST));
+    depthTest(true);
 }
 
 void Painter::renderDebugText(const std::vector<std::string> &strings) {
@@ -70,8 +75,8 @@ void Painter::renderDebugText(const std::vector<std::string> &strings) {
 
     gl::group group("debug text");
 
-    MBGL_CHECK_ERROR(glDisable(GL_DEPTH_TEST));
-    MBGL_CHECK_ERROR(glStencilFunc(GL_ALWAYS, 0xFF, 0xFF));
+    depthTest(false);
+    stencilFunc(GL_ALWAYS, 0xFF, 0xFF);
 
     useProgram(plainShader->program);
     plainShader->u_matrix = nativeMatrix;
@@ -90,14 +95,18 @@ void Painter::renderDebugText(const std::vector<std::string> &strings) {
         plainShader->u_color = {{ 1.0f, 1.0f, 1.0f, 1.0f }};
         lineWidth(4.0f * state.getPixelRatio());
         MBGL_CHECK_ERROR(glDrawArrays(GL_LINES, 0, (GLsizei)debugFontBuffer.index()));
+        glCalls++;
     #ifndef GL_ES_VERSION_2_0
         MBGL_CHECK_ERROR(glPointSize(2));
+        glCalls++;
         MBGL_CHECK_ERROR(glDrawArrays(GL_POINTS, 0, (GLsizei)debugFontBuffer.index()));
+        glCalls++;
     #endif
         plainShader->u_color = {{ 0.0f, 0.0f, 0.0f, 1.0f }};
         lineWidth(2.0f * state.getPixelRatio());
         MBGL_CHECK_ERROR(glDrawArrays(GL_LINES, 0, (GLsizei)debugFontBuffer.index()));
+        glCalls++;
     }
 
-    MBGL_CHECK_ERROR(glEnable(GL_DEPTH_TEST));
+    depthTest(true);
 }
@@ -55,6 +55,7 @@ void Painter::renderFill(FillBucket& bucket, const StyleLayer &layer_desc, const
         }};
         depthRange(strata, 1.0f);
         bucket.drawVertices(*outlineShader);
+        glCalls++;
     }
 
     if (pattern) {
@@ -89,12 +90,14 @@ void Painter::renderFill(FillBucket& bucket, const StyleLayer &layer_desc, const
             patternShader->u_patternmatrix_b = patternMatrixB;
 
             MBGL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0));
+            glCalls++;
             spriteAtlas.bind(true);
 
             // Draw the actual triangles into the color & stencil buffer.
             depthMask(true);
             depthRange(strata, 1.0f);
             bucket.drawElements(*patternShader);
+            glCalls++;
         }
     }
     else {
@@ -103,15 +106,21 @@ void Painter::renderFill(FillBucket& bucket, const StyleLayer &layer_desc, const
             // Only draw the fill when it's either opaque and we're drawing opaque
             // fragments or when it's translucent and we're drawing translucent
             // fragments
-            // Draw filling rectangle.
-            useProgram(plainShader->program);
-            plainShader->u_matrix = vtxMatrix;
-            plainShader->u_color = fill_color;
-
-            // Draw the actual triangles into the color & stencil buffer.
-            depthMask(true);
-            depthRange(strata + strata_epsilon, 1.0f);
-            bucket.drawElements(*plainShader);
+            if (pass == RenderPass::Opaque) {
+                // Drawn with the other opaque fills once all layers have been visited.
+                opaqueFills.push_back({ &bucket, vtxMatrix, fill_color, tileStencilRef, tileStencilMask, strata });
+            } else {
+                // Draw filling rectangle.
+                useProgram(plainShader->program);
+                plainShader->u_matrix = vtxMatrix;
+                plainShader->u_color = fill_color;
+
+                // Draw the actual triangles into the color & stencil buffer.
+                depthMask(true);
+                depthRange(strata + strata_epsilon, 1.0f);
+                bucket.drawElements(*plainShader);
+                glCalls++;
+            }
         }
     }
 
@@ -132,5 +141,6 @@ void Painter::renderFill(FillBucket& bucket, const StyleLayer &layer_desc, const
 
         depthRange(strata + strata_epsilon + strata_epsilon, 1.0f);
         bucket.drawVertices(*outlineShader);
+        glCalls++;
     }
 }
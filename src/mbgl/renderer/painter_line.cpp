@@ -70,8 +70,10 @@ void Painter::renderLine(LineBucket& bucket, const StyleLayer &layer_desc, const
         linejoinShader->u_size = pointSize;
 #else
         MBGL_CHECK_ERROR(glPointSize(pointSize));
+        glCalls++;
 #endif
         bucket.drawPoints(*linejoinShader);
+        glCalls++;
     }
 
     if (properties.dash_array.from.size()) {
@@ -104,6 +106,7 @@ void Painter::renderLine(LineBucket& bucket, const StyleLayer &layer_desc, const
         linesdfShader->u_mix = properties.dash_array.t;
 
         bucket.drawLineSDF(*linesdfShader);
+        glCalls++;
 
     } else if (properties.image.from.size()) {
         SpriteAtlasPosition imagePosA = spriteAtlas.getPosition(properties.image.from, true);
@@ -129,10 +132,12 @@ void Painter::renderLine(LineBucket& bucket, const StyleLayer &layer_desc, const
         linepatternShader->u_opacity = properties.opacity;
 
         MBGL_CHECK_ERROR(glActiveTexture(GL_TEXTURE0));
+        glCalls++;
         spriteAtlas.bind(true);
-        MBGL_CHECK_ERROR(glDepthRange(strata + strata_epsilon, 1.0f));  // may or may not matter
+        depthRange(strata + strata_epsilon, 1.0f);  // may or may not matter
 
         bucket.drawLinePatterns(*linepatternShader);
+        glCalls++;
 
     } else {
         useProgram(lineShader->program);
@@ -146,5 +151,6 @@ void Painter::renderLine(LineBucket& bucket, const StyleLayer &layer_desc, const
         lineShader->u_color = color;
 
         bucket.drawLines(*lineShader);
+        glCalls++;
     }
 }
@@ -26,6 +26,7 @@ void Painter::renderRaster(RasterBucket& bucket, const StyleLayer &layer_desc, c
         depthRange(strata + strata_epsilon, 1.0f);
 
         bucket.drawRaster(*rasterShader, tileStencilBuffer, coveringRasterArray);
+        glCalls++;
     }
 }
 
@@ -88,6 +88,7 @@ void Painter::renderSDF(SymbolBucket &bucket,
 
         depthRange(strata, 1.0f);
         (bucket.*drawSDF)(sdfShader);
+        glCalls++;
     }
 
     // Then, we draw the text/icon over the halo
@@ -109,6 +110,7 @@ void Painter::renderSDF(SymbolBucket &bucket,
 
         depthRange(strata + strata_epsilon, 1.0f);
         (bucket.*drawSDF)(sdfShader);
+        glCalls++;
     }
 }
 
@@ -121,7 +123,7 @@ void Painter::renderSymbol(SymbolBucket &bucket, const StyleLayer &layer_desc, c
     const auto &properties = layer_desc.getProperties<SymbolProperties>();
     const auto &layout = bucket.layout;
 
-    MBGL_CHECK_ERROR(glDisable(GL_STENCIL_TEST));
+    stencilTest(false);
     depthMask(false);
 
     if (bucket.hasIconData()) {
@@ -186,6 +188,7 @@ void Painter::renderSymbol(SymbolBucket &bucket, const StyleLayer &layer_desc, c
 
             depthRange(strata, 1.0f);
             bucket.drawIcons(*iconShader);
+            glCalls++;
         }
     }
 
@@ -202,6 +205,4 @@ void Painter::renderSymbol(SymbolBucket &bucket, const StyleLayer &layer_desc, c
                   *sdfGlyphShader,
                   &SymbolBucket::drawGlyphs);
     }
-
-    MBGL_CHECK_ERROR(glEnable(GL_STENCIL_TEST));
 }
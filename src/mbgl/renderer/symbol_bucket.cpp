@@ -1,6 +1,7 @@
 #include <mbgl/renderer/symbol_bucket.hpp>
 #include <mbgl/map/geometry_tile.hpp>
 #include <mbgl/style/style_layout.hpp>
+#include <mbgl/style/filter_program.hpp>
 #include <mbgl/geometry/text_buffer.hpp>
 #include <mbgl/geometry/icon_buffer.hpp>
 #include <mbgl/geometry/glyph_atlas.hpp>
@@ -37,97 +38,106 @@ void SymbolBucket::render(Painter &painter, const StyleLayer &layer_desc, const
 
 bool SymbolBucket::hasData() const { return hasTextData() || hasIconData(); }
 
+std::size_t SymbolBucket::clientBytes() const {
+    return text.vertices.clientBytes() + text.triangles.clientBytes() +
+           text.groups.size() * sizeof(TextElementGroup) + icon.vertices.clientBytes() +
+           icon.triangles.clientBytes() + icon.groups.size() * sizeof(IconElementGroup);
+}
+
+std::size_t SymbolBucket::serverBytes() const {
+    return text.vertices.serverBytes() + text.triangles.serverBytes() +
+           icon.vertices.serverBytes() + icon.triangles.serverBytes();
+}
+
 bool SymbolBucket::hasTextData() const { return !text.groups.empty(); }
 
 bool SymbolBucket::hasIconData() const { return !icon.groups.empty(); }
 
-std::vector<SymbolFeature> SymbolBucket::processFeatures(const GeometryTileLayer& layer,
-                                                         const FilterExpression& filter,
-                                                         GlyphStore &glyphStore,
-                                                         const Sprite &sprite) {
+std::size_t SymbolBucket::vertexCount() const {
+    return text.vertices.index() + icon.vertices.index();
+}
+
+bool SymbolBucket::addFeature(const GeometryTileFeature& feature) {
     const bool has_text = !layout.text.field.empty() && !layout.text.font.empty();
     const bool has_icon = !layout.icon.image.empty();
 
-    std::vector<SymbolFeature> features;
-
     if (!has_text && !has_icon) {
-        return features;
+        return false;
     }
 
-    // Determine and load glyph ranges
-    std::set<GlyphRange> ranges;
-
-    for (std::size_t i = 0; i < layer.featureCount(); i++) {
-        auto feature = layer.getFeature(i);
+    SymbolFeature ft;
 
-        GeometryTileFeatureExtractor extractor(*feature);
-        if (!evaluate(filter, extractor))
-            continue;
+    auto getValue = [&feature](const std::string& key) -> std::string {
+        auto value = feature.getValue(key);
+        return value ? toString(*value) : std::string();
+    };
 
-        SymbolFeature ft;
+    if (has_text) {
+        std::string u8string = util::replaceTokens(layout.text.field, getValue);
 
-        auto getValue = [&feature](const std::string& key) -> std::string {
-            auto value = feature->getValue(key);
-            return value ? toString(*value) : std::string();
-        };
+        if (layout.text.transform == TextTransformType::Uppercase) {
+            u8string = platform::uppercase(u8string);
+        } else if (layout.text.transform == TextTransformType::Lowercase) {
+            u8string = platform::lowercase(u8string);
+        }
 
-        if (has_text) {
-            std::string u8string = util::replaceTokens(layout.text.field, getValue);
+        ft.label = util::utf8_to_utf32::convert(u8string);
 
-            if (layout.text.transform == TextTransformType::Uppercase) {
-                u8string = platform::uppercase(u8string);
-            } else if (layout.text.transform == TextTransformType::Lowercase) {
-                u8string = platform::lowercase(u8string);
+        if (ft.label.size()) {
+            // Loop through all characters of this text and collect unique codepoints.
+            for (char32_t chr : ft.label) {
+                ranges.insert(getGlyphRange(chr));
             }
+        }
+    }
 
-            ft.label = util::utf8_to_utf32::convert(u8string);
+    if (has_icon) {
+        ft.sprite = util::replaceTokens(layout.icon.image, getValue);
+    }
 
-            if (ft.label.size()) {
-                // Loop through all characters of this text and collect unique codepoints.
-                for (char32_t chr : ft.label) {
-                    ranges.insert(getGlyphRange(chr));
-                }
-            }
-        }
+    if (!ft.label.length() && !ft.sprite.length()) {
+        return false;
+    }
 
-        if (has_icon) {
-            ft.sprite = util::replaceTokens(layout.icon.image, getValue);
-        }
+    features.push_back(std::move(ft));
+    return true;
+}
 
-        if (ft.label.length() || ft.sprite.length()) {
+void SymbolBucket::addGeometry(const GeometryBuffer& geometry) {
+    assert(!features.empty());
+    auto &multiline = features.back().geometry;
 
-            auto &multiline = ft.geometry;
+    multiline.reserve(geometry.lineCount());
+    for (std::size_t i = 0; i < geometry.lineCount(); i++) {
+        const auto line = geometry.line(i);
+        multiline.emplace_back(line.begin(), line.end());
+    }
+}
 
-            GeometryCollection geometryCollection = feature->getGeometries();
-            for (auto& line : geometryCollection) {
-                multiline.emplace_back();
-                for (auto& point : line) {
-                    multiline.back().emplace_back(point.x, point.y);
-                }
-            }
+bool SymbolBucket::dependenciesLoaded(GlyphStore& glyphStore, const Sprite& sprite) const {
+    return features.empty() ||
+           (sprite.isLoaded() && glyphStore.hasGlyphRanges(layout.text.font, ranges));
+}
 
-            features.push_back(std::move(ft));
-        }
+void SymbolBucket::requestDependencies(GlyphStore& glyphStore) const {
+    glyphStore.requestGlyphRanges(layout.text.font, ranges);
+}
+
+void SymbolBucket::placeFeatures(uintptr_t tileUID,
+                                 SpriteAtlas& spriteAtlas,
+                                 Sprite& sprite,
+                                 GlyphAtlas& glyphAtlas,
+                                 GlyphStore& glyphStore) {
+    if (features.empty()) {
+        return;
     }
 
     if (layout.placement == PlacementType::Line) {
         util::mergeLines(features);
     }
 
-    glyphStore.waitForGlyphRanges(layout.text.font, ranges);
-    sprite.waitUntilLoaded();
-
-    return features;
-}
-
-void SymbolBucket::addFeatures(const GeometryTileLayer& layer,
-                               const FilterExpression& filter,
-                               uintptr_t tileUID,
-                               SpriteAtlas& spriteAtlas,
-                               Sprite& sprite,
-                               GlyphAtlas& glyphAtlas,
-                               GlyphStore& glyphStore) {
-    const std::vector<SymbolFeature> features = processFeatures(layer, filter, glyphStore, sprite);
+    assert(dependenciesLoaded(glyphStore, sprite));
+    glyphStore.parseGlyphRanges(layout.text.font, ranges);
 
     float horizontalAlign = 0.5;
     float verticalAlign = 0.5;
@@ -170,7 +180,7 @@ void SymbolBucket::addFeatures(const GeometryTileLayer& layer,
     if (layout.text.justify == TextJustifyType::Right) justify = 1;
     else if (layout.text.justify == TextJustifyType::Left) justify = 0;
 
-    const auto &fontStack = glyphStore.getFontStack(layout.text.font);
+    const FontStack &fontStack = glyphStore.getFontStack(layout.text.font);
 
     for (const auto& feature : features) {
         if (!feature.geometry.size()) continue;
@@ -181,7 +191,7 @@ void SymbolBucket::addFeatures(const GeometryTileLayer& layer,
 
         // if feature has text, shape the text
         if (feature.label.length()) {
-            shaping = fontStack->getShaping(
+            shaping = fontStack.getShaping(
                 /* string */ feature.label,
                 /* maxWidth: ems */ layout.text.max_width * 24,
                 /* lineHeight: ems */ layout.text.line_height * 24,
@@ -193,13 +203,12 @@ void SymbolBucket::addFeatures(const GeometryTileLayer& layer,
 
             // Add the glyphs we need for this label to the glyph atlas.
             if (shaping.size()) {
-                glyphAtlas.addGlyphs(tileUID, feature.label, layout.text.font, fontStack, face);
+                glyphAtlas.addGlyphs(tileUID, feature.label, fontStack, face);
             }
         }
 
         // if feature has icon, get sprite atlas position
         if (feature.sprite.length()) {
-            sprite.waitUntilLoaded();
             image = spriteAtlas.getImage(feature.sprite, false);
 
             if (sprite.getSpritePosition(feature.sprite).sdf) {
@@ -216,6 +225,10 @@ void SymbolBucket::addFeatures(const GeometryTileLayer& layer,
             }
         }
     }
+
+    // The features are only needed during placement.
+    features = std::vector<SymbolFeature>();
+    ranges.clear();
 }
 
 bool byScale(const Anchor &a, const Anchor &b) { return a.scale < b.scale; }
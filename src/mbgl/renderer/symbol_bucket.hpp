@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <map>
+#include <set>
 #include <vector>
 
 namespace mbgl {
@@ -28,6 +29,9 @@ class GlyphStore;
 
 class SymbolFeature {
 public:
+    // A copy of the decoded geometry, since the decoding buffer is reused for the next feature
+    // while symbols are only placed once all features have been added. This is the one
+    // allocation per feature that adding symbols makes.
     std::vector<std::vector<Coordinate>> geometry;
     std::u32string label;
     std::string sprite;
@@ -58,27 +62,40 @@ public:
     void render(Painter &painter, const StyleLayer &layer_desc, const TileID &id,
                 const mat4 &matrix) override;
     bool hasData() const override;
+    std::size_t clientBytes() const override;
+    std::size_t serverBytes() const override;
     bool hasTextData() const;
     bool hasIconData() const;
 
-    void addFeatures(const GeometryTileLayer&,
-                     const FilterExpression&,
-                     uintptr_t tileUID,
-                     SpriteAtlas&,
-                     Sprite&,
-                     GlyphAtlas&,
-                     GlyphStore&);
+    // The number of text and icon vertices of the placed features.
+    std::size_t vertexCount() const;
+
+    // Adds the label and icon of a feature that passed the bucket's filter. Returns false
+    // if the feature has neither, in which case its geometry isn't needed.
+    bool addFeature(const GeometryTileFeature&);
+
+    // Sets the geometry of the feature that was last added with addFeature().
+    void addGeometry(const GeometryBuffer&);
+
+    // Returns whether the glyphs and the sprite needed by the added features are loaded.
+    bool dependenciesLoaded(GlyphStore&, const Sprite&) const;
+
+    // Requests the glyphs needed by the added features that haven't been requested yet.
+    // Must be called on the map thread.
+    void requestDependencies(GlyphStore&) const;
+
+    // Shapes and places all added features. The dependencies of the bucket must be loaded.
+    void placeFeatures(uintptr_t tileUID,
+                       SpriteAtlas&,
+                       Sprite&,
+                       GlyphAtlas&,
+                       GlyphStore&);
 
     void drawGlyphs(SDFShader& shader);
     void drawIcons(SDFShader& shader);
     void drawIcons(IconShader& shader);
 
 private:
-    std::vector<SymbolFeature> processFeatures(const GeometryTileLayer&,
-                                               const FilterExpression&,
-                                               GlyphStore&,
-                                               const Sprite&);
-
     void addFeature(const std::vector<Coordinate> &line, const Shaping &shaping, const GlyphPositions &face, const Rect<uint16_t> &image);
 
     // Adds placed items to the buffer.
@@ -92,6 +109,10 @@ public:
 private:
     Collision &collision;
 
+    // Features added during parsing, and the glyph ranges their labels need.
+    std::vector<SymbolFeature> features;
+    std::set<GlyphRange> ranges;
+
     struct TextBuffer {
         TextVertexBuffer vertices;
         TriangleElementsBuffer triangles;
@@ -2,6 +2,7 @@
 #include <mbgl/storage/request.hpp>
 #include <mbgl/storage/asset_request.hpp>
 #include <mbgl/storage/http_request.hpp>
+#include <mbgl/storage/mbtiles_request.hpp>
 
 #include <mbgl/storage/response.hpp>
 #include <mbgl/platform/platform.hpp>
@@ -28,6 +29,20 @@ namespace algo = boost::algorithm;
 
 namespace mbgl {
 
+namespace {
+
+// MBTiles files are local and read-only, so storing their tiles in the cache would only copy them.
+bool isCacheable(const Resource& resource) {
+    return !algo::starts_with(resource.url, "mbtiles://");
+}
+
+bool isNetwork(const Resource& resource) {
+    return !algo::starts_with(resource.url, "asset://") &&
+           !algo::starts_with(resource.url, "mbtiles://");
+}
+
+}
+
 DefaultFileSource::Impl::Impl(FileCache* cache_, const std::string& root)
     : assetRoot(root.empty() ? platform::assetRoot() : root), cache(cache_) {
 }
@@ -81,6 +96,23 @@ void DefaultFileSource::abort(const Environment &env) {
     thread->invoke(&Impl::abort, std::ref(env));
 }
 
+void DefaultFileSource::setHTTPOptions(const HTTPOptions& options) {
+    thread->invoke(&Impl::setHTTPOptions, options);
+}
+
+void DefaultFileSource::Impl::setHTTPOptions(const HTTPOptions& options) {
+    httpOptions = options;
+}
+
+void DefaultFileSource::setMaximumConcurrentRequests(std::size_t count) {
+    thread->invoke(&Impl::setMaximumConcurrentRequests, count);
+}
+
+void DefaultFileSource::Impl::setMaximumConcurrentRequests(std::size_t count) {
+    maximumConcurrentRequests = count;
+    startQueued();
+}
+
 void DefaultFileSource::Impl::add(Request* req, uv_loop_t* loop) {
     const Resource &resource = req->resource;
 
@@ -90,6 +122,8 @@ void DefaultFileSource::Impl::add(Request* req, uv_loop_t* loop) {
         // There is no request for this URL yet. Create a new one and start it.
         if (algo::starts_with(resource.url, "asset://")) {
             sharedRequest = new AssetRequest(this, resource);
+        } else if (algo::starts_with(resource.url, "mbtiles://")) {
+            sharedRequest = new MBTilesRequest(this, resource);
         } else {
             sharedRequest = new HTTPRequest(this, resource);
         }
@@ -99,8 +133,8 @@ void DefaultFileSource::Impl::add(Request* req, uv_loop_t* loop) {
         (void (inserted)); // silence unused variable warning on Release builds.
 
         // But first, we're going to start querying the database if it exists.
-        if (!cache) {
-            sharedRequest->start(loop);
+        if (!cache || !isCacheable(resource)) {
+            schedule(sharedRequest, loop, nullptr);
         } else {
             // Otherwise, first check the cache for existing data so that we can potentially
             // revalidate the information without having to redownload everything.
@@ -110,6 +144,7 @@ void DefaultFileSource::Impl::add(Request* req, uv_loop_t* loop) {
         }
     }
     sharedRequest->subscribe(req);
+    reprioritize(sharedRequest);
 }
 
 void DefaultFileSource::Impl::cancel(Request* req) {
@@ -119,6 +154,9 @@ void DefaultFileSource::Impl::cancel(Request* req) {
         // unsubscribe callback triggers the removal of the SharedRequestBase pointer from the list
         // of pending requests and initiates cancelation.
         sharedRequest->unsubscribe(req);
+        if (find(req->resource) == sharedRequest) {
+            reprioritize(sharedRequest);
+        }
     } else {
         // There is no request for this URL anymore. Likely, the request already completed
         // before we got around to process the cancelation request.
@@ -142,12 +180,14 @@ void DefaultFileSource::Impl::processResult(const Resource& resource, std::share
                 sharedRequest->cancel();
                 return;
             } else {
-                // The cached response is stale. Now run the real request.
-                sharedRequest->start(loop, response);
+                // The cached response is stale. Requests that accept it get it right away, and
+                // the real request revalidates it.
+                sharedRequest->notifyStale(response);
+                schedule(sharedRequest, loop, response);
             }
         } else {
             // There is no response. Now run the real request.
-            sharedRequest->start(loop);
+            schedule(sharedRequest, loop, nullptr);
         }
     } else {
         // There is no request for this URL anymore. Likely, the request was canceled
@@ -175,9 +215,11 @@ void DefaultFileSource::Impl::abort(const Environment& env) {
 
         // Finally, remove all requests that are now abandoned.
         if (it.second->abandoned()) {
+            finished(it.second);
             it.second->cancel();
             return true;
         } else {
+            reprioritize(it.second);
             return false;
         }
     });
@@ -189,18 +231,82 @@ void DefaultFileSource::Impl::notify(SharedRequestBase *sharedRequest,
     // First, remove the request, since it might be destructed at any point now.
     assert(find(sharedRequest->resource) == sharedRequest);
     pending.erase(sharedRequest->resource);
+    finished(sharedRequest);
 
     if (response) {
-        if (cache) {
+        if (cache && isCacheable(sharedRequest->resource)) {
             // Store response in database
             cache->put(sharedRequest->resource, response, hint);
         }
 
+        // Requests that were answered with the stale response only hear back if the resource
+        // changed. Failing to revalidate leaves them with the stale response.
+        const auto& stale = sharedRequest->getStaleResponse();
+        const bool modified = !stale || (hint != FileCache::Hint::Refresh &&
+                                         response->status == Response::Successful &&
+                                         (!stale->data || *response->data != *stale->data));
+
         // Notify all observers.
         for (auto req : observers) {
-            req->notify(response);
+            if (modified || !sharedRequest->servedStale(req)) {
+                req->notify(response);
+            } else {
+                req->finish();
+            }
         }
     }
 }
 
+void DefaultFileSource::Impl::schedule(SharedRequestBase* sharedRequest, uv_loop_t* loop,
+                                       std::shared_ptr<const Response> response) {
+    if (!isNetwork(sharedRequest->resource)) {
+        sharedRequest->start(loop, response);
+    } else if (!maximumConcurrentRequests || active.size() < maximumConcurrentRequests) {
+        active.insert(sharedRequest);
+        sharedRequest->start(loop, response);
+    } else {
+        const QueueKey key { sharedRequest->priority(), arrivals++ };
+        queue.emplace(key, Queued { sharedRequest, loop, std::move(response) });
+        queued.emplace(sharedRequest, key);
+    }
+}
+
+void DefaultFileSource::Impl::reprioritize(SharedRequestBase* sharedRequest) {
+    const auto it = queued.find(sharedRequest);
+    if (it == queued.end()) {
+        return;
+    }
+
+    const Resource::Priority priority = sharedRequest->priority();
+    if (priority != it->second.first) {
+        const QueueKey key { priority, it->second.second };
+        auto entry = queue.find(it->second);
+        queue.emplace(key, std::move(entry->second));
+        queue.erase(entry);
+        it->second = key;
+    }
+}
+
+void DefaultFileSource::Impl::finished(SharedRequestBase* sharedRequest) {
+    const auto it = queued.find(sharedRequest);
+    if (it != queued.end()) {
+        // The request was canceled before it started.
+        queue.erase(it->second);
+        queued.erase(it);
+    } else if (active.erase(sharedRequest)) {
+        startQueued();
+    }
+}
+
+void DefaultFileSource::Impl::startQueued() {
+    while (!queue.empty() &&
+           (!maximumConcurrentRequests || active.size() < maximumConcurrentRequests)) {
+        Queued next = std::move(queue.begin()->second);
+        queue.erase(queue.begin());
+        queued.erase(next.request);
+        active.insert(next.request);
+        next.request->start(next.loop, std::move(next.response));
+    }
+}
+
 }
@@ -3,8 +3,10 @@
 
 #include <mbgl/storage/default_file_source.hpp>
 
+#include <map>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace mbgl {
 
@@ -21,14 +23,43 @@ public:
     void add(Request* request, uv_loop_t* loop);
     void cancel(Request* request);
     void abort(const Environment& env);
+    void setHTTPOptions(const HTTPOptions&);
+    void setMaximumConcurrentRequests(std::size_t);
 
     const std::string assetRoot;
+    HTTPOptions httpOptions;
 
 private:
     void processResult(const Resource& resource, std::shared_ptr<const Response> response, uv_loop_t* loop);
 
+    // Starts a request, or queues it if it goes to the network and the maximum number of network
+    // requests is running.
+    void schedule(SharedRequestBase*, uv_loop_t*, std::shared_ptr<const Response>);
+    // Moves a queued request to the priority of its current observers.
+    void reprioritize(SharedRequestBase*);
+    // Removes a request that completed or was canceled, and starts queued ones in its place.
+    void finished(SharedRequestBase*);
+    void startQueued();
+
     std::unordered_map<Resource, SharedRequestBase *, Resource::Hash> pending;
     FileCache *cache = nullptr;
+
+    // A network request that waits for a free slot, with the arguments to start it with.
+    struct Queued {
+        SharedRequestBase* request;
+        uv_loop_t* loop;
+        std::shared_ptr<const Response> response;
+    };
+
+    // Queued requests by priority, then arrival. Requests keep their place among requests of the
+    // same priority when they are reprioritized.
+    using QueueKey = std::pair<Resource::Priority, uint64_t>;
+    std::map<QueueKey, Queued> queue;
+    std::unordered_map<SharedRequestBase*, QueueKey> queued;
+    uint64_t arrivals = 0;
+
+    std::unordered_set<SharedRequestBase*> active;
+    std::size_t maximumConcurrentRequests = 20;
 };
 
 }
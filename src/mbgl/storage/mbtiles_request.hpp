@@ -0,0 +1,27 @@
+#ifndef MBGL_STORAGE_DEFAULT_MBTILES_REQUEST
+#define MBGL_STORAGE_DEFAULT_MBTILES_REQUEST
+
+#include "shared_request_base.hpp"
+
+namespace mbgl {
+
+// Loads tiles and TileJSON from MBTiles files. mbtiles://path/to/file.mbtiles loads the TileJSON,
+// which points to tile URLs of the form mbtiles://path/to/file.mbtiles/{z}/{x}/{y}. Relative paths
+// are relative to the asset root.
+class MBTilesRequest : public SharedRequestBase {
+public:
+    MBTilesRequest(DefaultFileSource::Impl *source, const Resource &resource);
+
+    void start(uv_loop_t *loop, std::shared_ptr<const Response> response = nullptr);
+    void cancel();
+
+private:
+    ~MBTilesRequest();
+    void *ptr = nullptr;
+
+    friend class MBTilesRequestImpl;
+};
+
+}
+
+#endif
@@ -0,0 +1,459 @@
+#include <mbgl/storage/offline_download.hpp>
+#include <mbgl/storage/file_source.hpp>
+#include <mbgl/storage/file_cache.hpp>
+#include <mbgl/storage/request.hpp>
+#include <mbgl/storage/response.hpp>
+
+#include <mbgl/map/environment.hpp>
+#include <mbgl/map/source.hpp>
+#include <mbgl/platform/log.hpp>
+#include <mbgl/style/style_bucket.hpp>
+#include <mbgl/style/style_layer.hpp>
+#include <mbgl/style/style_layout.hpp>
+#include <mbgl/style/style_parser.hpp>
+#include <mbgl/util/constants.hpp>
+#include <mbgl/util/mapbox.hpp>
+#include <mbgl/util/math.hpp>
+#include <mbgl/util/string.hpp>
+#include <mbgl/util/thread.hpp>
+#include <mbgl/util/tile_cover.hpp>
+#include <mbgl/util/token.hpp>
+#include <mbgl/util/url.hpp>
+#include <mbgl/util/uv_detail.hpp>
+
+#include <rapidjson/document.h>
+
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace mbgl {
+
+namespace {
+
+// Projects a coordinate to fractional tile coordinates at zoom level z.
+vec2<double> project(const LatLng& latLng, int32_t z) {
+    const double tiles = std::pow(2.0, z);
+    const double latitude = util::clamp(latLng.latitude, -util::LATITUDE_MAX, util::LATITUDE_MAX);
+    const double x = (latLng.longitude + 180) / 360;
+    const double y = 0.5 - std::log(std::tan(M_PI / 4 + latitude * util::DEG2RAD / 2)) / util::M2PI;
+
+    vec2<double> result;
+    result.x = util::clamp(x, 0.0, 1.0) * tiles;
+    result.y = util::clamp(y, 0.0, 1.0) * tiles;
+    return result;
+}
+
+std::forward_list<TileID> coverRegion(const LatLngBounds& bounds, int32_t z) {
+    const vec2<double> nw = project({ bounds.ne.latitude, bounds.sw.longitude }, z);
+    const vec2<double> se = project({ bounds.sw.latitude, bounds.ne.longitude }, z);
+    if (nw.x >= se.x || nw.y >= se.y) {
+        return {};
+    }
+
+    box b;
+    b.tl = nw;
+    b.br = se;
+    b.tr.x = se.x;
+    b.tr.y = nw.y;
+    b.bl.x = nw.x;
+    b.bl.y = se.y;
+    b.center.x = (nw.x + se.x) / 2;
+    b.center.y = (nw.y + se.y) / 2;
+    return tileCover(z, b);
+}
+
+// Evaluates a layout property at a zoom level, the way tiles of that zoom level are parsed.
+template <typename T>
+struct LayoutEvaluator {
+    typedef T result_type;
+    LayoutEvaluator(float z_) : z(z_) {}
+
+    T operator()(const Function<T>& value) const {
+        return mapbox::util::apply_visitor(FunctionEvaluator<T>(z), value);
+    }
+
+    template <typename P>
+    T operator()(const P&) const {
+        return T();
+    }
+
+private:
+    const float z;
+};
+
+std::vector<std::pair<uint16_t, uint16_t>> allGlyphRanges() {
+    std::vector<std::pair<uint16_t, uint16_t>> ranges;
+    for (uint32_t start = 0; start < 65536; start += 256) {
+        ranges.emplace_back(start, start + 255);
+    }
+    return ranges;
+}
+
+int64_t now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        SystemClock::now().time_since_epoch()).count();
+}
+
+}
+
+double OfflineProgress::bytesPerSecond() const {
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? downloadedBytes / seconds : 0;
+}
+
+double OfflineProgress::tilesPerSecond() const {
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0 ? downloadedTiles / seconds : 0;
+}
+
+class OfflineDownload::Impl {
+public:
+    Impl(const OfflineRegion&, FileSource&, FileCache*, const std::string& progressPath, Observer);
+
+    void start(uv_loop_t* loop);
+    void cancel();
+
+private:
+    using Loaded = std::function<void(const Response&)>;
+
+    struct Item {
+        Resource resource;
+        // Invoked with the contents of the style and TileJSONs, which are needed to find the
+        // remaining resources.
+        Loaded loaded;
+    };
+
+    void loadStyle(const Response&);
+    void loadSource(Source&, const Response&);
+    void addTiles(const SourceInfo&);
+    void addGlyphs(const Source&, int32_t z);
+
+    void add(const Resource&, Loaded = nullptr);
+    void next();
+    void fetch(const Item&);
+    void download(const Item&);
+    void finish(const Item&, const Response&);
+
+    const OfflineRegion region;
+    FileSource& fileSource;
+    FileCache* const cache;
+    const Observer observer;
+    Environment env;
+    uv_loop_t* loop = nullptr;
+
+    std::string glyphURL;
+    std::vector<std::pair<uint16_t, uint16_t>> glyphRanges;
+    std::vector<util::ptr<Source>> sources;
+    std::vector<util::ptr<StyleLayer>> layers;
+
+    // URLs that were loaded by an earlier download of the region, and the file they are stored in.
+    std::unordered_set<std::string> loaded;
+    std::ofstream progressFile;
+
+    std::unordered_set<std::string> added;
+    std::deque<Item> queue;
+    std::unordered_map<std::string, Request*> requests;
+    std::size_t active = 0;
+
+    // Keeps the loop alive while cache lookups are pending, since their results are delivered to it.
+    std::unique_ptr<uv::async> lookupHandle;
+    std::size_t lookups = 0;
+    bool canceled = false;
+
+    TimePoint started;
+    OfflineProgress progress;
+};
+
+OfflineDownload::Impl::Impl(const OfflineRegion& region_, FileSource& fileSource_,
+                            FileCache* cache_, const std::string& progressPath, Observer observer_)
+    : region(region_),
+      fileSource(fileSource_),
+      cache(cache_),
+      observer(observer_),
+      env(fileSource),
+      glyphRanges(region.glyphRanges.empty() ? allGlyphRanges() : region.glyphRanges) {
+    if (!progressPath.empty()) {
+        std::ifstream file(progressPath);
+        std::string url;
+        while (std::getline(file, url)) {
+            loaded.insert(url);
+        }
+        progressFile.open(progressPath, std::ios::app);
+    }
+}
+
+void OfflineDownload::Impl::start(uv_loop_t* loop_) {
+    loop = loop_;
+    lookupHandle = util::make_unique<uv::async>(loop, [] {});
+    lookupHandle->unref();
+    started = Clock::now();
+
+    add({ Resource::JSON, util::mapbox::normalizeStyleURL(region.styleURL, region.accessToken) },
+        [this](const Response& res) { loadStyle(res); });
+}
+
+void OfflineDownload::Impl::cancel() {
+    canceled = true;
+    queue.clear();
+    for (const auto& request : requests) {
+        fileSource.cancel(request.second);
+    }
+    requests.clear();
+
+    if (lookups == 0) {
+        lookupHandle.reset();
+    }
+}
+
+void OfflineDownload::Impl::loadStyle(const Response& res) {
+    rapidjson::Document doc;
+    doc.Parse<0>(res.data->c_str());
+    if (doc.HasParseError()) {
+        Log::Error(Event::ParseStyle, "Error parsing offline style: %s", doc.GetParseError());
+        progress.failedResources++;
+        return;
+    }
+
+    StyleParser parser;
+    parser.parse(doc);
+    sources = parser.getSources();
+    layers = parser.getLayers();
+    glyphURL = util::mapbox::normalizeGlyphsURL(parser.getGlyphURL(), region.accessToken);
+
+    const std::string sprite = parser.getSprite();
+    if (!sprite.empty()) {
+        const std::string base = sprite + (region.pixelRatio > 1 ? "@2x" : "");
+        add({ Resource::JSON, base + ".json" });
+        add({ Resource::Image, base + ".png" });
+    }
+
+    for (const auto& source : sources) {
+        if (source->info.type != SourceType::Vector && source->info.type != SourceType::Raster) {
+            continue;
+        }
+
+        if (source->info.url.empty()) {
+            addTiles(source->info);
+            continue;
+        }
+
+        const std::string url = util::mapbox::normalizeSourceURL(source->info.url, region.accessToken);
+        Source* ptr = source.get();
+        add({ Resource::JSON, url }, [this, ptr](const Response& json) { loadSource(*ptr, json); });
+    }
+}
+
+void OfflineDownload::Impl::loadSource(Source& source, const Response& res) {
+    rapidjson::Document doc;
+    doc.Parse<0>(res.data->c_str());
+    if (doc.HasParseError()) {
+        Log::Warning(Event::General, "Invalid source TileJSON; Parse Error at %d: %s",
+                     doc.GetErrorOffset(), doc.GetParseError());
+        progress.failedResources++;
+        return;
+    }
+
+    source.info.parseTileJSONProperties(doc);
+    addTiles(source.info);
+}
+
+void OfflineDownload::Impl::addTiles(const SourceInfo& info) {
+    if (info.tiles.empty()) {
+        return;
+    }
+
+    // The source's bounds are stored as west, south, east, north.
+    LatLngBounds bounds = region.bounds;
+    bounds.sw.longitude = std::fmax(bounds.sw.longitude, info.bounds[0]);
+    bounds.sw.latitude = std::fmax(bounds.sw.latitude, info.bounds[1]);
+    bounds.ne.longitude = std::fmin(bounds.ne.longitude, info.bounds[2]);
+    bounds.ne.latitude = std::fmin(bounds.ne.latitude, info.bounds[3]);
+
+    // Sources with smaller tiles use higher zoom levels for the same map zoom level, see
+    // Source::getZoom().
+    const double offset = std::log(util::tileSize / info.tile_size) / std::log(2);
+    const int32_t minZoom = std::fmax(std::floor(region.minZoom + offset), info.min_zoom);
+    const int32_t maxZoom = std::fmin(std::floor(region.maxZoom + offset), info.max_zoom);
+
+    for (int32_t z = minZoom; z <= maxZoom; z++) {
+        for (const auto& id : coverRegion(bounds, z)) {
+            add({ Resource::Tile, info.tileURL(id, region.pixelRatio) });
+        }
+    }
+
+    if (info.type == SourceType::Vector) {
+        for (const auto& source : sources) {
+            if (&source->info == &info) {
+                for (int32_t z = minZoom; z <= maxZoom; z++) {
+                    addGlyphs(*source, z);
+                }
+            }
+        }
+    }
+}
+
+void OfflineDownload::Impl::addGlyphs(const Source& source, int32_t z) {
+    if (glyphURL.empty()) {
+        return;
+    }
+
+    for (const auto& layer : layers) {
+        if (layer->type != StyleLayerType::Symbol || !layer->bucket ||
+            layer->bucket->source.get() != &source) {
+            continue;
+        }
+
+        // Same as TileParser::createBucket().
+        const StyleBucket& bucket = *layer->bucket;
+        if (z < std::floor(bucket.min_zoom) && std::floor(bucket.min_zoom) < source.info.max_zoom) continue;
+        if (z >= std::ceil(bucket.max_zoom)) continue;
+        if (bucket.visibility == VisibilityType::None) continue;
+
+        const auto& properties = bucket.layout.properties;
+        if (properties.find(PropertyKey::TextField) == properties.end()) {
+            continue;
+        }
+
+        std::string fontStack = StyleLayoutSymbol().text.font;
+        auto it = properties.find(PropertyKey::TextFont);
+        if (it != properties.end()) {
+            fontStack = mapbox::util::apply_visitor(LayoutEvaluator<std::string>(z), it->second);
+        }
+
+        for (const auto& range : glyphRanges) {
+            add({ Resource::Glyphs, util::replaceTokens(glyphURL, [&](const std::string &name) -> std::string {
+                if (name == "fontstack") return util::percentEncode(fontStack);
+                if (name == "range") return util::toString(range.first) + "-" + util::toString(range.second);
+                return "";
+            }) });
+        }
+    }
+}
+
+void OfflineDownload::Impl::add(const Resource& resource, Loaded loaded_) {
+    if (!added.insert(resource.url).second) {
+        return;
+    }
+
+    progress.requiredResources++;
+
+    // The style and TileJSONs are always loaded, since the rest of the region depends on them.
+    if (!loaded_ && loaded.count(resource.url)) {
+        progress.completedResources++;
+        progress.cachedResources++;
+        if (resource.kind == Resource::Tile) {
+            progress.completedTiles++;
+        }
+        return;
+    }
+
+    queue.push_back({ resource, loaded_ });
+    next();
+}
+
+void OfflineDownload::Impl::next() {
+    while (!canceled && active < region.maximumConcurrentRequests && !queue.empty()) {
+        const Item item = queue.front();
+        queue.pop_front();
+        fetch(item);
+    }
+}
+
+void OfflineDownload::Impl::fetch(const Item& item) {
+    active++;
+
+    if (!cache) {
+        download(item);
+        return;
+    }
+
+    if (lookups++ == 0) {
+        lookupHandle->ref();
+    }
+
+    cache->get(item.resource, [this, item](std::unique_ptr<Response> res) {
+        if (--lookups == 0) {
+            if (canceled) {
+                lookupHandle.reset();
+                return;
+            }
+            lookupHandle->unref();
+        }
+
+        if (canceled) {
+            return;
+        }
+
+        if (res && res->status == Response::Successful && res->expires > now()) {
+            progress.cachedResources++;
+            finish(item, *res);
+        } else {
+            download(item);
+        }
+    });
+}
+
+void OfflineDownload::Impl::download(const Item& item) {
+    // Maps that share the file source load what they show first.
+    const Resource resource { item.resource.kind, item.resource.url, Resource::Prefetch };
+    Request* request = fileSource.request(resource, loop, env, [this, item](const Response& res) {
+        requests.erase(item.resource.url);
+        if (res.status == Response::Successful) {
+            progress.downloadedBytes += res.data->size();
+            if (item.resource.kind == Resource::Tile) {
+                progress.downloadedTiles++;
+            }
+        }
+        finish(item, res);
+    });
+    requests.emplace(item.resource.url, request);
+}
+
+void OfflineDownload::Impl::finish(const Item& item, const Response& res) {
+    active--;
+    progress.completedResources++;
+
+    if (res.status == Response::Successful) {
+        if (item.resource.kind == Resource::Tile) {
+            progress.completedTiles++;
+        }
+        if (progressFile.is_open()) {
+            progressFile << item.resource.url << std::endl;
+        }
+        if (item.loaded) {
+            item.loaded(res);
+        }
+    } else {
+        Log::Warning(Event::General, "Failed to load %s for offline use: %s",
+                     item.resource.url.c_str(), res.message.c_str());
+        progress.failedResources++;
+    }
+
+    next();
+
+    progress.elapsed = Clock::now() - started;
+    progress.complete = active == 0 && queue.empty();
+    if (observer) {
+        observer(progress);
+    }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+OfflineDownload::OfflineDownload(const OfflineRegion& region, FileSource& fileSource,
+                                 FileCache* cache, const std::string& progressPath,
+                                 Observer observer)
+    : thread(util::make_unique<util::Thread<Impl>>("OfflineDownload", region, fileSource, cache,
+                                                   progressPath, observer)) {
+    thread->invoke(&Impl::start, thread->get());
+}
+
+OfflineDownload::~OfflineDownload() {
+    // Requests have to be canceled while the thread's loop still runs.
+    thread->invoke(&Impl::cancel);
+}
+
+}
@@ -50,13 +50,29 @@ void Request::notifyCallback() {
 }
 
 void Request::invoke() {
-    assert(response);
-    // The user could supply a null pointer or empty std::function as a callback. In this case, we
-    // still do the file request, but we don't need to deliver a result.
-    if (callback) {
-        callback(*response);
+    std::vector<std::shared_ptr<const Response>> delivered;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(delivered, responses);
+    }
+
+    for (const auto& response : delivered) {
+        // The user could supply a null pointer or empty std::function as a callback. In this
+        // case, we still do the file request, but we don't need to deliver a result.
+        if (response && callback) {
+            callback(*response);
+        }
+
+        if (!response || !response->stale) {
+            delete this;
+            return;
+        }
+
+        // The callback may have canceled the request after a stale response.
+        if (canceled) {
+            return;
+        }
     }
-    delete this;
 }
 
 Request::~Request() {
@@ -68,11 +84,14 @@ Request::~Request() {
 }
 
 // Called in the FileSource thread.
-void Request::notify(const std::shared_ptr<const Response> &response_) {
-    assert(!response);
-    response = response_;
+void Request::notify(const std::shared_ptr<const Response> &response) {
     assert(response);
 
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        responses.push_back(response);
+    }
+
     if (async) {
         uv_async_send(async);
     } else {
@@ -82,6 +101,21 @@ void Request::notify(const std::shared_ptr<const Response> &response_) {
     }
 }
 
+// Called in the FileSource thread.
+// Completes a request that was answered with a stale response, without answering it again.
+void Request::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        responses.push_back(nullptr);
+    }
+
+    if (async) {
+        uv_async_send(async);
+    } else {
+        invoke();
+    }
+}
+
 // Called in the originating thread.
 void Request::cancel() {
     MBGL_VERIFY_THREAD(tid)
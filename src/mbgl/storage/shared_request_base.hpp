@@ -5,9 +5,11 @@
 #include <mbgl/storage/file_cache.hpp>
 #include <mbgl/storage/default_file_source_impl.hpp>
 #include <mbgl/storage/request.hpp>
+#include <mbgl/storage/response.hpp>
 #include <mbgl/util/util.hpp>
 #include <mbgl/util/noncopyable.hpp>
 
+#include <algorithm>
 #include <string>
 #include <set>
 #include <vector>
@@ -44,6 +46,35 @@ public:
         MBGL_VERIFY_THREAD(tid);
 
         observers.insert(request);
+
+        if (servedStale(request)) {
+            request->notify(staleResponse);
+        }
+    }
+
+    // Answers the requests that accept stale responses with an expired response from the cache,
+    // while this request revalidates it.
+    void notifyStale(std::shared_ptr<const Response> response) {
+        MBGL_VERIFY_THREAD(tid);
+
+        auto stale = std::make_shared<Response>(*response);
+        stale->stale = true;
+        staleResponse = std::move(stale);
+
+        for (auto req : observers) {
+            if (servedStale(req)) {
+                req->notify(staleResponse);
+            }
+        }
+    }
+
+    // Whether the request was answered with the stale response.
+    bool servedStale(const Request *request) const {
+        return staleResponse && request->resource.freshness == Resource::StaleWhileRevalidate;
+    }
+
+    const std::shared_ptr<const Response>& getStaleResponse() const {
+        return staleResponse;
     }
 
     void unsubscribe(Request *request) {
@@ -67,6 +98,21 @@ public:
         return observers.empty();
     }
 
+    // The most urgent priority of the requests that wait for this one. Requests that were
+    // answered with a stale response don't wait anymore.
+    Resource::Priority priority() const {
+        if (observers.empty()) {
+            return resource.priority;
+        }
+        Resource::Priority result = Resource::Prefetch;
+        for (auto req : observers) {
+            if (!servedStale(req)) {
+                result = std::min(result, req->resource.priority);
+            }
+        }
+        return result;
+    }
+
     std::vector<Request *> removeAllInEnvironment(const Environment &env) {
         MBGL_VERIFY_THREAD(tid);
 
@@ -99,6 +145,7 @@ protected:
 
 private:
     std::set<Request *> observers;
+    std::shared_ptr<const Response> staleResponse;
 };
 
 }
@@ -0,0 +1,188 @@
+#include <mbgl/style/filter_program.hpp>
+#include <mbgl/style/filter_expression_private.hpp>
+#include <mbgl/map/geometry_tile.hpp>
+
+namespace mbgl {
+
+namespace {
+
+// Presents a single (possibly missing) value to a leaf expression, so that the
+// expression's own comparison semantics can be used to precompute its result.
+class ConstantExtractor {
+public:
+    ConstantExtractor(const Value* value_) : value(value_) {}
+
+    mapbox::util::optional<Value> getValue(const std::string&) const {
+        return value ? mapbox::util::optional<Value>(*value) : mapbox::util::optional<Value>();
+    }
+
+private:
+    const Value* value;
+};
+
+const uint32_t featureTypeCount = 4;
+
+}
+
+struct FilterCompiler : public mapbox::util::static_visitor<void> {
+    typedef FilterProgram::Op Op;
+
+    FilterProgram& program;
+    const GeometryTileLayer& layer;
+    const FilterExpression& expression;
+
+    FilterCompiler(FilterProgram& program_, const GeometryTileLayer& layer_, const FilterExpression& expression_)
+        : program(program_), layer(layer_), expression(expression_) {}
+
+    void emit(Op op, bool missing = false, uint32_t key = 0, uint32_t operand = 0) {
+        program.instructions.push_back({ op, missing, key, operand, 0 });
+    }
+
+    uint32_t addExpression() {
+        program.expressions.push_back(&expression);
+        return program.expressions.size() - 1;
+    }
+
+    void compile(const FilterExpression& child) {
+        FilterCompiler compiler(program, layer, child);
+        mapbox::util::apply_visitor(compiler, child);
+    }
+
+    // Compiles the children so that evaluation stops as soon as one of them yields
+    // `stop`, leaving that value as the result. An empty list yields `!stop`.
+    void compileSequence(const std::vector<FilterExpression>& children, bool stop) {
+        if (children.empty()) {
+            emit(Op::Constant, !stop);
+            return;
+        }
+
+        std::vector<std::size_t> jumps;
+        for (std::size_t i = 0; i < children.size(); i++) {
+            compile(children[i]);
+            if (i + 1 < children.size()) {
+                jumps.push_back(program.instructions.size());
+                emit(stop ? Op::JumpIfTrue : Op::JumpIfFalse);
+            }
+        }
+
+        for (std::size_t jump : jumps) {
+            program.instructions[jump].operand = program.instructions.size();
+        }
+    }
+
+    void operator()(const NullExpression&) {
+        emit(Op::Constant, true);
+    }
+
+    void operator()(const AnyExpression& e) {
+        compileSequence(e.expressions, true);
+    }
+
+    void operator()(const AllExpression& e) {
+        compileSequence(e.expressions, false);
+    }
+
+    void operator()(const NoneExpression& e) {
+        compileSequence(e.expressions, true);
+        emit(Op::Not);
+    }
+
+    template <class E>
+    void operator()(const E& e) {
+        if (e.key == "$type") {
+            const uint32_t offset = program.matches.size();
+            for (uint32_t type = 0; type < featureTypeCount; type++) {
+                const Value value = uint64_t(type);
+                program.matches.push_back(e.evaluate(ConstantExtractor(&value)));
+            }
+            // Malformed tiles may contain unknown feature types; those are evaluated
+            // with the original expression.
+            emit(Op::Type, false, 0, offset);
+            program.instructions.back().expression = addExpression();
+            return;
+        }
+
+        const bool missing = e.evaluate(ConstantExtractor(nullptr));
+
+        if (!program.values) {
+            emit(Op::Expression, missing);
+            program.instructions.back().expression = addExpression();
+            return;
+        }
+
+        const int32_t key = layer.getKeyIndex(e.key);
+        if (key < 0) {
+            // No feature in this layer has the key, so the result is the same for all of them.
+            emit(Op::Constant, missing);
+            return;
+        }
+
+        // Comparisons are evaluated lazily, as only a few of the layer's values belong to
+        // any given key.
+        const uint32_t offset = program.matches.size();
+        program.matches.resize(offset + program.values->size(), -1);
+        emit(Op::Indexed, missing, key, offset);
+        program.instructions.back().expression = addExpression();
+    }
+};
+
+FilterProgram::FilterProgram(const FilterExpression& expression, const GeometryTileLayer& layer)
+    : values(layer.getValueTable()) {
+    FilterCompiler compiler(*this, layer, expression);
+    mapbox::util::apply_visitor(compiler, expression);
+}
+
+bool FilterProgram::evaluate(const GeometryTileFeature& feature) const {
+    bool result = true;
+
+    const std::size_t count = instructions.size();
+    for (std::size_t pc = 0; pc < count;) {
+        const Instruction& instruction = instructions[pc++];
+        switch (instruction.op) {
+        case Op::Constant:
+            result = instruction.missing;
+            break;
+        case Op::Type: {
+            const uint32_t type = uint32_t(feature.getType());
+            if (type < featureTypeCount) {
+                result = matches[instruction.operand + type];
+            } else {
+                GeometryTileFeatureExtractor extractor(feature);
+                result = mbgl::evaluate(*expressions[instruction.expression], extractor);
+            }
+            break;
+        }
+        case Op::Indexed: {
+            const int32_t value = feature.getValueIndex(instruction.key);
+            result = value < 0 ? instruction.missing : match(instruction, value);
+            break;
+        }
+        case Op::Expression: {
+            GeometryTileFeatureExtractor extractor(feature);
+            result = mbgl::evaluate(*expressions[instruction.expression], extractor);
+            break;
+        }
+        case Op::Not:
+            result = !result;
+            break;
+        case Op::JumpIfTrue:
+            if (result) pc = instruction.operand;
+            break;
+        case Op::JumpIfFalse:
+            if (!result) pc = instruction.operand;
+            break;
+        }
+    }
+
+    return result;
+}
+
+bool FilterProgram::match(const Instruction& instruction, uint32_t value) const {
+    int8_t& cached = matches[instruction.operand + value];
+    if (cached < 0) {
+        cached = mbgl::evaluate(*expressions[instruction.expression], ConstantExtractor(&(*values)[value]));
+    }
+    return cached;
+}
+
+}
@@ -0,0 +1,61 @@
+#ifndef MBGL_STYLE_FILTER_PROGRAM
+#define MBGL_STYLE_FILTER_PROGRAM
+
+#include <mbgl/style/filter_expression.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace mbgl {
+
+class GeometryTileFeature;
+class GeometryTileLayer;
+
+// A FilterExpression compiled against a particular tile layer. Keys are resolved to
+// layer-local indices once, and the result of each comparison is memoized per entry of
+// the layer's value table, so that evaluating a feature mostly amounts to looking up
+// integer value indices. The expression tree is flattened into a linear program that
+// short-circuits any/all/none with jumps.
+//
+// Layers that don't intern their values fall back to evaluating the leaf expressions
+// against the feature by key name. Programs are meant to be used by a single thread.
+class FilterProgram {
+public:
+    FilterProgram(const FilterExpression&, const GeometryTileLayer&);
+
+    bool evaluate(const GeometryTileFeature&) const;
+
+private:
+    friend struct FilterCompiler;
+
+    enum class Op : uint8_t {
+        Constant,    // result = missing
+        Type,        // result = matches[operand + feature type]
+        Indexed,     // result = matches[operand + value index of key], or missing
+        Expression,  // result = evaluate(*expressions[expression], feature)
+        Not,         // result = !result
+        JumpIfTrue,  // if (result) goto operand
+        JumpIfFalse, // if (!result) goto operand
+    };
+
+    struct Instruction {
+        Op op;
+        bool missing;
+        uint32_t key;
+        uint32_t operand;
+        uint32_t expression;
+    };
+
+    bool match(const Instruction&, uint32_t value) const;
+
+    std::vector<Instruction> instructions;
+    std::vector<const FilterExpression*> expressions;
+    const std::vector<Value>* values = nullptr;
+
+    // Memoized leaf results: 1 or 0 once known, -1 before the value was first seen.
+    mutable std::vector<int8_t> matches;
+};
+
+}
+
+#endif
@@ -55,6 +55,7 @@ const std::map<PropertyKey, PropertyValue> PropertyFallbackValue::properties = {
     { PropertyKey::LineJoin, defaultStyleLayout<StyleLayoutLine>().join },
     { PropertyKey::LineMiterLimit, defaultStyleLayout<StyleLayoutLine>().miter_limit },
     { PropertyKey::LineRoundLimit, defaultStyleLayout<StyleLayoutLine>().round_limit },
+    { PropertyKey::LineSimplify, defaultStyleLayout<StyleLayoutLine>().simplify },
 
     { PropertyKey::SymbolPlacement, defaultStyleLayout<StyleLayoutSymbol>().placement },
     { PropertyKey::SymbolMinDistance, defaultStyleLayout<StyleLayoutSymbol>().min_distance },
@@ -26,6 +26,7 @@ enum class PropertyKey {
     LineJoin,
     LineMiterLimit,
     LineRoundLimit,
+    LineSimplify,
 
     SymbolPlacement,
     SymbolMinDistance,
@@ -30,6 +30,7 @@ public:
     JoinType join = JoinType::Miter;
     float miter_limit = 2.0f;
     float round_limit = 1.0f;
+    bool simplify = false;
 };
 
 class StyleLayoutSymbol {
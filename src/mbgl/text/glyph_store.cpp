@@ -13,33 +13,75 @@
 #include <mbgl/platform/platform.hpp>
 #include <mbgl/util/uv_detail.hpp>
 #include <algorithm>
+#include <cassert>
+#include <chrono>
 
 namespace mbgl {
 
 
-void FontStack::insert(uint32_t id, const SDFGlyph &glyph) {
-    std::lock_guard<std::mutex> lock(mtx);
-    metrics.emplace(id, glyph.metrics);
-    bitmaps.emplace(id, glyph.bitmap);
-    sdfs.emplace(id, glyph);
+constexpr uint32_t FontStack::blockSize;
+constexpr uint32_t FontStack::blockCount;
+
+FontStack::FontStack(uint32_t id_) : id(id_) {
+    for (auto &block : blocks) {
+        block = nullptr;
+    }
 }
 
-const std::map<uint32_t, GlyphMetrics> &FontStack::getMetrics() const {
-    std::lock_guard<std::mutex> lock(mtx);
-    return metrics;
+FontStack::~FontStack() {
+    for (auto &block : blocks) {
+        delete block.load();
+    }
 }
 
-const std::map<uint32_t, SDFGlyph> &FontStack::getSDFs() const {
+void FontStack::insert(const std::vector<SDFGlyph> &glyphs) {
     std::lock_guard<std::mutex> lock(mtx);
-    return sdfs;
+
+    // Build every affected block in full before publishing it, so that readers either see the
+    // previous version of a block or the complete new one.
+    std::map<uint32_t, std::unique_ptr<Block>> updated;
+    for (const auto &glyph : glyphs) {
+        const uint32_t index = glyph.id / blockSize;
+        if (index >= blockCount) {
+            continue;
+        }
+
+        auto &block = updated[index];
+        if (!block) {
+            const Block *existing = blocks[index].load(std::memory_order_relaxed);
+            block = existing ? util::make_unique<Block>(*existing) : util::make_unique<Block>();
+        }
+
+        block->glyphs[glyph.id % blockSize] = glyph;
+        block->loaded[glyph.id % blockSize] = true;
+    }
+
+    for (auto &it : updated) {
+        const Block *previous = blocks[it.first].exchange(it.second.release(), std::memory_order_release);
+        if (previous) {
+            retired.emplace_back(previous);
+        }
+    }
+}
+
+const SDFGlyph *FontStack::getGlyph(uint32_t glyph) const {
+    const uint32_t index = glyph / blockSize;
+    if (index >= blockCount) {
+        return nullptr;
+    }
+
+    const Block *block = blocks[index].load(std::memory_order_acquire);
+    if (!block || !block->loaded[glyph % blockSize]) {
+        return nullptr;
+    }
+
+    return &block->glyphs[glyph % blockSize];
 }
 
 const Shaping FontStack::getShaping(const std::u32string &string, const float maxWidth,
                                     const float lineHeight, const float horizontalAlign,
                                     const float verticalAlign, const float justify,
                                     const float spacing, const vec2<float> &translate) const {
-    std::lock_guard<std::mutex> lock(mtx);
-
     Shaping shaping;
 
     int32_t x = std::round(translate.x * 24); // one em
@@ -48,9 +90,8 @@ const Shaping FontStack::getShaping(const std::u32string &string, const float ma
     // Loop through all characters of this label and shape.
     for (uint32_t chr : string) {
         shaping.emplace_back(chr, x, y);
-        auto metric = metrics.find(chr);
-        if (metric != metrics.end()) {
-            x += metric->second.advance + spacing;
+        if (const SDFGlyph *glyph = getGlyph(chr)) {
+            x += glyph->metrics.advance + spacing;
         }
     }
 
@@ -74,12 +115,11 @@ void align(Shaping &shaping, const float justify, const float horizontalAlign,
     }
 }
 
-void justifyLine(Shaping &shaping, const std::map<uint32_t, GlyphMetrics> &metrics, uint32_t start,
-                 uint32_t end, float justify) {
+void justifyLine(Shaping &shaping, const FontStack &stack, uint32_t start, uint32_t end,
+                 float justify) {
     PositionedGlyph &glyph = shaping[end];
-    auto metric = metrics.find(glyph.glyph);
-    if (metric != metrics.end()) {
-        const uint32_t lastAdvance = metric->second.advance;
+    if (const SDFGlyph *sdf = stack.getGlyph(glyph.glyph)) {
+        const uint32_t lastAdvance = sdf->metrics.advance;
         const float lineIndent = float(glyph.x + lastAdvance) * justify;
 
         for (uint32_t j = start; j <= end; j++) {
@@ -117,7 +157,7 @@ void FontStack::lineWrap(Shaping &shaping, const float lineHeight, const float m
                 }
 
                 if (justify) {
-                    justifyLine(shaping, metrics, lineStartIndex, lastSafeBreak - 1, justify);
+                    justifyLine(shaping, *this, lineStartIndex, lastSafeBreak - 1, justify);
                 }
 
                 lineStartIndex = lastSafeBreak + 1;
@@ -134,14 +174,15 @@ void FontStack::lineWrap(Shaping &shaping, const float lineHeight, const float m
 
     if (!maxLineLength) maxLineLength = shaping.back().x;
 
-    justifyLine(shaping, metrics, lineStartIndex, uint32_t(shaping.size()) - 1, justify);
+    justifyLine(shaping, *this, lineStartIndex, uint32_t(shaping.size()) - 1, justify);
     align(shaping, justify, horizontalAlign, verticalAlign, maxLineLength, lineHeight, line);
 }
 
 GlyphPBF::GlyphPBF(const std::string &glyphURL,
                    const std::string &fontStack,
                    GlyphRange glyphRange,
-                   Environment &env)
+                   Environment &env,
+                   std::function<void()> callback)
     : future(promise.get_future().share()) {
     // Load the glyph set URL
     std::string url = util::replaceTokens(glyphURL, [&](const std::string &name) -> std::string {
@@ -150,8 +191,9 @@ GlyphPBF::GlyphPBF(const std::string &glyphURL,
         return "";
     });
 
-    // The prepare call jumps back to the main thread.
-    env.requestAsync({ Resource::Kind::Glyphs, url }, [&, url](const Response &res) {
+    // The request is bound to the map thread's loop, which keeps the loop alive until it
+    // completes.
+    env.request({ Resource::Kind::Glyphs, url }, [&, url, callback](const Response &res) {
         if (res.status != Response::Successful) {
             // Something went wrong with loading the glyph pbf. Pass on the error to the future listeners.
             const std::string msg = std::string { "[ERROR] failed to load glyphs: " } + res.message;
@@ -159,11 +201,15 @@ GlyphPBF::GlyphPBF(const std::string &glyphURL,
         } else {
             // Transfer the data to the GlyphSet and signal its availability.
             // Once it is available, the caller will need to call parse() to actually
-            // parse the data we received. We are not doing this here since this callback is being
-            // called from another (unknown) thread.
+            // parse the data we received. We are not doing this here since parsing happens
+            // on the worker threads.
             data = res.data;
             promise.set_value(*this);
         }
+
+        if (callback) {
+            callback();
+        }
     });
 }
 
@@ -172,17 +218,23 @@ std::shared_future<GlyphPBF &> GlyphPBF::getFuture() {
     return future;
 }
 
+bool GlyphPBF::isLoaded() const {
+    return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
 void GlyphPBF::parse(FontStack &stack) {
     std::lock_guard<std::mutex> lock(mtx);
 
-    if (!data.size()) {
+    if (!data || data->empty()) {
         // If there is no data, this means we either haven't received any data, or
         // we have already parsed the data.
         return;
     }
 
+    std::vector<SDFGlyph> parsed;
+
     // Parse the glyph PBF
-    pbf glyphs_pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+    pbf glyphs_pbf(reinterpret_cast<const uint8_t *>(data->data()), data->size());
 
     while (glyphs_pbf.next()) {
         if (glyphs_pbf.tag == 1) { // stacks
@@ -213,7 +265,7 @@ void GlyphPBF::parse(FontStack &stack) {
                         }
                     }
 
-                    stack.insert(glyph.id, glyph);
+                    parsed.emplace_back(std::move(glyph));
                 } else {
                     fontstack_pbf.skip();
                 }
@@ -223,70 +275,103 @@ void GlyphPBF::parse(FontStack &stack) {
         }
     }
 
-    data.clear();
+    stack.insert(parsed);
+    data.reset();
 }
 
-GlyphStore::GlyphStore(Environment& env_) : env(env_), mtx(util::make_unique<uv::mutex>()) {}
+GlyphStore::GlyphStore(Environment& env_, std::function<void()> callback_)
+    : env(env_), callback(callback_), mtx(util::make_unique<uv::mutex>()) {}
+
+// Note: This destructor is seemingly empty, but we need to declare it anyway
+// because this object has a std::unique_ptr<> of a forward-declared type in
+// its header file.
+GlyphStore::~GlyphStore() = default;
 
 void GlyphStore::setURL(const std::string &url) {
     glyphURL = url;
 }
 
-
-void GlyphStore::waitForGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges) {
-    // We are implementing a blocking wait with futures: Every GlyphSet has a future that we are
-    // waiting for until it is loaded.
+bool GlyphStore::hasGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges) {
     if (glyphRanges.empty()) {
-        return;
+        return true;
     }
 
-    uv::exclusive<FontStack> stack(mtx);
+    uv::lock lock(mtx);
 
-    std::vector<std::shared_future<GlyphPBF &>> futures;
-    futures.reserve(glyphRanges.size());
-    {
-        auto &rangeSets = ranges[fontStack];
-
-        stack << createFontStack(fontStack);
+    auto rangeSets_it = ranges.find(fontStack);
+    if (rangeSets_it == ranges.end()) {
+        return false;
+    }
 
-        // Attempt to load the glyph range. If the GlyphSet already exists, we are getting back
-        // the same shared_future.
-        for (const auto range : glyphRanges) {
-            futures.emplace_back(loadGlyphRange(fontStack, rangeSets, range));
+    const auto& rangeSets = rangeSets_it->second;
+    for (const auto range : glyphRanges) {
+        const auto range_it = rangeSets.find(range);
+        if (range_it == rangeSets.end() || !range_it->second->isLoaded()) {
+            return false;
         }
     }
 
-    // Now that we potentially created all GlyphSets, we are waiting for the results, one by one.
-    // When we get a result (or the GlyphSet is aready loaded), we are attempting to parse the
-    // GlyphSet.
-    for (const auto& future : futures) {
-        future.get().parse(stack);
+    return true;
+}
+
+void GlyphStore::requestGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges) {
+    if (glyphRanges.empty()) {
+        return;
+    }
+
+    uv::lock lock(mtx);
+
+    auto &rangeSets = ranges[fontStack];
+    for (const auto range : glyphRanges) {
+        if (rangeSets.find(range) == rangeSets.end()) {
+            // We don't have this glyph set yet for this font stack.
+            rangeSets.emplace(range, util::make_unique<GlyphPBF>(glyphURL, fontStack, range, env, callback));
+        }
     }
 }
 
-std::shared_future<GlyphPBF &> GlyphStore::loadGlyphRange(const std::string &fontStack, std::map<GlyphRange, std::unique_ptr<GlyphPBF>> &rangeSets, const GlyphRange range) {
-    auto range_it = rangeSets.find(range);
-    if (range_it == rangeSets.end()) {
-        // We don't have this glyph set yet for this font stack.
-        range_it = rangeSets.emplace(range, util::make_unique<GlyphPBF>(glyphURL, fontStack, range, env)).first;
+void GlyphStore::parseGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges) {
+    if (glyphRanges.empty()) {
+        return;
     }
 
-    return range_it->second->getFuture();
+    FontStack *stack = nullptr;
+    std::vector<GlyphPBF *> pbfs;
+
+    {
+        uv::lock lock(mtx);
+        stack = &createFontStack(fontStack);
+
+        auto &rangeSets = ranges[fontStack];
+        for (const auto range : glyphRanges) {
+            const auto range_it = rangeSets.find(range);
+            assert(range_it != rangeSets.end() && range_it->second->isLoaded());
+            pbfs.push_back(range_it->second.get());
+        }
+    }
+
+    // Parsing happens outside of the store lock: GlyphPBF and FontStack serialize their writers
+    // themselves, and other threads may keep shaping with the font stack in the meantime. When
+    // we get a result (or the GlyphSet is already parsed), we are attempting to parse the
+    // GlyphSet. Loading errors are rethrown by get().
+    for (GlyphPBF *glyphPBF : pbfs) {
+        glyphPBF->getFuture().get().parse(*stack);
+    }
 }
 
 FontStack &GlyphStore::createFontStack(const std::string &fontStack) {
     auto stack_it = stacks.find(fontStack);
     if (stack_it == stacks.end()) {
-        stack_it = stacks.emplace(fontStack, util::make_unique<FontStack>()).first;
+        stack_it = stacks.emplace(fontStack, util::make_unique<FontStack>(nextStackID++)).first;
     }
 
     return *stack_it->second.get();
 }
 
-uv::exclusive<FontStack> GlyphStore::getFontStack(const std::string &fontStack) {
-    uv::exclusive<FontStack> stack(mtx);
-    stack << createFontStack(fontStack);
-    return stack;
+FontStack &GlyphStore::getFontStack(const std::string &fontStack) {
+    // Font stacks are never removed, so the reference outlives the lock.
+    uv::lock lock(mtx);
+    return createFontStack(fontStack);
 }
 
 
@@ -5,10 +5,16 @@
 #include <mbgl/util/vec.hpp>
 #include <mbgl/util/ptr.hpp>
 #include <mbgl/util/uv.hpp>
+#include <mbgl/util/noncopyable.hpp>
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <vector>
 #include <future>
+#include <memory>
+#include <mutex>
 #include <map>
 #include <set>
 #include <unordered_map>
@@ -29,22 +35,45 @@ public:
     GlyphMetrics metrics;
 };
 
-class FontStack {
+// Glyphs are added in whole ranges by a single writer at a time, while any number of worker
+// threads shape labels concurrently. Lookups never take a lock: glyphs are stored in dense blocks
+// of 256 code points that are published atomically once they are complete.
+class FontStack : private util::noncopyable {
 public:
-    void insert(uint32_t id, const SDFGlyph &glyph);
-    const std::map<uint32_t, GlyphMetrics> &getMetrics() const;
-    const std::map<uint32_t, SDFGlyph> &getSDFs() const;
+    explicit FontStack(uint32_t id);
+    ~FontStack();
+
+    // Identifies the font stack within its GlyphStore. IDs are small and handed out sequentially.
+    uint32_t getID() const { return id; }
+
+    void insert(const std::vector<SDFGlyph> &glyphs);
+
+    // Returns nullptr if the glyph hasn't been loaded. The returned glyph stays valid for the
+    // lifetime of the font stack.
+    const SDFGlyph *getGlyph(uint32_t id) const;
+
     const Shaping getShaping(const std::u32string &string, float maxWidth, float lineHeight,
                              float horizontalAlign, float verticalAlign, float justify,
                              float spacing, const vec2<float> &translate) const;
     void lineWrap(Shaping &shaping, float lineHeight, float maxWidth, float horizontalAlign,
                   float verticalAlign, float justify) const;
 
+    // Glyph ranges only cover the BMP.
+    static constexpr uint32_t blockSize = 256;
+    static constexpr uint32_t blockCount = 256;
+
 private:
-    std::map<uint32_t, std::string> bitmaps;
-    std::map<uint32_t, GlyphMetrics> metrics;
-    std::map<uint32_t, SDFGlyph> sdfs;
-    mutable std::mutex mtx;
+    struct Block {
+        std::array<SDFGlyph, blockSize> glyphs;
+        std::array<bool, blockSize> loaded {{}};
+    };
+
+    const uint32_t id;
+    std::array<std::atomic<const Block *>, blockCount> blocks;
+
+    // Blocks that were replaced by a newer copy. Readers may still hold pointers into them.
+    std::vector<std::unique_ptr<const Block>> retired;
+    std::mutex mtx;
 };
 
 class GlyphPBF {
@@ -52,7 +81,8 @@ public:
     GlyphPBF(const std::string &glyphURL,
              const std::string &fontStack,
              GlyphRange glyphRange,
-             Environment &env);
+             Environment &env,
+             std::function<void()> callback);
 
 private:
     GlyphPBF(const GlyphPBF &) = delete;
@@ -64,9 +94,10 @@ public:
     void parse(FontStack &stack);
 
     std::shared_future<GlyphPBF &> getFuture();
+    bool isLoaded() const;
 
 private:
-    std::string data;
+    std::shared_ptr<const std::string> data;
     std::promise<GlyphPBF &> promise;
     std::shared_future<GlyphPBF &> future;
     std::mutex mtx;
@@ -75,25 +106,35 @@ private:
 // Manages Glyphrange PBF loading.
 class GlyphStore {
 public:
-    GlyphStore(Environment &);
+    // The callback is invoked on the map thread whenever a glyph range finished loading.
+    GlyphStore(Environment &, std::function<void()> callback = nullptr);
+    ~GlyphStore();
+
+    // Returns whether all specified GlyphRanges of the specified font stack are loaded. This never
+    // blocks and can be called from any thread.
+    bool hasGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges);
 
-    // Block until all specified GlyphRanges of the specified font stack are loaded.
-    void waitForGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges);
+    // Starts loading the specified GlyphRanges that haven't been requested yet. Must be called
+    // on the map thread.
+    void requestGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges);
 
-    uv::exclusive<FontStack> getFontStack(const std::string &fontStack);
+    // Parses the specified GlyphRanges into the font stack. All of them must have been loaded.
+    void parseGlyphRanges(const std::string &fontStack, const std::set<GlyphRange> &glyphRanges);
+
+    // The font stack can be read from any thread while other threads parse glyphs into it.
+    FontStack &getFontStack(const std::string &fontStack);
 
     void setURL(const std::string &url);
 
 private:
-    // Loads an individual glyph range from the font stack and adds it to rangeSets
-    std::shared_future<GlyphPBF &> loadGlyphRange(const std::string &fontStack, std::map<GlyphRange, std::unique_ptr<GlyphPBF>> &rangeSets, GlyphRange range);
-
     FontStack &createFontStack(const std::string &fontStack);
 
     std::string glyphURL;
     Environment &env;
+    std::function<void()> callback;
     std::unordered_map<std::string, std::map<GlyphRange, std::unique_ptr<GlyphPBF>>> ranges;
     std::unordered_map<std::string, std::unique_ptr<FontStack>> stacks;
+    uint32_t nextStackID = 0;
     std::unique_ptr<uv::mutex> mtx;
 };
 
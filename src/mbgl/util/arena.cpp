@@ -0,0 +1,137 @@
+#include <mbgl/util/arena.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace mbgl {
+namespace util {
+
+namespace {
+
+const std::size_t alignment = alignof(std::max_align_t);
+
+inline std::size_t align(std::size_t size) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// Every allocation is preceded by its size, which reallocate() needs to copy it.
+const std::size_t headerSize = align(sizeof(std::size_t));
+
+inline std::size_t& sizeOf(char* data) {
+    return *reinterpret_cast<std::size_t*>(data - headerSize);
+}
+
+}
+
+Arena::Arena(std::size_t chunkSize_) : chunkSize(chunkSize_) {
+}
+
+Arena::~Arena() {
+    for (const Chunk& chunk : chunkList) {
+        std::free(chunk.data);
+    }
+    std::free(spare);
+}
+
+void* Arena::allocate(std::size_t size) {
+    allocationCount++;
+
+    const std::size_t needed = headerSize + align(size);
+    if (std::size_t(end - cursor) < needed) {
+        addChunk(needed);
+    }
+
+    last = cursor + headerSize;
+    cursor += needed;
+    sizeOf(last) = size;
+    return last;
+}
+
+void* Arena::reallocate(void* ptr, std::size_t size) {
+    if (!ptr) {
+        return allocate(size);
+    }
+
+    char* data = static_cast<char*>(ptr);
+    const std::size_t oldSize = sizeOf(data);
+
+    if (data == last && std::size_t(end - data) >= align(size)) {
+        allocationCount++;
+        cursor = data + align(size);
+        sizeOf(data) = size;
+        return data;
+    }
+
+    if (size <= oldSize) {
+        allocationCount++;
+        return data;
+    }
+
+    void* copy = allocate(size);
+    std::memcpy(copy, data, oldSize);
+    return copy;
+}
+
+void Arena::deallocate(void* ptr) {
+    if (ptr && ptr == last) {
+        cursor = last - headerSize;
+        last = nullptr;
+    }
+}
+
+Arena::Mark Arena::mark() const {
+    Mark m;
+    m.chunks = chunkList.size();
+    m.cursor = cursor;
+    m.end = end;
+    m.last = last;
+    return m;
+}
+
+void Arena::rewind(const Mark& m) {
+    while (chunkList.size() > m.chunks) {
+        const Chunk chunk = chunkList.back();
+        chunkList.pop_back();
+
+        // Keep a regular chunk around, so that rewinding after every feature doesn't go to the
+        // system for a new one each time.
+        if (!spare && chunk.size == chunkSize) {
+            spare = chunk.data;
+        } else {
+            std::free(chunk.data);
+            totalBytes -= chunk.size;
+        }
+    }
+
+    cursor = m.cursor;
+    end = m.end;
+    last = m.last;
+}
+
+void Arena::addChunk(std::size_t size) {
+    // Allocations that don't fit into a regular chunk get one of their own. Whatever space is
+    // left in the current chunk is abandoned.
+    size = std::max(size, chunkSize);
+
+    char* chunk = nullptr;
+    if (spare && size == chunkSize) {
+        chunk = spare;
+        spare = nullptr;
+    } else {
+        chunk = static_cast<char*>(std::malloc(size));
+        if (!chunk) {
+            throw std::bad_alloc();
+        }
+        totalBytes += size;
+        maxBytes = std::max(maxBytes, totalBytes);
+    }
+
+    chunkList.push_back({ chunk, size });
+    cursor = chunk;
+    end = chunk + size;
+}
+
+}
+}
@@ -0,0 +1,81 @@
+#ifndef MBGL_UTIL_ARENA
+#define MBGL_UTIL_ARENA
+
+#include <mbgl/util/noncopyable.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace mbgl {
+namespace util {
+
+// Hands out memory from large chunks, and frees all of it at once when it is destroyed. This
+// suits the many short-lived allocations made while parsing a single tile, which would
+// otherwise each go through malloc and free. Not thread-safe.
+class Arena : private noncopyable {
+public:
+    explicit Arena(std::size_t chunkSize = 64 * 1024);
+    ~Arena();
+
+    // Returns memory that is suitably aligned for any type.
+    void* allocate(std::size_t size);
+
+    // Resizes an allocation like realloc, in place if it is the most recent one.
+    void* reallocate(void* ptr, std::size_t size);
+
+    // Memory is only reclaimed when the arena is destroyed or rewound, except for the most
+    // recent allocation, which is given back right away.
+    void deallocate(void* ptr);
+
+    // The state of the arena at some point, which it can be rewound to.
+    struct Mark {
+        std::size_t chunks = 0;
+        char* cursor = nullptr;
+        char* end = nullptr;
+        char* last = nullptr;
+    };
+
+    Mark mark() const;
+
+    // Gives back everything that was allocated since the mark was taken, and frees the chunks
+    // that were added for it, except for one regular chunk that is kept for reuse. Allocations
+    // made before the mark stay valid.
+    void rewind(const Mark&);
+
+    // The number of allocations and reallocations that were served, and the number of
+    // chunks in use that served them.
+    std::size_t allocations() const { return allocationCount; }
+    std::size_t chunks() const { return chunkList.size(); }
+
+    // The number of bytes currently allocated from the system, and the most there ever were.
+    std::size_t bytes() const { return totalBytes; }
+    std::size_t peakBytes() const { return maxBytes; }
+
+private:
+    void addChunk(std::size_t size);
+
+    struct Chunk {
+        char* data;
+        std::size_t size;
+    };
+
+    const std::size_t chunkSize;
+    std::vector<Chunk> chunkList;
+
+    // A regular chunk that was given back by rewind(), and is used for the next one needed.
+    char* spare = nullptr;
+
+    // The free space of the current chunk, and the most recent allocation.
+    char* cursor = nullptr;
+    char* end = nullptr;
+    char* last = nullptr;
+
+    std::size_t allocationCount = 0;
+    std::size_t totalBytes = 0;
+    std::size_t maxBytes = 0;
+};
+
+}
+}
+
+#endif
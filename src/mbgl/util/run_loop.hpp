@@ -53,6 +53,9 @@ public:
 
     uv_loop_t* get() { return *loop; }
 
+    // Returns the run loop of the current thread, or nullptr if it isn't running one.
+    static RunLoop* Get() { return current.get(); }
+
 private:
     // A movable type-erasing invokable entity wrapper. This allows to store arbitrary invokable
     // things (like std::function<>, or the result of a movable-only std::bind()) in the queue.
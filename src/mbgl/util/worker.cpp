@@ -1,36 +1,71 @@
 #include <mbgl/util/worker.hpp>
 
+#include <algorithm>
 #include <cassert>
 
 namespace mbgl {
 
+WorkTask::WorkTask(Fn work_, Fn after_, double priority_)
+    : work(std::move(work_)),
+      after(std::move(after_)),
+      priority(priority_),
+      queued(Clock::now()) {
+}
+
+void WorkTask::setPriority(double priority_) {
+    priority = priority_;
+}
+
+double WorkTask::getPriority() const {
+    return priority;
+}
+
+void WorkTask::cancel() {
+    canceled = true;
+}
+
+bool WorkTask::isCanceled() const {
+    return canceled;
+}
+
 Worker::Worker(uv_loop_t* loop, std::size_t count)
-    : queue(new Queue(loop, [this](Fn after) { afterWork(after); }))
+    : queue(new Queue(loop, [this](Task& task) { afterWork(*task); }))
 {
     queue->unref();
 
+    if (count == 0) {
+        count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        deques.emplace_back(util::make_unique<Deque>());
+    }
+
     for (std::size_t i = 0; i < count; i++) {
-        threads.emplace_back(&Worker::workLoop, this);
+        threads.emplace_back(&Worker::workLoop, this, i);
     }
 }
 
 Worker::~Worker() {
     MBGL_VERIFY_THREAD(tid);
 
-    if (active++ == 0) {
-        queue->ref();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        terminate = true;
     }
-
-    channel.send(Work());
+    condition.notify_all();
 
     for (auto& thread : threads) {
         thread.join();
     }
 
+    // Tasks that never got to run are dropped here, on the thread that owns the loop.
+    deques.clear();
+
     queue->stop();
 }
 
-void Worker::send(Fn work, Fn after) {
+std::shared_ptr<WorkTask> Worker::send(Fn work, Fn after, double priority) {
     MBGL_VERIFY_THREAD(tid);
     assert(work);
 
@@ -38,32 +73,117 @@ void Worker::send(Fn work, Fn after) {
         queue->ref();
     }
 
-    channel.send({work, after});
+    auto task = std::make_shared<WorkTask>(std::move(work), std::move(after), priority);
+
+    // Count the task before it can be taken, so that pending never drops below zero.
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending++;
+    }
+
+    Deque& deque = *deques[next++ % deques.size()];
+    {
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        deque.tasks.push_back(task);
+    }
+    condition.notify_one();
+
+    return task;
 }
 
-void Worker::workLoop() {
-#ifdef __APPLE__
-    pthread_setname_np("Worker");
-#endif
+Worker::Metrics Worker::getMetrics() const {
+    Metrics metrics;
+    metrics.threads = threads.size();
+    metrics.queued = pending;
+    metrics.executed = executed;
+    metrics.canceled = canceled;
+    metrics.stolen = stolen;
+    metrics.totalWait = Duration(totalWait.load());
+    metrics.maxWait = Duration(maxWait.load());
+    return metrics;
+}
 
-    while (true) {
-        Work item = channel.receive();
+Worker::Task Worker::takeFrom(Deque& deque) {
+    std::lock_guard<std::mutex> lock(deque.mutex);
+    if (deque.tasks.empty()) {
+        return nullptr;
+    }
 
-        if (!item.work)
+    // Priorities may change while tasks are queued, so the deque is not kept sorted. It only ever
+    // holds a few dozen tiles, which makes a linear scan cheaper than maintaining a heap.
+    auto best = deque.tasks.begin();
+    for (auto it = deque.tasks.begin(); it != deque.tasks.end(); ++it) {
+        if ((*it)->isCanceled()) {
+            best = it;
             break;
+        } else if ((*it)->getPriority() < (*best)->getPriority()) {
+            best = it;
+        }
+    }
+
+    Task task = std::move(*best);
+    deque.tasks.erase(best);
+    pending--;
+    return task;
+}
 
-        item.work();
-        queue->send(std::move(item.after));
+Worker::Task Worker::take(std::size_t index) {
+    if (Task task = takeFrom(*deques[index])) {
+        return task;
     }
 
-    // Make sure to close all other workers too.
-    channel.send(Work());
+    for (std::size_t i = 1; i < deques.size(); i++) {
+        if (Task task = takeFrom(*deques[(index + i) % deques.size()])) {
+            stolen++;
+            return task;
+        }
+    }
+
+    return nullptr;
 }
 
-void Worker::afterWork(Fn after) {
-    if (after) {
-        after();
+void Worker::workLoop(std::size_t index) {
+#ifdef __APPLE__
+    pthread_setname_np("Worker");
+#endif
+
+    while (true) {
+        Task task = take(index);
+
+        if (!task) {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [&] { return terminate || pending > 0; });
+            if (terminate) {
+                break;
+            }
+            continue;
+        }
+
+        if (task->isCanceled()) {
+            canceled++;
+        } else {
+            const Duration::rep wait = (Clock::now() - task->queued).count();
+            totalWait += wait;
+            Duration::rep max = maxWait;
+            while (wait > max && !maxWait.compare_exchange_weak(max, wait)) {}
+
+            task->work();
+            executed++;
+        }
+
+        // Hand over our reference so that the task, and everything its callbacks hold on to, is
+        // destroyed on the thread that owns the loop.
+        queue->send(std::move(task));
     }
+}
+
+void Worker::afterWork(WorkTask& task) {
+    if (task.after && !task.isCanceled()) {
+        task.after();
+    }
+
+    task.work = nullptr;
+    task.after = nullptr;
 
     if (--active == 0) {
         queue->unref();
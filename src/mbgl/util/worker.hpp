@@ -3,39 +3,104 @@
 
 #include <mbgl/util/noncopyable.hpp>
 #include <mbgl/util/async_queue.hpp>
-#include <mbgl/util/channel.hpp>
+#include <mbgl/util/chrono.hpp>
 #include <mbgl/util/util.hpp>
 
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <functional>
+#include <vector>
 
 namespace mbgl {
 
+// Handle to a unit of work that was submitted to a Worker. Tasks with lower priority values are
+// executed first; both the priority and the cancellation flag may be changed from any thread
+// while the task is still queued.
+class WorkTask : private util::noncopyable {
+public:
+    using Fn = std::function<void ()>;
+
+    WorkTask(Fn work, Fn after, double priority);
+
+    void setPriority(double);
+    double getPriority() const;
+
+    // Canceled tasks that haven't started yet are dropped without running. Neither the work
+    // nor the after callback run after cancelation, but a task that's already running is not
+    // interrupted.
+    void cancel();
+    bool isCanceled() const;
+
+private:
+    friend class Worker;
+
+    Fn work;
+    Fn after;
+    std::atomic<double> priority;
+    std::atomic<bool> canceled { false };
+    const TimePoint queued;
+};
+
 class Worker : public mbgl::util::noncopyable {
 public:
     using Fn = std::function<void ()>;
 
-    Worker(uv_loop_t* loop, std::size_t count);
+    struct Metrics {
+        std::size_t threads = 0;
+        std::size_t queued = 0;
+        std::size_t executed = 0;
+        std::size_t canceled = 0;
+        std::size_t stolen = 0;
+        Duration totalWait = Duration::zero();
+        Duration maxWait = Duration::zero();
+    };
+
+    // A count of 0 sizes the pool to the number of hardware threads.
+    explicit Worker(uv_loop_t* loop, std::size_t count = 0);
     ~Worker();
 
-    void send(Fn work, Fn after);
+    // Runs `work` on one of the worker threads, then `after` on the thread that owns the loop.
+    std::shared_ptr<WorkTask> send(Fn work, Fn after, double priority = 0);
+
+    Metrics getMetrics() const;
 
 private:
-    void workLoop();
-    void afterWork(Fn after);
+    using Task = std::shared_ptr<WorkTask>;
 
-    struct Work {
-        Fn work;
-        Fn after;
+    // Every thread pulls from its own deque first and steals from the others once it is empty.
+    struct Deque {
+        std::mutex mutex;
+        std::vector<Task> tasks;
     };
 
-    using Queue = util::AsyncQueue<std::function<void ()>>;
+    void workLoop(std::size_t index);
+    Task take(std::size_t index);
+    Task takeFrom(Deque&);
+    void afterWork(WorkTask&);
+
+    using Queue = util::AsyncQueue<Task>;
 
     std::size_t active = 0;
+    std::size_t next = 0;
     Queue* queue = nullptr;
-    Channel<Work> channel;
+
+    std::vector<std::unique_ptr<Deque>> deques;
     std::vector<std::thread> threads;
 
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::atomic<std::size_t> pending { 0 };
+    bool terminate = false;
+
+    std::atomic<std::size_t> executed { 0 };
+    std::atomic<std::size_t> canceled { 0 };
+    std::atomic<std::size_t> stolen { 0 };
+    std::atomic<Duration::rep> totalWait { 0 };
+    std::atomic<Duration::rep> maxWait { 0 };
+
     MBGL_STORE_THREAD(tid)
 };
 
@@ -0,0 +1,58 @@
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<bool> counting { false };
+std::atomic<std::size_t> allocations { 0 };
+
+void* allocate(std::size_t size) {
+    if (counting) {
+        allocations++;
+    }
+    void* ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+}
+
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size) {
+    return allocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+namespace mbgl {
+namespace test {
+
+AllocationCounter::AllocationCounter() {
+    allocations = 0;
+    counting = true;
+}
+
+AllocationCounter::~AllocationCounter() {
+    counting = false;
+}
+
+std::size_t AllocationCounter::count() const {
+    return allocations;
+}
+
+}
+}
@@ -0,0 +1,23 @@
+#ifndef MBGL_TEST_ALLOCATION_COUNTER
+#define MBGL_TEST_ALLOCATION_COUNTER
+
+#include <cstddef>
+
+namespace mbgl {
+namespace test {
+
+// Counts the allocations made through operator new while it is alive. The allocation
+// functions are replaced for the whole binary, which is why these tests have a target of
+// their own. Memory from malloc and realloc isn't counted.
+class AllocationCounter {
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    std::size_t count() const;
+};
+
+}
+}
+
+#endif
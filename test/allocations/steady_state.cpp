@@ -0,0 +1,152 @@
+#include "allocation_counter.hpp"
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/renderer/fill_bucket.hpp>
+#include <mbgl/renderer/line_bucket.hpp>
+#include <mbgl/geometry/fill_buffer.hpp>
+#include <mbgl/geometry/line_buffer.hpp>
+#include <mbgl/geometry/elements_buffer.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/arena.hpp>
+
+using namespace mbgl;
+
+// Once a bucket has seen features as large as the ones that follow, decoding a feature and
+// adding it to the bucket makes no allocations. The exceptions are:
+//
+// - Vertex and element buffers, which grow geometrically through realloc.
+// - A new element group once the current one is full, which happens every 65535 vertices.
+// - Fill features that earcut can't triangulate. Clipper allocates while cleaning them up, and
+//   libtess2 allocates from the tile parser's arena, which is rewound after every feature.
+// - Symbol buckets, which copy every feature's geometry into SymbolFeature::geometry, since
+//   features are placed only after all of them have been added.
+//
+// Buffers and groups are kept out of the count by adding the same features twice, with few
+// enough vertices for both passes to fit into a single group.
+
+namespace {
+
+const std::size_t maxVertices = 16384;
+
+// Adds the layer's features of the given type until the bucket has the given number of
+// vertices, and returns the number of features that were looked at.
+template <typename Bucket, typename VertexBuffer>
+std::size_t warmUp(const GeometryTileLayer& layer, FeatureType type, Bucket& bucket,
+                   const VertexBuffer& vertexBuffer, GeometryBuffer& geometry) {
+    std::size_t count = 0;
+    for (; count < layer.featureCount() && vertexBuffer.index() < maxVertices; count++) {
+        const auto& feature = layer.getFeature(count);
+        if (feature.getType() == type) {
+            feature.decodeGeometries(geometry);
+            bucket.addGeometry(geometry);
+        }
+    }
+    return count;
+}
+
+// Adds the first features of the layer again, and returns the number of allocations made.
+template <typename Bucket>
+std::size_t countAllocations(const GeometryTileLayer& layer, std::size_t count, FeatureType type,
+                             Bucket& bucket, GeometryBuffer& geometry) {
+    test::AllocationCounter allocations;
+    for (std::size_t i = 0; i < count; i++) {
+        const auto& feature = layer.getFeature(i);
+        if (feature.getType() == type) {
+            feature.decodeGeometries(geometry);
+            bucket.addGeometry(geometry);
+        }
+    }
+    return allocations.count();
+}
+
+}
+
+TEST(Allocations, Decode) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("admin");
+    ASSERT_TRUE(bool(layer));
+
+    GeometryBuffer geometry;
+    for (std::size_t i = 0; i < layer->featureCount(); i++) {
+        layer->getFeature(i).decodeGeometries(geometry);
+    }
+
+    test::AllocationCounter allocations;
+    for (std::size_t i = 0; i < layer->featureCount(); i++) {
+        layer->getFeature(i).decodeGeometries(geometry);
+    }
+    EXPECT_EQ(0u, allocations.count());
+}
+
+TEST(Allocations, LineBucket) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("admin");
+    ASSERT_TRUE(bool(layer));
+
+    for (const JoinType join : { JoinType::Miter, JoinType::Round }) {
+        LineVertexBuffer vertexBuffer;
+        TriangleElementsBuffer triangleElementsBuffer;
+        PointElementsBuffer pointElementsBuffer;
+        LineBucket bucket(vertexBuffer, triangleElementsBuffer, pointElementsBuffer);
+        bucket.layout.join = join;
+        bucket.layout.simplify = true;
+        bucket.tolerance = 1;
+
+        GeometryBuffer geometry;
+        const std::size_t count = warmUp(*layer, FeatureType::LineString, bucket, vertexBuffer, geometry);
+        const std::size_t vertices = vertexBuffer.index();
+        ASSERT_LT(0u, vertices);
+
+        EXPECT_EQ(0u, countAllocations(*layer, count, FeatureType::LineString, bucket, geometry));
+        EXPECT_EQ(2 * vertices, vertexBuffer.index());
+        ASSERT_GE(65535u, vertexBuffer.index());
+    }
+}
+
+TEST(Allocations, FillBucket) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("water");
+    ASSERT_TRUE(bool(layer));
+
+    util::Arena arena;
+    FillVertexBuffer vertexBuffer;
+    TriangleElementsBuffer triangleElementsBuffer;
+    LineElementsBuffer lineElementsBuffer;
+    FillBucket bucket(vertexBuffer, triangleElementsBuffer, lineElementsBuffer,
+                      FillBucket::Triangulation::Earcut, &arena);
+
+    GeometryBuffer geometry;
+    const std::size_t count = warmUp(*layer, FeatureType::Polygon, bucket, vertexBuffer, geometry);
+    const std::size_t vertices = vertexBuffer.index();
+    ASSERT_LT(0u, vertices);
+
+    // Features that went to libtess2 are told apart by their use of the arena. Clipper
+    // allocates its own structures for them.
+    std::size_t triangulated = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        const auto& feature = layer->getFeature(i);
+        if (feature.getType() != FeatureType::Polygon) {
+            continue;
+        }
+
+        const std::size_t arenaAllocations = arena.allocations();
+        test::AllocationCounter allocations;
+        feature.decodeGeometries(geometry);
+        bucket.addGeometry(geometry);
+        if (arena.allocations() == arenaAllocations) {
+            EXPECT_EQ(0u, allocations.count()) << "feature " << i;
+            triangulated++;
+        }
+    }
+
+    EXPECT_LT(0u, triangulated);
+    EXPECT_EQ(2 * vertices, vertexBuffer.index());
+    ASSERT_GE(65535u, vertexBuffer.index());
+}
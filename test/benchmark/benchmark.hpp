@@ -0,0 +1,32 @@
+#ifndef MBGL_TEST_BENCHMARK
+#define MBGL_TEST_BENCHMARK
+
+#include "../fixtures/util.hpp"
+
+#include <mbgl/util/chrono.hpp>
+
+#include <cstdio>
+#include <string>
+
+namespace mbgl {
+namespace test {
+
+// Runs fn the given number of times and returns the mean time per run in nanoseconds.
+template <typename Fn>
+double benchmark(std::size_t iterations, Fn fn) {
+    const TimePoint start = Clock::now();
+    for (std::size_t i = 0; i < iterations; i++) {
+        fn();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+    return double(elapsed.count()) / iterations;
+}
+
+inline void report(const std::string& name, double value, const char* unit) {
+    std::printf("[ BENCHMARK] %-48s %14.2f %s\n", name.c_str(), value, unit);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "benchmark.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/renderer/fill_bucket.hpp>
+#include <mbgl/renderer/line_bucket.hpp>
+#include <mbgl/geometry/fill_buffer.hpp>
+#include <mbgl/geometry/line_buffer.hpp>
+#include <mbgl/geometry/elements_buffer.hpp>
+#include <mbgl/util/io.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+const std::size_t iterations = 20;
+
+template <typename Bucket>
+void addFeatures(const GeometryTileLayer& layer, FeatureType type, Bucket& bucket) {
+    GeometryBuffer geometry;
+    for (std::size_t i = 0; i < layer.featureCount(); i++) {
+        const auto& feature = layer.getFeature(i);
+        if (feature.getType() == type) {
+            feature.decodeGeometries(geometry);
+            bucket.addGeometry(geometry);
+        }
+    }
+}
+
+// Elements in a buffer, and the elements it has room for.
+struct Usage {
+    template <typename Buffer>
+    void operator=(const Buffer& buffer) {
+        used = buffer.index();
+        allocated = buffer.capacity();
+    }
+
+    std::size_t used = 0;
+    std::size_t allocated = 0;
+};
+
+void report(const std::string& name, const Usage& usage) {
+    test::report(name + ", used", usage.used, "elements");
+    test::report(name + ", allocated", usage.allocated, "elements");
+}
+
+}
+
+TEST(Benchmark, LineBucketBuffers) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("admin");
+    ASSERT_TRUE(bool(layer));
+
+    for (const JoinType join : { JoinType::Miter, JoinType::Round }) {
+        Usage vertices, triangles, points;
+
+        const double duration = test::benchmark(iterations, [&] {
+            LineVertexBuffer vertexBuffer;
+            TriangleElementsBuffer triangleElementsBuffer;
+            PointElementsBuffer pointElementsBuffer;
+
+            LineBucket bucket(vertexBuffer, triangleElementsBuffer, pointElementsBuffer);
+            bucket.layout.join = join;
+            addFeatures(*layer, FeatureType::LineString, bucket);
+
+            vertices = vertexBuffer;
+            triangles = triangleElementsBuffer;
+            points = pointElementsBuffer;
+        });
+
+        ASSERT_LT(0u, vertices.used);
+
+        const std::string name = join == JoinType::Miter ? "Miter joins" : "Round joins";
+        test::report(name, duration / 1e6, "ms");
+        report(name + ", vertices", vertices);
+        report(name + ", triangles", triangles);
+        report(name + ", points", points);
+    }
+}
+
+TEST(Benchmark, FillBucketBuffers) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("water");
+    ASSERT_TRUE(bool(layer));
+
+    Usage vertices, triangles, lines;
+
+    const double duration = test::benchmark(iterations, [&] {
+        FillVertexBuffer vertexBuffer;
+        TriangleElementsBuffer triangleElementsBuffer;
+        LineElementsBuffer lineElementsBuffer;
+
+        FillBucket bucket(vertexBuffer, triangleElementsBuffer, lineElementsBuffer);
+        addFeatures(*layer, FeatureType::Polygon, bucket);
+
+        vertices = vertexBuffer;
+        triangles = triangleElementsBuffer;
+        lines = lineElementsBuffer;
+    });
+
+    ASSERT_LT(0u, vertices.used);
+
+    test::report("Fill", duration / 1e6, "ms");
+    report("Fill, vertices", vertices);
+    report("Fill, triangles", triangles);
+    report("Fill, lines", lines);
+}
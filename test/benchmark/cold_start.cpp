@@ -0,0 +1,143 @@
+#include "benchmark.hpp"
+
+#include <mbgl/storage/sqlite_cache.hpp>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/run_loop.hpp>
+#include <mbgl/util/worker.hpp>
+
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace mbgl;
+
+namespace {
+
+const char* const path = "test/fixtures/database/cold_start.db";
+
+// A map that starts with an empty memory cache reads about this many tiles of each kind from
+// the database for its first frames.
+const std::size_t tileCount = 128;
+const int rasterSize = 256;
+
+void removeDatabase() {
+    mkdir("test/fixtures/database", 0755);
+    unlink(path);
+}
+
+Resource vectorResource(std::size_t i) {
+    return { Resource::Tile, "http://example.com/vector/" + std::to_string(i) + ".pbf" };
+}
+
+Resource rasterResource(std::size_t i) {
+    return { Resource::Tile, "http://example.com/raster/" + std::to_string(i) + ".png" };
+}
+
+// A response the size of a typical vector tile, which compresses about as well as one.
+std::shared_ptr<const Response> vectorResponse(std::size_t i) {
+    auto response = std::make_shared<Response>();
+    response->status = Response::Successful;
+    auto data = std::make_shared<std::string>();
+    data->reserve(32 * 1024);
+    while (data->size() < 32 * 1024) {
+        *data += std::to_string(i * 7919 + data->size());
+    }
+    response->data = std::move(data);
+    return response;
+}
+
+// A PNG with gradients and some detail, which is stored uncompressed.
+std::shared_ptr<const Response> rasterResponse(std::size_t i) {
+    std::vector<uint8_t> rgba(rasterSize * rasterSize * 4);
+    for (int y = 0; y < rasterSize; y++) {
+        for (int x = 0; x < rasterSize; x++) {
+            uint8_t* pixel = &rgba[(y * rasterSize + x) * 4];
+            pixel[0] = x;
+            pixel[1] = y;
+            pixel[2] = (x * y + i) % 251;
+            pixel[3] = 255;
+        }
+    }
+
+    auto response = std::make_shared<Response>();
+    response->status = Response::Successful;
+    response->data = std::make_shared<const std::string>(
+        util::compress_png(rasterSize, rasterSize, rgba.data()));
+    return response;
+}
+
+void createDatabase() {
+    removeDatabase();
+    SQLiteCache cache(path);
+    for (std::size_t i = 0; i < tileCount; i++) {
+        cache.put(vectorResource(i), vectorResponse(i), FileCache::Hint::Full);
+        cache.put(rasterResource(i), rasterResponse(i), FileCache::Hint::Full);
+    }
+}
+
+// Reads all tiles at once from a cache that was just opened and decodes the raster tiles, either
+// on the thread that reads them or on a worker pool. Returns the decoded bytes per second.
+double coldStart(bool decodeOnWorker) {
+    SQLiteCache cache(path);
+    util::RunLoop loop;
+    std::unique_ptr<Worker> worker;
+
+    std::size_t remaining = tileCount * 2;
+    std::size_t bytes = 0;
+    const auto complete = [&](std::size_t size) {
+        bytes += size;
+        if (--remaining == 0) {
+            worker.reset();
+            loop.stop();
+        }
+    };
+
+    const TimePoint start = Clock::now();
+    loop.invoke([&] {
+        if (decodeOnWorker) {
+            worker = util::make_unique<Worker>(loop.get());
+        }
+
+        for (std::size_t i = 0; i < tileCount; i++) {
+            cache.get(vectorResource(i), [&](std::unique_ptr<Response> response) {
+                EXPECT_TRUE(response.get());
+                complete(response ? response->data->size() : 0);
+            });
+
+            cache.get(rasterResource(i), [&](std::unique_ptr<Response> response) {
+                ASSERT_TRUE(response.get());
+                auto data = response->data;
+                if (worker) {
+                    auto image = std::make_shared<std::unique_ptr<util::Image>>();
+                    worker->send([data, image] { *image = util::make_unique<util::Image>(*data); },
+                                 [image, &complete] {
+                                     complete((*image)->getWidth() * (*image)->getHeight() * 4);
+                                 });
+                } else {
+                    util::Image image(*data);
+                    complete(image.getWidth() * image.getHeight() * 4);
+                }
+            });
+        }
+    });
+    loop.run();
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    EXPECT_EQ(0u, remaining);
+    return bytes / seconds;
+}
+
+}
+
+TEST(Benchmark, ColdStartDecode) {
+    createDatabase();
+
+    const double megabyte = 1024 * 1024;
+    test::report("Cold start, raster decoded on reading thread", coldStart(false) / megabyte, "MB/s");
+    test::report("Cold start, raster decoded on worker", coldStart(true) / megabyte, "MB/s");
+
+    removeDatabase();
+}
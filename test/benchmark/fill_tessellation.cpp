@@ -0,0 +1,95 @@
+#include "benchmark.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/renderer/fill_bucket.hpp>
+#include <mbgl/geometry/fill_buffer.hpp>
+#include <mbgl/geometry/elements_buffer.hpp>
+#include <mbgl/util/arena.hpp>
+#include <mbgl/util/io.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+const std::size_t iterations = 20;
+
+// Triangulates all polygons of the layer into a fresh bucket, and returns the number of triangles.
+std::size_t tessellate(const GeometryTileLayer& layer, FillBucket::Triangulation triangulation,
+                       util::Arena* arena = nullptr) {
+    FillVertexBuffer vertexBuffer;
+    TriangleElementsBuffer triangleElementsBuffer;
+    LineElementsBuffer lineElementsBuffer;
+    FillBucket bucket(vertexBuffer, triangleElementsBuffer, lineElementsBuffer, triangulation, arena);
+
+    GeometryBuffer geometry;
+    for (std::size_t i = 0; i < layer.featureCount(); i++) {
+        const auto& feature = layer.getFeature(i);
+        if (feature.getType() == FeatureType::Polygon) {
+            feature.decodeGeometries(geometry);
+            bucket.addGeometry(geometry);
+        }
+    }
+
+    return triangleElementsBuffer.index();
+}
+
+}
+
+TEST(Benchmark, FillTessellation) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("water");
+    ASSERT_TRUE(bool(layer));
+
+    std::size_t libtessTriangles = 0;
+    const double libtess = test::benchmark(iterations, [&] {
+        libtessTriangles = tessellate(*layer, FillBucket::Triangulation::LibTess);
+    });
+
+    std::size_t earcutTriangles = 0;
+    const double earcut = test::benchmark(iterations, [&] {
+        earcutTriangles = tessellate(*layer, FillBucket::Triangulation::Earcut);
+    });
+
+    ASSERT_LT(0u, libtessTriangles);
+    ASSERT_LT(0u, earcutTriangles);
+
+    test::report("Clipper and libtess2", libtessTriangles / (libtess / 1e9), "triangles/s");
+    test::report("Clipper and libtess2, triangles", libtessTriangles, "triangles");
+    test::report("Earcut", earcutTriangles / (earcut / 1e9), "triangles/s");
+    test::report("Earcut, triangles", earcutTriangles, "triangles");
+}
+
+TEST(Benchmark, FillTessellationArena) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("water");
+    ASSERT_TRUE(bool(layer));
+
+    // libtess2 makes many small allocations for every polygon.
+    const double heap = test::benchmark(iterations, [&] {
+        tessellate(*layer, FillBucket::Triangulation::LibTess);
+    });
+
+    // The arena is rewound after every polygon, so it never holds more than the largest one.
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+    std::size_t peakBytes = 0;
+    const double arena = test::benchmark(iterations, [&] {
+        util::Arena scratch;
+        tessellate(*layer, FillBucket::Triangulation::LibTess, &scratch);
+        allocations = scratch.allocations();
+        bytes = scratch.bytes();
+        peakBytes = scratch.peakBytes();
+    });
+
+    // Only the chunk that is kept for reuse is left.
+    EXPECT_GE(std::size_t(64 * 1024), bytes);
+
+    test::report("libtess2 on the heap", heap / 1e6, "ms");
+    test::report("libtess2 in an arena", arena / 1e6, "ms");
+    test::report("libtess2 in an arena, allocations", allocations, "allocations");
+    test::report("libtess2 in an arena, peak", peakBytes / 1024.0, "KB");
+}
@@ -0,0 +1,64 @@
+#include "benchmark.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/style/filter_expression.hpp>
+#include <mbgl/style/filter_expression_private.hpp>
+#include <mbgl/style/filter_program.hpp>
+#include <mbgl/util/io.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+FilterExpression parse(const char * expression) {
+    rapidjson::Document doc;
+    doc.Parse<0>(expression);
+    return parseFilterExpression(doc);
+}
+
+const std::size_t iterations = 20;
+
+}
+
+TEST(Benchmark, FilterProgram) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("admin");
+    ASSERT_TRUE(bool(layer));
+
+    // Filters in the style of the admin layers of the Mapbox Streets styles.
+    const FilterExpression filters[] = {
+        parse("[\"all\", [\"==\", \"admin_level\", 2], [\"==\", \"disputed\", 0], [\"==\", \"maritime\", 0]]"),
+        parse("[\"all\", [\"==\", \"admin_level\", 2], [\"==\", \"disputed\", 1], [\"==\", \"maritime\", 0]]"),
+        parse("[\"all\", [\">=\", \"admin_level\", 3], [\"==\", \"maritime\", 0]]"),
+        parse("[\"all\", [\"in\", \"admin_level\", 2, 4], [\"==\", \"maritime\", 1]]"),
+        parse("[\"any\", [\"==\", \"$type\", \"LineString\"], [\"!in\", \"admin_level\", 2, 3, 4]]"),
+    };
+
+    std::size_t matchedVisitor = 0;
+    const double visitor = test::benchmark(iterations, [&] {
+        for (const auto& filter : filters) {
+            for (std::size_t i = 0; i < layer->featureCount(); i++) {
+                matchedVisitor += evaluate(filter, GeometryTileFeatureExtractor(layer->getFeature(i)));
+            }
+        }
+    });
+
+    std::size_t matchedProgram = 0;
+    const double program = test::benchmark(iterations, [&] {
+        for (const auto& filter : filters) {
+            // Compilation is part of the measurement, as it happens once per bucket and tile.
+            const FilterProgram compiled(filter, *layer);
+            for (std::size_t i = 0; i < layer->featureCount(); i++) {
+                matchedProgram += compiled.evaluate(layer->getFeature(i));
+            }
+        }
+    });
+
+    EXPECT_EQ(matchedVisitor, matchedProgram);
+
+    const double evaluations = layer->featureCount() * (sizeof(filters) / sizeof(filters[0]));
+    test::report("FilterExpression visitor", visitor / evaluations, "ns/feature");
+    test::report("FilterProgram", program / evaluations, "ns/feature");
+}
@@ -0,0 +1,204 @@
+#include "benchmark.hpp"
+
+#include <mbgl/map/map.hpp>
+#include <mbgl/platform/default/headless_view.hpp>
+#include <mbgl/platform/default/headless_display.hpp>
+#include <mbgl/storage/file_source.hpp>
+#include <mbgl/storage/request.hpp>
+#include <mbgl/util/io.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
+using namespace mbgl;
+
+namespace {
+
+const char* const style = R"JSON({
+  "version": 7,
+  "sources": {
+    "streets": {
+      "type": "vector",
+      "tiles": [ "test://tiles/{z}-{x}-{y}.pbf" ],
+      "maxzoom": 14
+    }
+  },
+  "layers": [{
+    "id": "background",
+    "type": "background",
+    "paint": { "background-color": "white" }
+  }, {
+    "id": "water",
+    "type": "fill",
+    "source": "streets",
+    "source-layer": "water",
+    "paint": { "fill-color": "blue" }
+  }, {
+    "id": "roads",
+    "type": "line",
+    "source": "streets",
+    "source-layer": "road",
+    "paint": { "line-color": "black" }
+  }]
+})JSON";
+
+// Answers every tile request with the fixture tile after a fixed delay, the way a distant tile
+// server does. Responses are sent from a thread of its own, like the other file sources do.
+class LatentFileSource : public FileSource {
+public:
+    explicit LatentFileSource(Duration latency_)
+        : latency(latency_),
+          tile(std::make_shared<const std::string>(
+              util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf"))),
+          thread([this] { run(); }) {
+    }
+
+    ~LatentFileSource() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cond.notify_one();
+        thread.join();
+    }
+
+    Request* request(const Resource& resource, uv_loop_t* loop, const Environment& env,
+                     Callback callback) override {
+        auto req = new Request(resource, loop, env, callback);
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.emplace(req, Clock::now() + latency);
+        cond.notify_one();
+        return req;
+    }
+
+    void cancel(Request* req) override {
+        req->cancel();
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.erase(req);
+        req->destruct();
+    }
+
+    void request(const Resource& resource, const Environment& env, Callback callback) override {
+        request(resource, nullptr, env, callback);
+    }
+
+    void abort(const Environment&) override {}
+
+    std::size_t outstanding() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return pending.size();
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            const TimePoint now = Clock::now();
+            TimePoint next = TimePoint::max();
+            for (auto it = pending.begin(); it != pending.end();) {
+                if (it->second <= now) {
+                    it->first->notify(respond(it->first->resource));
+                    it = pending.erase(it);
+                } else {
+                    next = std::min(next, it->second);
+                    ++it;
+                }
+            }
+            if (next == TimePoint::max()) {
+                cond.wait(lock);
+            } else {
+                cond.wait_until(lock, next);
+            }
+        }
+    }
+
+    std::shared_ptr<const Response> respond(const Resource& resource) {
+        auto response = std::make_shared<Response>();
+        if (resource.kind == Resource::Tile) {
+            response->status = Response::Successful;
+            response->data = tile;
+        } else {
+            response->status = Response::Error;
+            response->message = "Not found";
+        }
+        return response;
+    }
+
+    const Duration latency;
+    const std::shared_ptr<const std::string> tile;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::map<Request*, TimePoint> pending;
+    bool stopping = false;
+
+    std::thread thread;
+};
+
+// Records when the map drew its last frame.
+class FrameView : public HeadlessView {
+public:
+    using HeadlessView::HeadlessView;
+
+    void invalidate() override {
+        HeadlessView::invalidate();
+        lastFrame = Clock::now();
+    }
+
+    std::atomic<TimePoint> lastFrame { TimePoint::min() };
+};
+
+// Waits until all requests are answered and the map stopped drawing new frames, which it does
+// as long as it's animating or tiles finish parsing.
+void settle(LatentFileSource& fileSource, FrameView& view) {
+    const auto quiet = std::chrono::milliseconds(300);
+    while (fileSource.outstanding() || Clock::now() - view.lastFrame.load() < quiet) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+// Flies between cities, and returns the mean time from the end of each animation until the
+// map drew the last frame that completed the destination.
+Duration flyTo(bool prefetch) {
+    const LatLng destinations[] = {
+        { 52.52, 13.40 }, { 48.86, 2.35 }, { 40.42, -3.70 }, { 41.90, 12.50 }, { 59.33, 18.07 },
+    };
+    const auto animation = std::chrono::seconds(1);
+
+    auto display = std::make_shared<HeadlessDisplay>();
+    FrameView view(display);
+    LatentFileSource fileSource(std::chrono::milliseconds(300));
+
+    Map map(view, fileSource);
+    map.setPrefetchEnabled(prefetch);
+    view.resize(512, 512, 1);
+    map.start(Map::Mode::Continuous);
+    map.setLatLngZoom({ 0, 0 }, 3);
+    map.setStyleJSON(style, ".");
+    settle(fileSource, view);
+
+    Duration total = Duration::zero();
+    for (const auto& destination : destinations) {
+        const TimePoint end = Clock::now() + animation;
+        map.setLatLngZoom(destination, 10, animation);
+        settle(fileSource, view);
+        total += std::max(Duration::zero(), view.lastFrame.load() - end);
+    }
+
+    map.stop();
+    return total / (sizeof(destinations) / sizeof(destinations[0]));
+}
+
+}
+
+TEST(Benchmark, FlyTo) {
+    const auto ms = [](Duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+
+    test::report("Fly-to, complete frame after animation", ms(flyTo(false)), "ms");
+    test::report("Fly-to with prefetch, complete frame after animation", ms(flyTo(true)), "ms");
+}
@@ -0,0 +1,107 @@
+#include "benchmark.hpp"
+
+#include <mbgl/geometry/glyph_atlas.hpp>
+#include <mbgl/text/glyph_store.hpp>
+#include <mbgl/util/utf.hpp>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+const std::size_t tilesPerThread = 200;
+
+std::vector<SDFGlyph> makeGlyphs() {
+    std::vector<SDFGlyph> glyphs;
+    for (uint32_t id = 32; id < 127; id++) {
+        SDFGlyph glyph;
+        glyph.id = id;
+        glyph.metrics.width = 10;
+        glyph.metrics.height = 14;
+        glyph.metrics.advance = 11;
+        glyph.bitmap = std::string((10 + 6) * (14 + 6), char(id));
+        glyphs.push_back(glyph);
+    }
+    return glyphs;
+}
+
+std::vector<std::u32string> makeLabels() {
+    const char* names[] = {
+        "Atlantic Ocean", "Pacific Ocean", "Mediterranean Sea", "Lake Victoria", "Rio de la Plata",
+        "Gulf of Mexico", "Bay of Bengal", "Caspian Sea", "Lake Baikal", "Hudson Bay",
+        "North Sea", "Baltic Sea", "Coral Sea", "Sea of Japan", "Great Salt Lake",
+    };
+
+    std::vector<std::u32string> labels;
+    util::utf8_to_utf32 ucs4conv;
+    for (const char* name : names) {
+        labels.push_back(ucs4conv.convert(name));
+    }
+    return labels;
+}
+
+// Places every label of a tile, the way SymbolBucket does it, then drops the tile again.
+template <typename Lock>
+void placeTiles(GlyphAtlas& atlas, const FontStack& stack, const std::vector<std::u32string>& labels,
+                uintptr_t firstTile, Lock lock) {
+    for (uintptr_t tile = firstTile; tile < firstTile + tilesPerThread * 16; tile += 16) {
+        for (const auto& label : labels) {
+            GlyphPositions face;
+            lock([&] {
+                stack.getShaping(label, 10 * 24, 1.2 * 24, 0.5, 0.5, 0.5, 0, { 0, 0 });
+                atlas.addGlyphs(tile, label, stack, face);
+            });
+        }
+        lock([&] { atlas.removeGlyphs(tile); });
+    }
+}
+
+}
+
+TEST(Benchmark, GlyphAtlasContention) {
+    FontStack stack(0);
+    stack.insert(makeGlyphs());
+    const std::vector<std::u32string> labels = makeLabels();
+
+    GlyphAtlas atlas(1024, 1024);
+
+    // A tile that stays around keeps all glyphs in the texture, as the tiles in view do.
+    for (const auto& label : labels) {
+        GlyphPositions face;
+        atlas.addGlyphs(1, label, stack, face);
+    }
+
+    // Serializing every call on one mutex approximates the previous implementation, which held
+    // the glyph store and glyph atlas locks for the entire placement.
+    std::mutex global;
+    auto serialized = [&](const std::function<void()>& fn) {
+        std::lock_guard<std::mutex> lock(global);
+        fn();
+    };
+    auto concurrent = [](const std::function<void()>& fn) { fn(); };
+
+    for (std::size_t threads : { 1, 2, 4, 8 }) {
+        const double labelCount = double(threads * tilesPerThread * labels.size());
+
+        auto run = [&](const std::function<void(const std::function<void()>&)>& lock) {
+            return test::benchmark(1, [&] {
+                std::vector<std::thread> workers;
+                for (std::size_t i = 0; i < threads; i++) {
+                    workers.emplace_back([&, i] {
+                        placeTiles(atlas, stack, labels, 0x1000 * (i + 1), lock);
+                    });
+                }
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+            }) / labelCount;
+        };
+
+        const std::string suffix = " (" + std::to_string(threads) + " workers)";
+        test::report("GlyphAtlas global lock" + suffix, run(serialized), "ns/label");
+        test::report("GlyphAtlas lock-free lookup" + suffix, run(concurrent), "ns/label");
+    }
+}
@@ -0,0 +1,69 @@
+#include "benchmark.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/renderer/line_bucket.hpp>
+#include <mbgl/geometry/line_buffer.hpp>
+#include <mbgl/geometry/elements_buffer.hpp>
+#include <mbgl/util/io.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+const std::size_t iterations = 20;
+
+}
+
+TEST(Benchmark, LineSimplify) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("admin");
+    ASSERT_TRUE(bool(layer));
+
+    // Half a pixel of a 512 and a 256 pixel tile that is drawn up to twice its size, and a
+    // tile from the source's maximum zoom level that is overzoomed by four levels.
+    const std::vector<std::pair<std::string, double>> tolerances = {
+        { "Full resolution", 0 },
+        { "512 pixel tiles", 0.5 * 4096 / 512 / 2 },
+        { "256 pixel tiles", 0.5 * 4096 / 256 / 2 },
+        { "Overzoomed 512 pixel tiles", 0.5 * 4096 / 512 / 16 },
+    };
+
+    std::size_t fullVertices = 0;
+
+    for (const auto& tolerance : tolerances) {
+        std::size_t vertices = 0;
+
+        const double duration = test::benchmark(iterations, [&] {
+            LineVertexBuffer vertexBuffer;
+            TriangleElementsBuffer triangleElementsBuffer;
+            PointElementsBuffer pointElementsBuffer;
+
+            LineBucket bucket(vertexBuffer, triangleElementsBuffer, pointElementsBuffer);
+            bucket.layout.simplify = true;
+            bucket.tolerance = tolerance.second;
+
+            GeometryBuffer geometry;
+            for (std::size_t i = 0; i < layer->featureCount(); i++) {
+                const auto& feature = layer->getFeature(i);
+                if (feature.getType() == FeatureType::LineString) {
+                    feature.decodeGeometries(geometry);
+                    bucket.addGeometry(geometry);
+                }
+            }
+
+            vertices = vertexBuffer.index();
+        });
+
+        if (!fullVertices) {
+            fullVertices = vertices;
+        }
+
+        ASSERT_LT(0u, vertices);
+        ASSERT_LE(vertices, fullVertices);
+
+        test::report(tolerance.first, duration / 1e6, "ms");
+        test::report(tolerance.first + ", vertices", vertices, "vertices");
+    }
+}
@@ -0,0 +1,67 @@
+#include "benchmark.hpp"
+
+#include <mbgl/map/map.hpp>
+#include <mbgl/map/still_image.hpp>
+#include <mbgl/platform/default/headless_view.hpp>
+#include <mbgl/platform/default/headless_display.hpp>
+#include <mbgl/storage/default_file_source.hpp>
+#include <mbgl/util/image.hpp>
+#include <mbgl/util/io.hpp>
+
+#include <future>
+
+using namespace mbgl;
+
+namespace {
+
+const std::size_t jobCount = 20;
+
+// All jobs stay within the single fixture tile, but move the camera the way consecutive
+// requests to a static map service do.
+void renderJob(Map& map, HeadlessView& view, std::size_t job) {
+    view.resize(256, 256, 1);
+    map.setLatLngZoom({ double(job % 5) * 10, double(job % 7) * 20 }, double(job % 10) / 10);
+    map.setBearing(double(job % 4) * 90);
+
+    std::promise<std::unique_ptr<const StillImage>> promise;
+    map.renderStill([&promise](std::unique_ptr<const StillImage> image) {
+        promise.set_value(std::move(image));
+    });
+    auto image = promise.get_future().get();
+    util::compress_png(image->width, image->height, image->pixels.get());
+}
+
+}
+
+TEST(Benchmark, RenderBatch) {
+    const auto style = util::read_file("test/fixtures/api/water.json");
+    auto display = std::make_shared<HeadlessDisplay>();
+
+    // Sets up the GL context, the worker threads and the file source for every image, as an
+    // invocation of mbgl-render per image does.
+    std::size_t job = 0;
+    const double perProcess = test::benchmark(jobCount, [&] {
+        HeadlessView view(display);
+        DefaultFileSource fileSource(nullptr);
+        Map map(view, fileSource);
+        map.start(Map::Mode::Static);
+        map.setStyleJSON(style, ".");
+        renderJob(map, view, job++);
+        map.stop();
+    });
+
+    // Reuses the map, and with it the loaded tiles, for all images, as mbgl-render --batch does.
+    HeadlessView view(display);
+    DefaultFileSource fileSource(nullptr);
+    Map map(view, fileSource);
+    map.start(Map::Mode::Static);
+    map.setStyleJSON(style, ".");
+    job = 0;
+    const double batch = test::benchmark(jobCount, [&] {
+        renderJob(map, view, job++);
+    });
+    map.stop();
+
+    test::report("Render per process", 1e9 / perProcess, "images/s");
+    test::report("Render batch", 1e9 / batch, "images/s");
+}
@@ -0,0 +1,151 @@
+#include "benchmark.hpp"
+
+#include <mbgl/map/metrics.hpp>
+#include <mbgl/storage/sqlite_cache.hpp>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace mbgl;
+
+namespace {
+
+const char* const path = "test/fixtures/database/benchmark.db";
+const std::size_t putCount = 500;
+const std::size_t getCount = 200;
+
+// Puts per second while reading, about as many as a map loading tiles from the network makes.
+const std::size_t writeRate = 100;
+
+struct Config {
+    const char* name;
+    std::size_t batchSize;
+    bool writeAheadLog;
+};
+
+const Config configs[] = {
+    { "autocommit", 1, false },
+    { "autocommit, WAL", 1, true },
+    { "batched", 64, false },
+    { "batched, WAL", 64, true },
+};
+
+void removeDatabase() {
+    mkdir("test/fixtures/database", 0755);
+    unlink(path);
+    unlink((std::string(path) + "-wal").c_str());
+    unlink((std::string(path) + "-shm").c_str());
+}
+
+std::unique_ptr<SQLiteCache> openCache(const Config& config) {
+    auto cache = util::make_unique<SQLiteCache>(path);
+    cache->setWriteAheadLog(config.writeAheadLog);
+    cache->setWriteBatch(config.batchSize, std::chrono::milliseconds(100));
+    return cache;
+}
+
+// A response the size of a typical vector tile, which compresses about as well as one.
+std::shared_ptr<const Response> tileResponse(std::size_t i) {
+    auto response = std::make_shared<Response>();
+    response->status = Response::Successful;
+    response->expires = i;
+    auto data = std::make_shared<std::string>();
+    data->reserve(32 * 1024);
+    while (data->size() < 32 * 1024) {
+        *data += std::to_string(i * 7919 + data->size());
+    }
+    response->data = std::move(data);
+    return response;
+}
+
+Resource tileResource(std::size_t i) {
+    return { Resource::Tile, "http://example.com/tiles/" + std::to_string(i) + ".pbf" };
+}
+
+}
+
+TEST(Benchmark, SQLiteCachePut) {
+    for (const auto& config : configs) {
+        removeDatabase();
+
+        std::vector<std::shared_ptr<const Response>> responses;
+        for (std::size_t i = 0; i < putCount; i++) {
+            responses.emplace_back(tileResponse(i));
+        }
+
+        auto cache = openCache(config);
+        const TimePoint start = Clock::now();
+        for (std::size_t i = 0; i < putCount; i++) {
+            cache->put(tileResource(i), responses[i], FileCache::Hint::Full);
+        }
+        // Waits until all responses are stored.
+        cache.reset();
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        test::report(std::string("SQLiteCache put, ") + config.name, putCount / seconds, "puts/s");
+    }
+
+    removeDatabase();
+}
+
+TEST(Benchmark, SQLiteCacheGetUnderLoad) {
+    for (const auto& config : configs) {
+        removeDatabase();
+
+        auto cache = openCache(config);
+        for (std::size_t i = 0; i < getCount; i++) {
+            cache->put(tileResource(i), tileResponse(i), FileCache::Hint::Full);
+        }
+
+        // Writes new tiles for as long as tiles are read.
+        std::atomic<bool> reading(true);
+        std::thread writer([&] {
+            for (std::size_t i = getCount; reading; i++) {
+                cache->put(tileResource(i), tileResponse(i), FileCache::Hint::Full);
+                std::this_thread::sleep_for(std::chrono::microseconds(1000000 / writeRate));
+            }
+        });
+
+        // Reads the tiles one after another, as tiles are requested when a map is loading.
+        Histogram latency;
+        util::RunLoop loop;
+        std::size_t i = 0;
+        TimePoint requested;
+        std::function<void()> next = [&] {
+            if (i == getCount) {
+                loop.stop();
+                return;
+            }
+            requested = Clock::now();
+            cache->get(tileResource(i++), [&](std::unique_ptr<Response> response) {
+                EXPECT_TRUE(response.get());
+                // The first read waits for the tiles above to be stored.
+                if (i > 1) {
+                    latency.record(Clock::now() - requested);
+                }
+                next();
+            });
+        };
+        loop.invoke([&] { next(); });
+        loop.run();
+
+        reading = false;
+        writer.join();
+        cache.reset();
+
+        const auto ms = [](Duration duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        };
+        test::report(std::string("SQLiteCache get under load, ") + config.name + ", mean", ms(latency.mean()), "ms");
+        test::report(std::string("SQLiteCache get under load, ") + config.name + ", p99", ms(latency.quantile(0.99)), "ms");
+    }
+
+    removeDatabase();
+}
@@ -19,6 +19,7 @@
 #include <uv.h>
 
 #include <dirent.h>
+#include <future>
 
 void rewriteLocalScheme(rapidjson::Value &value, rapidjson::Document::AllocatorType &allocator) {
     ASSERT_TRUE(value.IsString());
@@ -181,10 +182,57 @@ TEST_P(HeadlessTest, render) {
         // This loop will terminate once the async was fired.
         uv_run(uv_default_loop(), UV_RUN_DEFAULT);
 
+        // Every frame reports the GL calls it took.
+        const MapMetrics metrics = map.getMetrics();
+        EXPECT_LT(0u, metrics.frames);
+        EXPECT_LT(0u, metrics.lastFrameGLCalls);
+        EXPECT_LE(metrics.lastFrameGLCalls, metrics.glCalls);
+
         map.stop();
     }
 }
 
+// Renders a still image of the style, and returns the metrics of the map that rendered it.
+mbgl::MapMetrics renderMetrics(std::shared_ptr<mbgl::HeadlessDisplay> display, const std::string& style) {
+    using namespace mbgl;
+
+    HeadlessView view(display);
+    DefaultFileSource fileSource(nullptr);
+    Map map(view, fileSource);
+
+    map.start(Map::Mode::Static);
+
+    view.resize(256, 256, 1);
+    map.setStyleJSON(style, "test/suite");
+
+    std::promise<std::unique_ptr<const StillImage>> promise;
+    map.renderStill([&promise](std::unique_ptr<const StillImage> image) {
+        promise.set_value(std::move(image));
+    });
+    promise.get_future().get();
+
+    const MapMetrics metrics = map.getMetrics();
+    map.stop();
+    return metrics;
+}
+
+TEST(Headless, GLCalls) {
+    using namespace mbgl;
+
+    auto display = std::make_shared<HeadlessDisplay>();
+
+    const MapMetrics water = renderMetrics(display, util::read_file("test/fixtures/api/water.json"));
+    const MapMetrics below = renderMetrics(display, util::read_file("test/fixtures/headless/water_below.json"));
+    ASSERT_EQ(1u, water.frames);
+    ASSERT_EQ(1u, below.frames);
+
+    // Both styles cover a single tile. The second one adds an opaque fill without antialiasing
+    // below the water. It draws in the opaque pass only, with the program and stencil function
+    // of the water fill, so it costs a depth range change and its draw. Visiting its tile in the
+    // translucent pass costs nothing.
+    EXPECT_EQ(water.lastFrameGLCalls + 2, below.lastFrameGLCalls);
+}
+
 INSTANTIATE_TEST_CASE_P(Headless, HeadlessTest, ::testing::ValuesIn([] {
     std::vector<std::string> names;
 
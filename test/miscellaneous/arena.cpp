@@ -0,0 +1,103 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/util/arena.hpp>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace mbgl;
+
+TEST(Arena, Allocate) {
+    util::Arena arena(1024);
+    EXPECT_EQ(0u, arena.chunks());
+
+    // Allocations are aligned for any type, and share chunks.
+    void* a = arena.allocate(1);
+    void* b = arena.allocate(3);
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(a) % alignof(std::max_align_t));
+    EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(b) % alignof(std::max_align_t));
+    EXPECT_NE(a, b);
+    EXPECT_EQ(2u, arena.allocations());
+    EXPECT_EQ(1u, arena.chunks());
+    EXPECT_EQ(1024u, arena.bytes());
+
+    // Allocations larger than a chunk get one of their own.
+    std::memset(arena.allocate(4096), 0, 4096);
+    EXPECT_EQ(2u, arena.chunks());
+
+    // The next allocation doesn't fit into what's left of it.
+    arena.allocate(1);
+    EXPECT_EQ(3u, arena.chunks());
+}
+
+TEST(Arena, Reallocate) {
+    util::Arena arena(1024);
+
+    // The most recent allocation grows in place.
+    char* a = static_cast<char*>(arena.reallocate(nullptr, 4));
+    std::memcpy(a, "abc", 4);
+    EXPECT_EQ(a, arena.reallocate(a, 64));
+    EXPECT_STREQ("abc", a);
+
+    // Others are copied.
+    char* b = static_cast<char*>(arena.allocate(4));
+    char* c = static_cast<char*>(arena.reallocate(a, 128));
+    EXPECT_NE(a, c);
+    EXPECT_NE(b, c);
+    EXPECT_STREQ("abc", c);
+
+    // Shrinking never moves.
+    EXPECT_EQ(a, arena.reallocate(a, 2));
+    EXPECT_EQ(5u, arena.allocations());
+}
+
+TEST(Arena, Deallocate) {
+    util::Arena arena(1024);
+
+    // The most recent allocation is reused right away.
+    void* a = arena.allocate(16);
+    arena.deallocate(a);
+    EXPECT_EQ(a, arena.allocate(16));
+
+    // Others only when the arena is gone.
+    void* b = arena.allocate(16);
+    arena.deallocate(a);
+    EXPECT_NE(a, arena.allocate(16));
+    EXPECT_NE(b, a);
+    EXPECT_EQ(1u, arena.chunks());
+}
+
+TEST(Arena, Rewind) {
+    util::Arena arena(1024);
+
+    void* a = arena.allocate(16);
+    const util::Arena::Mark mark = arena.mark();
+
+    // Everything allocated after the mark is given back, including chunks added for it.
+    void* b = arena.allocate(16);
+    arena.allocate(4096);
+    EXPECT_EQ(2u, arena.chunks());
+    const std::size_t bytes = arena.bytes();
+    EXPECT_LT(1024u + 4096u, bytes);
+
+    arena.rewind(mark);
+    EXPECT_EQ(1u, arena.chunks());
+    EXPECT_EQ(1024u, arena.bytes());
+    EXPECT_EQ(bytes, arena.peakBytes());
+    EXPECT_EQ(b, arena.allocate(16));
+
+    // Allocations from before the mark stay valid.
+    EXPECT_NE(a, b);
+    std::memset(a, 0, 16);
+
+    // Rewinding to an empty arena keeps one regular chunk for the next allocation.
+    util::Arena empty(1024);
+    const util::Arena::Mark start = empty.mark();
+    void* c = empty.allocate(16);
+    empty.rewind(start);
+    EXPECT_EQ(0u, empty.chunks());
+    EXPECT_EQ(1024u, empty.bytes());
+    EXPECT_EQ(c, empty.allocate(16));
+    EXPECT_EQ(1u, empty.chunks());
+    EXPECT_EQ(1024u, empty.bytes());
+}
@@ -0,0 +1,110 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/geometry/earcut.hpp>
+
+#include <cmath>
+
+using namespace mbgl;
+
+namespace {
+
+typedef std::vector<ClipperLib::Path> Polygon;
+
+// Twice the area covered by the triangles, looked up in the concatenated rings.
+double triangleArea(const Polygon& polygon, const std::vector<uint32_t>& indices, uint32_t offset = 0) {
+    ClipperLib::Path points;
+    for (const auto& ring : polygon) {
+        points.insert(points.end(), ring.begin(), ring.end());
+    }
+
+    double area = 0;
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        const auto& a = points.at(indices[i] - offset);
+        const auto& b = points.at(indices[i + 1] - offset);
+        const auto& c = points.at(indices[i + 2] - offset);
+        area += std::abs(double(b.X - a.X) * double(c.Y - a.Y) - double(c.X - a.X) * double(b.Y - a.Y));
+    }
+    return area;
+}
+
+// A regular polygon with the given number of vertices, with every other vertex pulled inwards.
+ClipperLib::Path star(std::size_t vertices, double radius, bool reverse = false) {
+    ClipperLib::Path ring;
+    for (std::size_t i = 0; i < vertices; i++) {
+        const double angle = 2 * M_PI * (reverse ? vertices - i : i) / vertices;
+        const double r = i % 2 ? radius * 0.8 : radius;
+        ring.emplace_back(std::round(r * std::cos(angle)), std::round(r * std::sin(angle)));
+    }
+    return ring;
+}
+
+}
+
+TEST(Earcut, Square) {
+    const Polygon polygon = {{ { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } }};
+
+    Earcut earcut;
+    std::vector<uint32_t> indices;
+    ASSERT_TRUE(earcut(polygon.begin(), polygon.end(), 0, indices));
+    EXPECT_EQ(6u, indices.size());
+    EXPECT_DOUBLE_EQ(200, triangleArea(polygon, indices));
+}
+
+TEST(Earcut, Hole) {
+    const Polygon polygon = {
+        { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } },
+        { { 2, 2 }, { 2, 8 }, { 8, 8 }, { 8, 2 } },
+    };
+
+    // Vertices are numbered from the offset on, and earlier triangles are kept.
+    Earcut earcut;
+    std::vector<uint32_t> indices = { 1, 2, 3 };
+    ASSERT_TRUE(earcut(polygon.begin(), polygon.end(), 10, indices));
+    EXPECT_EQ(3u + 8 * 3, indices.size());
+    indices.erase(indices.begin(), indices.begin() + 3);
+    EXPECT_DOUBLE_EQ(2 * (100 - 36), triangleArea(polygon, indices, 10));
+}
+
+TEST(Earcut, HashedConcave) {
+    // Large polygons are triangulated with the help of the z-order hash.
+    const Polygon polygon = { star(200, 4000), star(100, 1000, true) };
+
+    Earcut earcut;
+    std::vector<uint32_t> indices;
+    ASSERT_TRUE(earcut(polygon.begin(), polygon.end(), 0, indices));
+    EXPECT_EQ(3u * (200 + 100), indices.size());
+    EXPECT_DOUBLE_EQ(std::abs(ClipperLib::Area(polygon[0])) * 2 - std::abs(ClipperLib::Area(polygon[1])) * 2,
+                     triangleArea(polygon, indices));
+}
+
+TEST(Earcut, Degenerate) {
+    // Repeated and collinear points don't produce any triangles.
+    const Polygon polygon = {{ { 0, 0 }, { 5, 0 }, { 5, 0 }, { 10, 0 } }};
+
+    Earcut earcut;
+    std::vector<uint32_t> indices;
+    EXPECT_TRUE(earcut(polygon.begin(), polygon.end(), 0, indices));
+    EXPECT_TRUE(indices.empty());
+}
+
+TEST(Earcut, SelfIntersection) {
+    // A bow tie is left to libtess2.
+    const Polygon polygon = {{ { 0, 0 }, { 10, 10 }, { 10, 0 }, { 0, 10 } }};
+
+    Earcut earcut;
+    std::vector<uint32_t> indices = { 1, 2, 3 };
+    EXPECT_FALSE(earcut(polygon.begin(), polygon.end(), 0, indices));
+    EXPECT_EQ((std::vector<uint32_t> { 1, 2, 3 }), indices);
+}
+
+TEST(Earcut, HoleOutside) {
+    const Polygon polygon = {
+        { { 0, 0 }, { 10, 0 }, { 10, 10 }, { 0, 10 } },
+        { { 12, 2 }, { 12, 8 }, { 18, 8 }, { 18, 2 } },
+    };
+
+    Earcut earcut;
+    std::vector<uint32_t> indices;
+    EXPECT_FALSE(earcut(polygon.begin(), polygon.end(), 0, indices));
+    EXPECT_TRUE(indices.empty());
+}
@@ -0,0 +1,78 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/map/live_tile.hpp>
+#include <mbgl/style/filter_expression.hpp>
+#include <mbgl/style/filter_program.hpp>
+#include <mbgl/util/io.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+FilterExpression parse(const char * expression) {
+    rapidjson::Document doc;
+    doc.Parse<0>(expression);
+    return parseFilterExpression(doc);
+}
+
+const char * filters[] = {
+    "[\"==\", \"admin_level\", 2]",
+    "[\"!=\", \"admin_level\", 2]",
+    "[\"<\", \"admin_level\", 3]",
+    "[\"<=\", \"admin_level\", 3]",
+    "[\">\", \"admin_level\", 2]",
+    "[\">=\", \"admin_level\", 4]",
+    "[\"in\", \"admin_level\", 2, 4, 6]",
+    "[\"!in\", \"admin_level\", 2, 4, 6]",
+    "[\"==\", \"does-not-exist\", 2]",
+    "[\"!=\", \"does-not-exist\", 2]",
+    "[\"==\", \"$type\", \"LineString\"]",
+    "[\"!=\", \"$type\", \"Polygon\"]",
+    "[\"any\"]",
+    "[\"all\"]",
+    "[\"none\"]",
+    "[\"all\", [\"==\", \"admin_level\", 2], [\"==\", \"maritime\", 0]]",
+    "[\"any\", [\"==\", \"admin_level\", 4], [\"==\", \"disputed\", 1], [\"==\", \"maritime\", 1]]",
+    "[\"none\", [\"==\", \"admin_level\", 4], [\"==\", \"maritime\", 1]]",
+    "[\"all\", [\"any\", [\"==\", \"admin_level\", 2], [\"none\", [\"==\", \"maritime\", 1]]], [\"!in\", \"disputed\", 1]]",
+};
+
+}
+
+TEST(FilterProgram, VectorTile) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("admin");
+    ASSERT_TRUE(bool(layer));
+
+    for (const char * filter : filters) {
+        const FilterExpression expression = parse(filter);
+        const FilterProgram program(expression, *layer);
+
+        for (std::size_t i = 0; i < layer->featureCount(); i++) {
+            const auto& feature = layer->getFeature(i);
+            const bool expected = evaluate(expression, GeometryTileFeatureExtractor(feature));
+            ASSERT_EQ(expected, program.evaluate(feature)) << filter << " on feature " << i;
+        }
+    }
+}
+
+TEST(FilterProgram, LiveTile) {
+    LiveTileLayer layer;
+    layer.addFeature(std::make_shared<const LiveTileFeature>(FeatureType::Point, GeometryCollection(),
+                                                             std::map<std::string, std::string> {{ "sprite", "default_marker" }}));
+    layer.addFeature(std::make_shared<const LiveTileFeature>(FeatureType::LineString, GeometryCollection(),
+                                                             std::map<std::string, std::string> {{ "sprite", "park" }}));
+
+    const FilterExpression marker = parse("[\"==\", \"sprite\", \"default_marker\"]");
+    const FilterProgram markerProgram(marker, layer);
+    EXPECT_TRUE(markerProgram.evaluate(layer.getFeature(0)));
+    EXPECT_FALSE(markerProgram.evaluate(layer.getFeature(1)));
+
+    const FilterExpression type = parse("[\"any\", [\"==\", \"$type\", \"LineString\"], [\"in\", \"sprite\", \"none\"]]");
+    const FilterProgram typeProgram(type, layer);
+    EXPECT_FALSE(typeProgram.evaluate(layer.getFeature(0)));
+    EXPECT_TRUE(typeProgram.evaluate(layer.getFeature(1)));
+}
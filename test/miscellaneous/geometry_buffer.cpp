@@ -0,0 +1,65 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/util/io.hpp>
+
+using namespace mbgl;
+
+TEST(GeometryBuffer, MatchesGeometryCollection) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("water");
+    ASSERT_TRUE(bool(layer));
+
+    GeometryBuffer buffer;
+    for (std::size_t i = 0; i < layer->featureCount(); i++) {
+        const auto& feature = layer->getFeature(i);
+        const GeometryCollection expected = feature.getGeometries();
+
+        feature.decodeGeometries(buffer);
+        ASSERT_EQ(expected.size(), buffer.lineCount());
+        for (std::size_t j = 0; j < expected.size(); j++) {
+            const auto line = buffer.line(j);
+            ASSERT_EQ(expected[j].size(), line.size());
+            for (std::size_t k = 0; k < line.size(); k++) {
+                EXPECT_EQ(expected[j][k].x, line[k].x);
+                EXPECT_EQ(expected[j][k].y, line[k].y);
+            }
+        }
+    }
+}
+
+TEST(GeometryBuffer, NoReallocationsInSteadyState) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("admin");
+    ASSERT_TRUE(bool(layer));
+
+    GeometryBuffer buffer;
+    std::size_t points = 0;
+
+    // The first pass grows the buffer to the size of the largest feature.
+    for (std::size_t i = 0; i < layer->featureCount(); i++) {
+        layer->getFeature(i).decodeGeometries(buffer);
+    }
+
+    const Coordinate* pointData = buffer.points.data();
+    const uint32_t* endData = buffer.ends.data();
+    const std::size_t pointCapacity = buffer.points.capacity();
+    const std::size_t endCapacity = buffer.ends.capacity();
+
+    // Decoding a feature only clears the buffer, so it never needs to reallocate again.
+    for (std::size_t i = 0; i < layer->featureCount(); i++) {
+        layer->getFeature(i).decodeGeometries(buffer);
+        points += buffer.points.size();
+
+        ASSERT_EQ(pointData, buffer.points.data());
+        ASSERT_EQ(endData, buffer.ends.data());
+        ASSERT_EQ(pointCapacity, buffer.points.capacity());
+        ASSERT_EQ(endCapacity, buffer.ends.capacity());
+    }
+
+    EXPECT_GT(points, 0u);
+}
@@ -0,0 +1,114 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/geometry/glyph_atlas.hpp>
+#include <mbgl/text/glyph_store.hpp>
+
+#include <array>
+#include <thread>
+#include <vector>
+
+using namespace mbgl;
+
+namespace {
+
+// A glyph of this size takes up a 20x20 region in the atlas, including padding.
+SDFGlyph makeGlyph(uint32_t id) {
+    SDFGlyph glyph;
+    glyph.id = id;
+    glyph.metrics.width = 10;
+    glyph.metrics.height = 10;
+    glyph.metrics.advance = 10;
+    glyph.bitmap = std::string(16 * 16, char(id));
+    return glyph;
+}
+
+}
+
+TEST(GlyphAtlas, FontStackLookup) {
+    FontStack stack(0);
+    EXPECT_EQ(nullptr, stack.getGlyph('A'));
+
+    stack.insert({ makeGlyph('A') });
+    const SDFGlyph* a = stack.getGlyph('A');
+    ASSERT_NE(nullptr, a);
+    EXPECT_EQ(uint32_t('A'), a->id);
+    EXPECT_EQ(nullptr, stack.getGlyph('B'));
+
+    // Republishing a block keeps previously returned glyphs alive.
+    stack.insert({ makeGlyph('B') });
+    EXPECT_EQ(uint32_t('A'), a->id);
+    ASSERT_NE(nullptr, stack.getGlyph('B'));
+    EXPECT_EQ(uint32_t('B'), stack.getGlyph('B')->id);
+
+    // Glyph ranges only cover the BMP.
+    stack.insert({ makeGlyph(0x1F600) });
+    EXPECT_EQ(nullptr, stack.getGlyph(0x1F600));
+}
+
+TEST(GlyphAtlas, SharedGlyphsAreReleasedByTheLastTile) {
+    FontStack stack(0);
+    stack.insert({ makeGlyph('A'), makeGlyph('B') });
+
+    // Only fits a single glyph.
+    GlyphAtlas atlas(20, 20);
+
+    GlyphPositions first, second;
+    atlas.addGlyphs(1, U"AA", stack, first);
+    atlas.addGlyphs(2, U"A", stack, second);
+    ASSERT_EQ(1u, first.size());
+    EXPECT_EQ(20, first.at('A').rect.w);
+    EXPECT_EQ(first.at('A').rect.x, second.at('A').rect.x);
+    EXPECT_EQ(first.at('A').rect.y, second.at('A').rect.y);
+
+    // There's no space left for another glyph while a tile uses the first one.
+    atlas.removeGlyphs(1);
+    GlyphPositions third;
+    atlas.addGlyphs(3, U"B", stack, third);
+    EXPECT_EQ(0, third.at('B').rect.w);
+
+    atlas.removeGlyphs(2);
+    atlas.removeGlyphs(3);
+    GlyphPositions fourth;
+    atlas.addGlyphs(4, U"B", stack, fourth);
+    EXPECT_EQ(20, fourth.at('B').rect.w);
+}
+
+TEST(GlyphAtlas, ConcurrentPlacement) {
+    FontStack stack(0);
+    std::vector<SDFGlyph> glyphs;
+    std::u32string text;
+    for (uint32_t id = 'A'; id <= 'Z'; id++) {
+        glyphs.push_back(makeGlyph(id));
+        text += char32_t(id);
+    }
+    stack.insert(glyphs);
+
+    // Fits all glyphs exactly once, so any glyph that is allocated twice overflows.
+    GlyphAtlas atlas(20 * 26, 20);
+
+    std::vector<std::thread> threads;
+    std::array<bool, 8> consistent;
+    consistent.fill(true);
+    for (std::size_t i = 0; i < consistent.size(); i++) {
+        threads.emplace_back([&, i] {
+            for (uintptr_t tile = 16 * (i + 1); tile < 100000; tile += 16 * consistent.size()) {
+                GlyphPositions face;
+                atlas.addGlyphs(tile, text, stack, face);
+                for (const auto& glyph : face) {
+                    if (glyph.second.rect.w != 20) {
+                        consistent[i] = false;
+                    }
+                }
+                atlas.removeGlyphs(tile);
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (bool result : consistent) {
+        EXPECT_TRUE(result);
+    }
+}
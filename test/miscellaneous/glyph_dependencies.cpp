@@ -0,0 +1,156 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/environment.hpp>
+#include <mbgl/map/source.hpp>
+#include <mbgl/map/sprite.hpp>
+#include <mbgl/map/vector_tile_data.hpp>
+#include <mbgl/geometry/glyph_atlas.hpp>
+#include <mbgl/geometry/sprite_atlas.hpp>
+#include <mbgl/storage/file_source.hpp>
+#include <mbgl/style/style.hpp>
+#include <mbgl/style/style_layer.hpp>
+#include <mbgl/text/glyph_store.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/worker.hpp>
+
+#include <uv.h>
+
+#include <list>
+
+using namespace mbgl;
+
+namespace {
+
+// Holds on to all requests until the test answers them.
+class StubFileSource : public FileSource {
+public:
+    Request* request(const Resource& resource, uv_loop_t*, const Environment&, Callback callback) override {
+        pending.emplace_back(resource, callback);
+        return nullptr;
+    }
+
+    void cancel(Request*) override {}
+
+    void request(const Resource& resource, const Environment&, Callback callback) override {
+        pending.emplace_back(resource, callback);
+    }
+
+    void abort(const Environment&) override {}
+
+    // Answers all pending requests of the given kind and returns their number.
+    std::size_t respond(Resource::Kind kind, const std::string& data) {
+        std::vector<Callback> callbacks;
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (it->first.kind == kind) {
+                callbacks.push_back(it->second);
+                it = pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        Response res;
+        res.status = Response::Successful;
+        res.data = std::make_shared<const std::string>(data);
+        for (const auto& callback : callbacks) {
+            callback(res);
+        }
+
+        return callbacks.size();
+    }
+
+private:
+    std::list<std::pair<Resource, Callback>> pending;
+};
+
+util::ptr<Style> loadStyle(const std::string& layers) {
+    const std::string json = R"({
+        "version": 7,
+        "sources": { "mapbox": { "type": "vector", "tiles": [ "test://{z}/{x}/{y}" ] } },
+        "layers": )" + layers + "}";
+
+    auto style = std::make_shared<Style>();
+    style->loadJSON(reinterpret_cast<const uint8_t*>(json.c_str()));
+    return style;
+}
+
+}
+
+TEST(GlyphDependencies, ParsingContinuesWhileGlyphsArePending) {
+    StubFileSource fileSource;
+    Environment env(fileSource);
+    EnvironmentScope scope(env, ThreadType::Map, "Map");
+
+    // With a single thread, a tile that blocks on its glyphs would stall all other tiles.
+    Worker worker(env.loop, 1);
+
+    std::size_t glyphCallbacks = 0;
+    GlyphStore glyphStore(env, [&] { glyphCallbacks++; });
+    glyphStore.setURL("test://{fontstack}/{range}");
+
+    GlyphAtlas glyphAtlas(1024, 1024);
+    SpriteAtlas spriteAtlas(512, 512);
+    util::ptr<Sprite> sprite = Sprite::Create("", 1, env, worker);
+
+    SourceInfo info;
+    info.tiles = { "test://{z}/{x}/{y}" };
+
+    util::ptr<Style> labelStyle = loadStyle(R"([{
+        "id": "water_label",
+        "type": "symbol",
+        "source": "mapbox",
+        "source-layer": "water",
+        "layout": { "text-field": "{osm_id}", "text-font": "Open Sans Regular" }
+    }])");
+
+    util::ptr<Style> shapeStyle = loadStyle(R"([{
+        "id": "water",
+        "type": "fill",
+        "source": "mapbox",
+        "source-layer": "water"
+    }, {
+        "id": "admin",
+        "type": "line",
+        "source": "mapbox",
+        "source-layer": "admin"
+    }])");
+
+    const TileID id { 0, 0, 0 };
+    auto labels = std::make_shared<VectorTileData>(id, 22, labelStyle, glyphAtlas, glyphStore,
+                                                   spriteAtlas, sprite, info);
+    auto shapes = std::make_shared<VectorTileData>(id, 22, shapeStyle, glyphAtlas, glyphStore,
+                                                   spriteAtlas, sprite, info);
+
+    std::size_t parsed = 0;
+    auto callback = [&] { parsed++; };
+
+    labels->request(worker, 1, callback);
+    shapes->request(worker, 1, callback);
+
+    const std::string tile = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    ASSERT_EQ(2u, fileSource.respond(Resource::Kind::Tile, tile));
+
+    // The label tile is parsed first, but gives up its worker instead of waiting for glyphs.
+    uv_run(env.loop, UV_RUN_DEFAULT);
+    EXPECT_EQ(2u, parsed);
+    EXPECT_EQ(TileData::State::partial, labels->state);
+    EXPECT_EQ(TileData::State::parsed, shapes->state);
+    EXPECT_TRUE(shapes->hasData(*shapeStyle->layers[0]));
+    EXPECT_TRUE(shapes->hasData(*shapeStyle->layers[1]));
+
+    // Resuming requests the glyphs, but doesn't reparse before they arrive.
+    labels->resume(worker, callback);
+    uv_run(env.loop, UV_RUN_DEFAULT);
+    EXPECT_EQ(2u, parsed);
+    EXPECT_EQ(TileData::State::partial, labels->state);
+    EXPECT_FALSE(labels->dependenciesLoaded());
+
+    EXPECT_EQ(1u, fileSource.respond(Resource::Kind::Glyphs, ""));
+    EXPECT_EQ(1u, glyphCallbacks);
+    EXPECT_TRUE(labels->dependenciesLoaded());
+
+    labels->resume(worker, callback);
+    uv_run(env.loop, UV_RUN_DEFAULT);
+    EXPECT_EQ(3u, parsed);
+    EXPECT_EQ(TileData::State::parsed, labels->state);
+}
@@ -0,0 +1,103 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/metrics.hpp>
+#include <mbgl/map/metrics_recorder.hpp>
+
+#include <rapidjson/document.h>
+
+using namespace mbgl;
+
+namespace {
+
+Duration us(int64_t count) {
+    return std::chrono::duration_cast<Duration>(std::chrono::microseconds(count));
+}
+
+}
+
+TEST(Metrics, HistogramQuantiles) {
+    Histogram histogram;
+    EXPECT_EQ(0u, histogram.count());
+    EXPECT_EQ(Duration::zero(), histogram.min());
+    EXPECT_EQ(Duration::zero(), histogram.quantile(0.5));
+
+    for (int64_t i = 1; i <= 1000; i++) {
+        histogram.record(us(i));
+    }
+
+    EXPECT_EQ(1000u, histogram.count());
+    EXPECT_EQ(us(1), histogram.min());
+    EXPECT_EQ(us(1000), histogram.max());
+    EXPECT_EQ(us(500500), histogram.sum());
+
+    // Quantiles are rounded up to the bucket limit, which is at most 19% above the value.
+    const Duration p50 = histogram.quantile(0.5);
+    EXPECT_GE(p50, us(500));
+    EXPECT_LE(p50, us(595));
+    const Duration p99 = histogram.quantile(0.99);
+    EXPECT_GE(p99, us(990));
+    EXPECT_LE(p99, us(1000));
+    EXPECT_EQ(us(1000), histogram.quantile(1));
+
+    uint64_t total = 0;
+    for (std::size_t i = 0; i < Histogram::bucketCount; i++) {
+        total += histogram.getBuckets()[i];
+        if (i > 0) {
+            EXPECT_LT(Histogram::bucketLimit(i - 1), Histogram::bucketLimit(i));
+        }
+    }
+    EXPECT_EQ(1000u, total);
+}
+
+TEST(Metrics, HistogramBucketLimits) {
+    Histogram histogram;
+    histogram.record(Histogram::bucketLimit(10));
+    histogram.record(Histogram::bucketLimit(10) + Duration(1));
+    histogram.record(std::chrono::hours(1));
+    histogram.record(Duration(-1));
+
+    EXPECT_EQ(1u, histogram.getBuckets()[0]);
+    EXPECT_EQ(1u, histogram.getBuckets()[10]);
+    EXPECT_EQ(1u, histogram.getBuckets()[11]);
+    EXPECT_EQ(1u, histogram.getBuckets()[Histogram::bucketCount - 1]);
+}
+
+TEST(Metrics, JSON) {
+    MetricsRecorder recorder;
+    recorder.requestCompleted(us(2000), false);
+    recorder.requestCompleted(us(4000), true);
+    recorder.tileCacheLookup(true);
+    recorder.tileCacheLookup(false);
+    recorder.tileCacheLookup(false);
+    recorder.tileParsed(us(3000), 120, 0);
+    recorder.tileParsed(us(1000), 0, 4500);
+    recorder.bucketParsed("fill", us(500));
+    recorder.bucketParsed("symbol", us(1500));
+    recorder.uploaded(1024);
+    recorder.frameRendered(us(16000), 300);
+    recorder.frameRendered(us(12000), 200);
+
+    const MapMetrics metrics = recorder.snapshot();
+    EXPECT_EQ(2u, metrics.bucketParseTime.size());
+
+    rapidjson::Document doc;
+    doc.Parse<0>(metrics.toJSON().c_str());
+    ASSERT_FALSE(doc.HasParseError());
+
+    EXPECT_EQ(2u, doc["requests"]["count"].GetUint64());
+    EXPECT_EQ(1u, doc["requests"]["errors"].GetUint64());
+    EXPECT_DOUBLE_EQ(3.0, doc["requests"]["time"]["mean"].GetDouble());
+    EXPECT_DOUBLE_EQ(4.0, doc["requests"]["time"]["max"].GetDouble());
+    EXPECT_EQ(1u, doc["tileCache"]["hits"].GetUint64());
+    EXPECT_EQ(2u, doc["tileCache"]["misses"].GetUint64());
+    EXPECT_EQ(120u, doc["parse"]["features"].GetUint64());
+    EXPECT_EQ(4500u, doc["parse"]["vertices"].GetUint64());
+    EXPECT_EQ(2u, doc["parse"]["time"]["count"].GetUint64());
+    EXPECT_EQ(1u, doc["parse"]["buckets"]["fill"]["count"].GetUint64());
+    EXPECT_FALSE(doc["parse"]["buckets"].HasMember("line"));
+    EXPECT_EQ(0u, doc["tileFirstRenderTime"]["count"].GetUint64());
+    EXPECT_EQ(1024u, doc["uploadBytes"].GetUint64());
+    EXPECT_EQ(2u, doc["frames"]["count"].GetUint64());
+    EXPECT_EQ(500u, doc["frames"]["glCalls"].GetUint64());
+    EXPECT_EQ(200u, doc["frames"]["lastFrameGLCalls"].GetUint64());
+}
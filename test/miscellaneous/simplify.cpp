@@ -0,0 +1,54 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/geometry/simplify.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+GeometryBuffer::Line line(const std::vector<Coordinate>& points) {
+    return GeometryBuffer::Line(points.data(), points.data() + points.size());
+}
+
+}
+
+TEST(Simplify, Collinear) {
+    const std::vector<Coordinate> points = {{ 0, 0 }, { 10, 0 }, { 20, 1 }, { 30, 0 }, { 40, 0 }};
+
+    LineSimplifier simplify;
+    std::vector<Coordinate> result;
+    simplify(line(points), 2, result);
+    EXPECT_EQ((std::vector<Coordinate> {{ 0, 0 }, { 40, 0 }}), result);
+
+    // Points further away than the tolerance are kept, but points on the line never are.
+    simplify(line(points), 0.5, result);
+    EXPECT_EQ((std::vector<Coordinate> {{ 0, 0 }, { 20, 1 }, { 40, 0 }}), result);
+}
+
+TEST(Simplify, Corner) {
+    const std::vector<Coordinate> points = {{ 0, 0 }, { 50, 1 }, { 100, 0 }, { 101, 50 }, { 100, 100 }};
+
+    LineSimplifier simplify;
+    std::vector<Coordinate> result;
+    simplify(line(points), 2, result);
+    EXPECT_EQ((std::vector<Coordinate> {{ 0, 0 }, { 100, 0 }, { 100, 100 }}), result);
+}
+
+TEST(Simplify, Closed) {
+    // The endpoints of a ring coincide, and are kept along with the points furthest from them.
+    const std::vector<Coordinate> points = {{ 0, 0 }, { 10, 0 }, { 20, 0 }, { 20, 20 }, { 0, 20 }, { 0, 0 }};
+
+    LineSimplifier simplify;
+    std::vector<Coordinate> result;
+    simplify(line(points), 1, result);
+    EXPECT_EQ((std::vector<Coordinate> {{ 0, 0 }, { 20, 0 }, { 20, 20 }, { 0, 20 }, { 0, 0 }}), result);
+}
+
+TEST(Simplify, Short) {
+    const std::vector<Coordinate> points = {{ 0, 0 }, { 10, 0 }};
+
+    LineSimplifier simplify;
+    std::vector<Coordinate> result = {{ 5, 5 }};
+    simplify(line(points), 100, result);
+    EXPECT_EQ(points, result);
+}
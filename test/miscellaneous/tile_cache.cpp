@@ -0,0 +1,125 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/environment.hpp>
+#include <mbgl/map/source.hpp>
+#include <mbgl/map/tile_cache.hpp>
+#include <mbgl/storage/file_source.hpp>
+
+using namespace mbgl;
+
+namespace {
+
+class StubFileSource : public FileSource {
+public:
+    Request* request(const Resource&, uv_loop_t*, const Environment&, Callback) override {
+        return nullptr;
+    }
+    void cancel(Request*) override {}
+    void request(const Resource&, const Environment&, Callback) override {}
+    void abort(const Environment&) override {}
+};
+
+class StubTileData : public TileData {
+public:
+    StubTileData(const TileID& id_, const SourceInfo& info, std::size_t raw, std::size_t client_,
+                 std::size_t server_)
+        : TileData(id_, info), client(client_), server(server_) {
+        data = std::make_shared<const std::string>(raw, 'x');
+        state = State::parsed;
+    }
+
+    void parse() override {}
+    void render(Painter&, const StyleLayer&, const mat4&) override {}
+    bool hasData(const StyleLayer&) const override { return true; }
+
+    std::size_t clientBytes() const override { return client; }
+    std::size_t serverBytes() const override { return server; }
+
+    std::size_t client;
+    std::size_t server;
+};
+
+class TileCacheTest : public testing::Test {
+protected:
+    std::shared_ptr<TileData> makeTile(uint64_t key, std::size_t raw, std::size_t client,
+                                       std::size_t server) {
+        const TileID id { 10, int32_t(key), 0 };
+        return std::make_shared<StubTileData>(id, info, raw, client, server);
+    }
+
+    StubFileSource fileSource;
+    Environment env { fileSource };
+    EnvironmentScope scope { env, ThreadType::Map, "Map" };
+    SourceInfo info;
+    Source first;
+    Source second;
+};
+
+}
+
+TEST_F(TileCacheTest, EvictsLeastRecentlyCachedAcrossSources) {
+    TileCache cache(1000);
+
+    cache.add(first, 1, makeTile(1, 0, 0, 400));
+    cache.add(second, 1, makeTile(1, 0, 0, 400));
+    EXPECT_EQ(800u, cache.getBytes());
+    EXPECT_TRUE(cache.has(first, 1));
+    EXPECT_TRUE(cache.has(second, 1));
+    EXPECT_FALSE(cache.has(first, 2));
+
+    // A large tile pushes out the oldest one, no matter which source it belongs to.
+    cache.add(first, 2, makeTile(2, 0, 0, 300));
+    EXPECT_FALSE(cache.has(first, 1));
+    EXPECT_TRUE(cache.has(second, 1));
+    EXPECT_EQ(700u, cache.getBytes());
+
+    // Reusing a tile takes it out of the cache.
+    EXPECT_TRUE(bool(cache.get(second, 1)));
+    EXPECT_FALSE(cache.has(second, 1));
+    EXPECT_FALSE(bool(cache.get(second, 1)));
+    EXPECT_EQ(300u, cache.getBytes());
+
+    cache.setBudget(200);
+    EXPECT_EQ(0u, cache.size());
+    EXPECT_EQ(0u, cache.getBytes());
+
+    cache.setBudget(0);
+    cache.add(first, 3, makeTile(3, 0, 0, 0));
+    EXPECT_EQ(0u, cache.size());
+}
+
+TEST_F(TileCacheTest, ClearSource) {
+    TileCache cache;
+    cache.add(first, 1, makeTile(1, 10, 0, 0));
+    cache.add(second, 1, makeTile(1, 20, 0, 0));
+    cache.add(first, 2, makeTile(2, 30, 0, 0));
+
+    cache.clear(first);
+    EXPECT_EQ(1u, cache.size());
+    EXPECT_TRUE(cache.has(second, 1));
+    EXPECT_EQ(20u, cache.getBytes());
+}
+
+TEST_F(TileCacheTest, MemoryPressure) {
+    TileCache cache;
+    cache.add(first, 1, makeTile(1, 100, 0, 50));  // drawn before
+    cache.add(first, 2, makeTile(2, 100, 70, 0));  // never drawn
+    cache.add(second, 1, makeTile(1, 100, 0, 30)); // drawn before
+    EXPECT_EQ(450u, cache.getBytes());
+
+    // Raw tile data goes first.
+    cache.onLowMemory(MemoryPressure::Moderate);
+    EXPECT_EQ(3u, cache.size());
+    EXPECT_EQ(150u, cache.getBytes());
+
+    // Then tiles that still hold their buffers in client memory.
+    cache.onLowMemory(MemoryPressure::High);
+    EXPECT_EQ(2u, cache.size());
+    EXPECT_FALSE(cache.has(first, 2));
+    EXPECT_EQ(80u, cache.getBytes());
+
+    // And finally all of them.
+    cache.onLowMemory(MemoryPressure::Critical);
+    EXPECT_EQ(0u, cache.size());
+    EXPECT_EQ(0u, cache.getBytes());
+}
@@ -0,0 +1,80 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/transform.hpp>
+#include <mbgl/map/view.hpp>
+
+#include <thread>
+
+using namespace mbgl;
+
+namespace {
+
+class StubView : public View {
+public:
+    void activate() override {}
+    void deactivate() override {}
+    void notify() override {}
+    void invalidate() override {}
+};
+
+class TransformTest : public testing::Test {
+protected:
+    TransformTest() {
+        transform.resize(512, 512, 1, 512, 512);
+        transform.setLatLngZoom({ 0, 0 }, 5);
+    }
+
+    StubView view;
+    Transform transform { view };
+};
+
+}
+
+TEST_F(TransformTest, PredictsNothingAtRest) {
+    TransformState predicted;
+    EXPECT_FALSE(transform.predictState(predicted, std::chrono::milliseconds(500)));
+}
+
+TEST_F(TransformTest, PredictsTransitionDestination) {
+    transform.setLatLngZoom({ 52.52, 13.40 }, 10, std::chrono::seconds(1));
+
+    // The destination is known before the map gets there.
+    TransformState predicted;
+    ASSERT_TRUE(transform.predictState(predicted, std::chrono::milliseconds(500)));
+    EXPECT_DOUBLE_EQ(10, predicted.getZoom());
+    EXPECT_NEAR(52.52, predicted.getLatLng().latitude, 1e-6);
+    EXPECT_NEAR(13.40, predicted.getLatLng().longitude, 1e-6);
+    EXPECT_DOUBLE_EQ(5, transform.currentState().getZoom());
+
+    transform.cancelTransitions();
+    EXPECT_FALSE(transform.predictState(predicted, std::chrono::milliseconds(500)));
+}
+
+TEST_F(TransformTest, PredictsGestureMotion) {
+    transform.setGestureInProgress(true);
+    transform.moveBy(10, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    transform.moveBy(10, 0);
+
+    // Dragging the map to the right reveals what's west of it, and continues to do so.
+    TransformState predicted;
+    ASSERT_TRUE(transform.predictState(predicted, std::chrono::milliseconds(500)));
+    EXPECT_DOUBLE_EQ(5, predicted.getZoom());
+    EXPECT_LT(predicted.getLatLng().longitude, transform.currentState().getLatLng().longitude);
+
+    // Once the fingers lift, the map stays where it is.
+    transform.setGestureInProgress(false);
+    EXPECT_FALSE(transform.predictState(predicted, std::chrono::milliseconds(500)));
+}
+
+TEST_F(TransformTest, ForgetsPausedGesture) {
+    transform.setGestureInProgress(true);
+    transform.moveBy(10, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    transform.moveBy(10, 0);
+
+    // A gesture that stopped moving doesn't predict any motion.
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    TransformState predicted;
+    EXPECT_FALSE(transform.predictState(predicted, std::chrono::milliseconds(500)));
+}
@@ -0,0 +1,48 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/map/vector_tile.hpp>
+#include <mbgl/util/io.hpp>
+
+using namespace mbgl;
+
+TEST(VectorTile, FeatureIndex) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = tile.getLayer("water");
+    ASSERT_TRUE(bool(layer));
+    ASSERT_GT(layer->featureCount(), 0u);
+
+    EXPECT_FALSE(bool(tile.getLayer("does-not-exist")));
+
+    // Features are handed out by reference from the layer, so repeated lookups must
+    // yield the same object rather than a freshly decoded copy.
+    const GeometryTileFeature& first = layer->getFeature(0);
+    EXPECT_EQ(&first, &layer->getFeature(0));
+    EXPECT_EQ(FeatureType::Polygon, first.getType());
+    EXPECT_FALSE(first.getGeometries().empty());
+
+    EXPECT_FALSE(bool(first.getValue("does-not-exist")));
+}
+
+TEST(VectorTile, KeyIndex) {
+    const std::string data = util::read_file("test/fixtures/tiles/streets/0-0-0.vector.pbf");
+    VectorTile tile(pbf(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+
+    auto layer = std::static_pointer_cast<VectorTileLayer>(tile.getLayer("admin"));
+    ASSERT_TRUE(bool(layer));
+
+    const int32_t adminLevel = layer->getKeyIndex("admin_level");
+    ASSERT_GE(adminLevel, 0);
+    EXPECT_EQ(-1, layer->getKeyIndex("does-not-exist"));
+
+    for (std::size_t i = 0; i < layer->featureCount(); i++) {
+        const auto& feature = static_cast<const VectorTileFeature&>(layer->getFeature(i));
+        auto byName = feature.getValue(std::string("admin_level"));
+        auto byIndex = feature.getValue(uint32_t(adminLevel));
+        ASSERT_EQ(bool(byName), bool(byIndex));
+        if (byName) {
+            EXPECT_EQ(toString(*byName), toString(*byIndex));
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#include "../fixtures/util.hpp"
+
+#include <mbgl/util/worker.hpp>
+
+#include <uv.h>
+
+#include <future>
+
+using namespace mbgl;
+
+TEST(Worker, Priority) {
+    std::vector<int> order;
+    std::vector<int> after;
+
+    {
+        Worker worker(uv_default_loop(), 1);
+
+        // Occupy the only thread until all other tasks are queued.
+        std::promise<void> unblock;
+        std::shared_future<void> blocked = unblock.get_future().share();
+        worker.send([blocked] { blocked.wait(); }, nullptr, -1);
+
+        worker.send([&] { order.push_back(3); }, [&] { after.push_back(3); }, 3);
+        worker.send([&] { order.push_back(1); }, [&] { after.push_back(1); }, 1);
+        auto task = worker.send([&] { order.push_back(4); }, [&] { after.push_back(4); }, 0);
+        worker.send([&] { order.push_back(2); }, [&] { after.push_back(2); }, 2);
+
+        // Reprioritization applies to tasks that are already queued.
+        task->setPriority(4);
+        unblock.set_value();
+
+        uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+        const Worker::Metrics metrics = worker.getMetrics();
+        EXPECT_EQ(1u, metrics.threads);
+        EXPECT_EQ(0u, metrics.queued);
+        EXPECT_EQ(5u, metrics.executed);
+        EXPECT_EQ(0u, metrics.canceled);
+        EXPECT_LE(metrics.maxWait, metrics.totalWait);
+    }
+
+    // Close the handle of the worker's queue.
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+    EXPECT_EQ((std::vector<int> { 1, 2, 3, 4 }), order);
+    EXPECT_EQ((std::vector<int> { 1, 2, 3, 4 }), after);
+}
+
+TEST(Worker, Cancel) {
+    std::vector<int> order;
+
+    {
+        Worker worker(uv_default_loop(), 1);
+
+        std::promise<void> unblock;
+        std::shared_future<void> blocked = unblock.get_future().share();
+        worker.send([blocked] { blocked.wait(); }, nullptr, -1);
+
+        worker.send([&] { order.push_back(1); }, [&] { order.push_back(-1); }, 1);
+        auto task = worker.send([&] { order.push_back(2); }, [&] { order.push_back(-2); }, 2);
+
+        task->cancel();
+        unblock.set_value();
+
+        uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+        EXPECT_TRUE(task->isCanceled());
+
+        const Worker::Metrics metrics = worker.getMetrics();
+        EXPECT_EQ(2u, metrics.executed);
+        EXPECT_EQ(1u, metrics.canceled);
+    }
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+    EXPECT_EQ((std::vector<int> { 1, -1 }), order);
+}
+
+TEST(Worker, Steal) {
+    std::atomic<std::size_t> count { 0 };
+
+    {
+        Worker worker(uv_default_loop(), 4);
+
+        // Tasks are handed out round-robin, so a blocked thread's deque must be drained by others.
+        std::promise<void> unblock;
+        std::shared_future<void> blocked = unblock.get_future().share();
+        worker.send([blocked] { blocked.wait(); }, nullptr);
+
+        for (int i = 0; i < 100; i++) {
+            worker.send([&] { count++; }, nullptr, i);
+        }
+
+        while (count < 100) {
+            std::this_thread::yield();
+        }
+        unblock.set_value();
+
+        uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+        EXPECT_EQ(101u, worker.getMetrics().executed);
+    }
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+    EXPECT_EQ(100u, count);
+}
@@ -0,0 +1,147 @@
+#include "storage.hpp"
+
+#include <mbgl/storage/sqlite_cache.hpp>
+#include <mbgl/storage/resource.hpp>
+#include <mbgl/storage/response.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <random>
+
+#include <sqlite3.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const path = "test/fixtures/database/size.db";
+const uint64_t limit = 512 * 1024;
+
+std::shared_ptr<const mbgl::Response> randomResponse(std::mt19937& random, std::size_t size) {
+    // Random data doesn't compress, so every response takes up its full size.
+    auto response = std::make_shared<mbgl::Response>();
+    response->status = mbgl::Response::Successful;
+    auto data = std::make_shared<std::string>(size, '\0');
+    for (auto& byte : *data) {
+        byte = char(random());
+    }
+    response->data = std::move(data);
+    return response;
+}
+
+bool cached(mbgl::SQLiteCache& cache, const mbgl::Resource& resource) {
+    using namespace mbgl;
+
+    util::RunLoop loop;
+    bool hit = false;
+    loop.invoke([&] {
+        cache.get(resource, [&] (std::unique_ptr<Response> res) {
+            hit = bool(res);
+            loop.stop();
+        });
+    });
+    loop.run();
+    return hit;
+}
+
+mbgl::Resource tile(const std::string& name) {
+    return { mbgl::Resource::Tile, "http://127.0.0.1:3000/" + name };
+}
+
+}
+
+TEST_F(Storage, CacheSizeLimit) {
+    using namespace mbgl;
+
+    mkdir("test/fixtures/database", 0755);
+    unlink(path);
+
+    std::mt19937 random(42);
+    uint64_t hotHits = 0;
+
+    {
+        SQLiteCache cache(path);
+        cache.setMaximumCacheSize(limit);
+
+        // A few tiles are used all the time, while many others are used once. The total size is
+        // three times the limit.
+        for (int i = 0; i < 8; i++) {
+            cache.put(tile("hot/" + std::to_string(i)), randomResponse(random, 8192), FileCache::Hint::Full);
+        }
+        for (int i = 0; i < 192; i++) {
+            cache.put(tile("cold/" + std::to_string(i)), randomResponse(random, 8192), FileCache::Hint::Full);
+            hotHits += cached(cache, tile("hot/" + std::to_string(i % 8)));
+        }
+
+        EXPECT_EQ(192u, hotHits);
+
+        // The oldest tiles were evicted, the latest ones are still there.
+        uint64_t coldHits = 0;
+        for (int i = 0; i < 32; i++) {
+            coldHits += cached(cache, tile("cold/" + std::to_string(i)));
+        }
+        EXPECT_EQ(0u, coldHits);
+        for (int i = 184; i < 192; i++) {
+            EXPECT_TRUE(cached(cache, tile("cold/" + std::to_string(i)))) << i;
+        }
+    }
+
+    // The database is pruned after every eighth of the limit was written.
+    struct stat info;
+    ASSERT_EQ(0, stat(path, &info));
+    EXPECT_GT(uint64_t(info.st_size), limit / 2);
+    EXPECT_LE(uint64_t(info.st_size), limit + limit / 8 + 64 * 1024);
+}
+
+TEST_F(Storage, CacheSchemaMigration) {
+    using namespace mbgl;
+
+    mkdir("test/fixtures/database", 0755);
+    unlink(path);
+
+    // Creates a database with the schema that doesn't track access times and sizes.
+    sqlite3* db = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path, &db));
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db,
+        "CREATE TABLE `http_cache` ("
+        "    `url` TEXT PRIMARY KEY NOT NULL,"
+        "    `status` INTEGER NOT NULL,"
+        "    `kind` INTEGER NOT NULL,"
+        "    `modified` INTEGER,"
+        "    `etag` TEXT,"
+        "    `expires` INTEGER,"
+        "    `data` BLOB,"
+        "    `compressed` INTEGER NOT NULL DEFAULT 0"
+        ");"
+        "INSERT INTO `http_cache` (`url`, `status`, `kind`, `expires`, `data`) "
+        "VALUES ('http://127.0.0.1:3000/old', 1, 3, 1234, 'Hello World!');",
+        nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    {
+        SQLiteCache cache(path);
+        cache.setMaximumCacheSize(limit);
+
+        util::RunLoop loop;
+        loop.invoke([&] {
+            cache.get(tile("old"), [&] (std::unique_ptr<Response> res) {
+                ASSERT_TRUE(res.get());
+                EXPECT_EQ("Hello World!", *res->data);
+                EXPECT_EQ(1234, res->expires);
+                loop.stop();
+            });
+        });
+        loop.run();
+    }
+
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path, &db));
+    sqlite3_stmt* stmt = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db,
+        "SELECT `size`, `accessed` FROM `http_cache` WHERE `url` = 'http://127.0.0.1:3000/old'",
+        -1, &stmt, nullptr));
+    ASSERT_EQ(SQLITE_ROW, sqlite3_step(stmt));
+    EXPECT_EQ(12, sqlite3_column_int64(stmt, 0));
+    EXPECT_LT(0, sqlite3_column_int64(stmt, 1));
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+}
@@ -0,0 +1,163 @@
+#include "storage.hpp"
+
+#include <uv.h>
+
+#include <mbgl/storage/default_file_source.hpp>
+#include <mbgl/storage/sqlite_cache.hpp>
+
+TEST_F(Storage, CacheStaleNotModified) {
+    SCOPED_TEST(Stale)
+    SCOPED_TEST(Refreshed)
+
+    using namespace mbgl;
+
+    SQLiteCache cache(":memory:");
+    DefaultFileSource fs(&cache);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    const std::string url = "http://127.0.0.1:3000/revalidate-same";
+    const Resource revalidate { Resource::Unknown, url };
+    const Resource stale { Resource::Unknown, url, Resource::Visible,
+                           Resource::StaleWhileRevalidate };
+
+    fs.request(revalidate, uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        EXPECT_FALSE(res.stale);
+
+        // The expired response is delivered right away. The server replies with a 304, so the
+        // request isn't answered a second time.
+        int answers = 0;
+        fs.request(stale, uv_default_loop(), env, [&, answers](const Response &res2) mutable {
+            EXPECT_EQ(1, ++answers);
+            EXPECT_EQ(Response::Successful, res2.status);
+            EXPECT_TRUE(res2.stale);
+            EXPECT_EQ("Response", *res2.data);
+            EXPECT_EQ(0, res2.expires);
+            Stale.finish();
+        });
+    });
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+    // The revalidation refreshed the cached response in the background.
+    fs.request(revalidate, uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        EXPECT_FALSE(res.stale);
+        EXPECT_EQ("Response", *res.data);
+        EXPECT_LT(0, res.expires);
+        Refreshed.finish();
+    });
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
+
+TEST_F(Storage, CacheStaleModified) {
+    SCOPED_TEST(Stale)
+    SCOPED_TEST(Modified)
+    SCOPED_TEST(Revalidated)
+
+    using namespace mbgl;
+
+    SQLiteCache cache(":memory:");
+    DefaultFileSource fs(&cache);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    const std::string url = "http://127.0.0.1:3000/stale-changed";
+    const Resource revalidate { Resource::Unknown, url };
+    const Resource stale { Resource::Unknown, url, Resource::Visible,
+                           Resource::StaleWhileRevalidate };
+
+    fs.request(revalidate, uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        const std::string first = *res.data;
+
+        // The request that accepts the expired response is answered twice, because the content
+        // changed on the server.
+        int answers = 0;
+        fs.request(stale, uv_default_loop(), env, [&, first, answers](const Response &res2) mutable {
+            EXPECT_EQ(Response::Successful, res2.status);
+            if (++answers == 1) {
+                EXPECT_TRUE(res2.stale);
+                EXPECT_EQ(first, *res2.data);
+                Stale.finish();
+            } else {
+                EXPECT_EQ(2, answers);
+                EXPECT_FALSE(res2.stale);
+                EXPECT_NE(first, *res2.data);
+                Modified.finish();
+            }
+        });
+
+        // A request that doesn't accept it waits for the revalidated response.
+        fs.request(revalidate, uv_default_loop(), env, [&, first](const Response &res2) {
+            EXPECT_EQ(Response::Successful, res2.status);
+            EXPECT_FALSE(res2.stale);
+            EXPECT_NE(first, *res2.data);
+            Revalidated.finish();
+        });
+    });
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
+
+TEST_F(Storage, CacheStaleSameContent) {
+    SCOPED_TEST(Stale)
+
+    using namespace mbgl;
+
+    SQLiteCache cache(":memory:");
+    DefaultFileSource fs(&cache);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    const std::string url = "http://127.0.0.1:3000/stale-unchanged";
+    const Resource revalidate { Resource::Unknown, url };
+    const Resource stale { Resource::Unknown, url, Resource::Visible,
+                           Resource::StaleWhileRevalidate };
+
+    fs.request(revalidate, uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+
+        // The server can't reply with a 304, but sends the same content again.
+        int answers = 0;
+        fs.request(stale, uv_default_loop(), env, [&, answers](const Response &res2) mutable {
+            EXPECT_EQ(1, ++answers);
+            EXPECT_TRUE(res2.stale);
+            EXPECT_EQ("Response", *res2.data);
+            Stale.finish();
+        });
+    });
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
+
+TEST_F(Storage, CacheStaleCancel) {
+    SCOPED_TEST(Stale)
+
+    using namespace mbgl;
+
+    SQLiteCache cache(":memory:");
+    DefaultFileSource fs(&cache);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    const std::string url = "http://127.0.0.1:3000/stale-changed";
+    const Resource revalidate { Resource::Unknown, url };
+    const Resource stale { Resource::Unknown, url, Resource::Visible,
+                           Resource::StaleWhileRevalidate };
+
+    Request *req = nullptr;
+    fs.request(revalidate, uv_default_loop(), env, [&](const Response &) {
+        // A request that was answered with a stale response must be canceled if it's no longer
+        // needed, and isn't answered again afterwards.
+        req = fs.request(stale, uv_default_loop(), env, [&](const Response &res) {
+            EXPECT_TRUE(res.stale);
+            fs.cancel(req);
+            Stale.finish();
+        });
+    });
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
@@ -218,11 +218,11 @@ TEST_F(Storage, DatabaseLockedWrite) {
 
         loop.invoke([&] {
             auto response = std::make_shared<Response>();
-            response->data = "Demo";
+            response->data = std::make_shared<const std::string>("Demo");
             cache.put({ Resource::Unknown, "mapbox://test" }, response, FileCache::Hint::Full);
             cache.get({ Resource::Unknown, "mapbox://test" }, [&] (std::unique_ptr<Response> res) {
                 EXPECT_NE(nullptr, res.get());
-                EXPECT_EQ("Demo", res->data);
+                EXPECT_EQ("Demo", *res->data);
                 loop.stop();
             });
         });
@@ -257,7 +257,7 @@ TEST_F(Storage, DatabaseLockedRefresh) {
 
         loop.invoke([&] {
             auto response = std::make_shared<Response>();
-            response->data = "Demo";
+            response->data = std::make_shared<const std::string>("Demo");
             cache.put({ Resource::Unknown, "mapbox://test" }, response, FileCache::Hint::Full);
             cache.get({ Resource::Unknown, "mapbox://test" }, [&] (std::unique_ptr<Response> res) {
                 EXPECT_EQ(nullptr, res.get());
@@ -280,7 +280,7 @@ TEST_F(Storage, DatabaseLockedRefresh) {
 
         loop.invoke([&] {
             auto response = std::make_shared<Response>();
-            response->data = "Demo";
+            response->data = std::make_shared<const std::string>("Demo");
             cache.put({ Resource::Unknown, "mapbox://test" }, response, FileCache::Hint::Refresh);
             cache.get({ Resource::Unknown, "mapbox://test" }, [&] (std::unique_ptr<Response> res) {
                 EXPECT_EQ(nullptr, res.get());
@@ -316,11 +316,11 @@ TEST_F(Storage, DatabaseDeleted) {
 
         loop.invoke([&] {
             auto response = std::make_shared<Response>();
-            response->data = "Demo";
+            response->data = std::make_shared<const std::string>("Demo");
             cache.put({ Resource::Unknown, "mapbox://test" }, response, FileCache::Hint::Full);
             cache.get({ Resource::Unknown, "mapbox://test" }, [&] (std::unique_ptr<Response> res) {
                 EXPECT_NE(nullptr, res.get());
-                EXPECT_EQ("Demo", res->data);
+                EXPECT_EQ("Demo", *res->data);
                 loop.stop();
             });
         });
@@ -340,11 +340,11 @@ TEST_F(Storage, DatabaseDeleted) {
 
         loop.invoke([&] {
             auto response = std::make_shared<Response>();
-            response->data = "Demo";
+            response->data = std::make_shared<const std::string>("Demo");
             cache.put({ Resource::Unknown, "mapbox://test" }, response, FileCache::Hint::Full);
             cache.get({ Resource::Unknown, "mapbox://test" }, [&] (std::unique_ptr<Response> res) {
                 EXPECT_NE(nullptr, res.get());
-                EXPECT_EQ("Demo", res->data);
+                EXPECT_EQ("Demo", *res->data);
                 loop.stop();
             });
         });
@@ -377,11 +377,11 @@ TEST_F(Storage, DatabaseInvalid) {
 
         loop.invoke([&] {
             auto response = std::make_shared<Response>();
-            response->data = "Demo";
+            response->data = std::make_shared<const std::string>("Demo");
             cache.put({ Resource::Unknown, "mapbox://test" }, response, FileCache::Hint::Full);
             cache.get({ Resource::Unknown, "mapbox://test" }, [&] (std::unique_ptr<Response> res) {
                 EXPECT_NE(nullptr, res.get());
-                EXPECT_EQ("Demo", res->data);
+                EXPECT_EQ("Demo", *res->data);
                 loop.stop();
             });
         });
@@ -393,3 +393,81 @@ TEST_F(Storage, DatabaseInvalid) {
         EXPECT_EQ(1ul, flo->count({ EventSeverity::Warning, Event::Database, -1, "Trashing invalid database" }));
     }
 }
+
+TEST_F(Storage, DatabaseCompressed) {
+    using namespace mbgl;
+
+    createDir("test/fixtures/database");
+    deleteFile("test/fixtures/database/compressed.db");
+
+    SQLiteCache cache("test/fixtures/database/compressed.db");
+
+    // Compressible responses are stored compressed and inflated when they are read.
+    const std::string data(64 * 1024, 'x');
+    util::RunLoop loop;
+
+    loop.invoke([&] {
+        auto response = std::make_shared<Response>();
+        response->data = std::make_shared<const std::string>(data);
+        cache.put({ Resource::Tile, "mapbox://tile" }, response, FileCache::Hint::Full);
+        cache.get({ Resource::Tile, "mapbox://tile" }, [&] (std::unique_ptr<Response> res) {
+            ASSERT_NE(nullptr, res.get());
+            EXPECT_EQ(data, *res->data);
+            loop.stop();
+        });
+    });
+
+    loop.run();
+
+    deleteFile("test/fixtures/database/compressed.db");
+}
+
+TEST_F(Storage, DatabaseCorruptCompressed) {
+    using namespace mbgl;
+
+    createDir("test/fixtures/database");
+    deleteFile("test/fixtures/database/corrupt.db");
+
+    {
+        SQLiteCache cache("test/fixtures/database/corrupt.db");
+        util::RunLoop loop;
+        loop.invoke([&] {
+            auto response = std::make_shared<Response>();
+            response->data = std::make_shared<const std::string>("Demo");
+            cache.put({ Resource::Unknown, "mapbox://test" }, response, FileCache::Hint::Full);
+            cache.get({ Resource::Unknown, "mapbox://test" }, [&] (std::unique_ptr<Response>) {
+                loop.stop();
+            });
+        });
+        loop.run();
+    }
+
+    sqlite3* db = nullptr;
+    ASSERT_EQ(SQLITE_OK, sqlite3_open("test/fixtures/database/corrupt.db", &db));
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db,
+        "UPDATE `http_cache` SET `data` = 'not deflated', `compressed` = 1",
+        nullptr, nullptr, nullptr));
+    sqlite3_close(db);
+
+    Log::setObserver(util::make_unique<FixtureLogObserver>());
+
+    {
+        // Payloads that can't be inflated are treated as missing.
+        SQLiteCache cache("test/fixtures/database/corrupt.db");
+        util::RunLoop loop;
+        loop.invoke([&] {
+            cache.get({ Resource::Unknown, "mapbox://test" }, [&] (std::unique_ptr<Response> res) {
+                EXPECT_EQ(nullptr, res.get());
+                loop.stop();
+            });
+        });
+        loop.run();
+    }
+
+    auto observer = Log::removeObserver();
+    auto flo = dynamic_cast<FixtureLogObserver*>(observer.get());
+    EXPECT_EQ(1ul, flo->count({ EventSeverity::Error, Event::Database, -1,
+                                "Failed to decompress cached response: incorrect header check" }));
+
+    deleteFile("test/fixtures/database/corrupt.db");
+}
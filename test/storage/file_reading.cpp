@@ -21,7 +21,7 @@ TEST_F(Storage, AssetEmptyFile) {
     fs.request({ Resource::Unknown, "asset://TEST_DATA/fixtures/storage/empty" }, uv_default_loop(),
                env, [&](const Response &res) {
         EXPECT_EQ(Response::Successful, res.status);
-        EXPECT_EQ(0ul, res.data.size());
+        EXPECT_EQ(0ul, res.data->size());
         EXPECT_EQ(0, res.expires);
         EXPECT_LT(1420000000, res.modified);
         EXPECT_NE("", res.etag);
@@ -48,12 +48,12 @@ TEST_F(Storage, AssetNonEmptyFile) {
     fs.request({ Resource::Unknown, "asset://TEST_DATA/fixtures/storage/nonempty" },
                uv_default_loop(), env, [&](const Response &res) {
         EXPECT_EQ(Response::Successful, res.status);
-        EXPECT_EQ(16ul, res.data.size());
+        EXPECT_EQ(16ul, res.data->size());
         EXPECT_EQ(0, res.expires);
         EXPECT_LT(1420000000, res.modified);
         EXPECT_NE("", res.etag);
         EXPECT_EQ("", res.message);
-        EXPECT_EQ("content is here\n", res.data);
+        EXPECT_EQ("content is here\n", *res.data);
         NonEmptyFile.finish();
     });
 
@@ -76,7 +76,7 @@ TEST_F(Storage, AssetNonExistentFile) {
     fs.request({ Resource::Unknown, "asset://TEST_DATA/fixtures/storage/does_not_exist" },
                uv_default_loop(), env, [&](const Response &res) {
         EXPECT_EQ(Response::Error, res.status);
-        EXPECT_EQ(0ul, res.data.size());
+        EXPECT_FALSE(res.data.get());
         EXPECT_EQ(0, res.expires);
         EXPECT_EQ(0, res.modified);
         EXPECT_EQ("", res.etag);
@@ -0,0 +1,66 @@
+#include "storage.hpp"
+
+#include <uv.h>
+
+#include <mbgl/storage/default_file_source.hpp>
+
+TEST_F(Storage, HTTPTiming) {
+    SCOPED_TEST(HTTPTiming)
+
+    using namespace mbgl;
+
+    DefaultFileSource fs(nullptr);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    fs.request({ Resource::Unknown, "http://127.0.0.1:3000/test" }, uv_default_loop(), env,
+               [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        EXPECT_FALSE(res.timing.reusedConnection);
+        EXPECT_LE(res.timing.lookup, res.timing.connect);
+        EXPECT_LT(Duration::zero(), res.timing.connect);
+        EXPECT_LE(res.timing.connect, res.timing.firstByte);
+        EXPECT_LE(res.timing.firstByte, res.timing.total);
+        // The connection isn't encrypted.
+        EXPECT_EQ(Duration::zero(), res.timing.tls);
+        HTTPTiming.finish();
+    });
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
+
+TEST_F(Storage, HTTPConnectionLimit) {
+    SCOPED_TEST(HTTPConnectionLimit)
+
+    using namespace mbgl;
+
+    DefaultFileSource fs(nullptr);
+
+    HTTPOptions options;
+    options.maximumHostConnections = 1;
+    fs.setHTTPOptions(options);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    // All requests wait for the single connection to the server instead of opening their own.
+    const int count = 10;
+    int completed = 0;
+    int connections = 0;
+
+    for (int i = 0; i < count; i++) {
+        fs.request({ Resource::Unknown, "http://127.0.0.1:3000/load/" + std::to_string(i) },
+                   uv_default_loop(), env, [&, i](const Response &res) {
+            EXPECT_EQ(Response::Successful, res.status);
+            EXPECT_EQ("Request " + std::to_string(i), *res.data);
+            if (!res.timing.reusedConnection) {
+                connections++;
+            }
+            if (++completed == count) {
+                EXPECT_EQ(1, connections);
+                HTTPConnectionLimit.finish();
+            }
+        });
+    }
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
@@ -27,7 +27,7 @@ TEST_F(Storage, HTTPCancelEnvironment) {
         // This environment gets aborted below. This means the request is marked as failing and
         // will return an error here.
         EXPECT_EQ(Response::Error, res.status);
-        EXPECT_EQ("", res.data);
+        EXPECT_FALSE(res.data.get());
         EXPECT_EQ(0, res.expires);
         EXPECT_EQ(0, res.modified);
         EXPECT_EQ("", res.etag);
@@ -40,7 +40,7 @@ TEST_F(Storage, HTTPCancelEnvironment) {
         // The same request as above, but in a different environment which doesn't get aborted. This
         // means the request should succeed.
         EXPECT_EQ(Response::Successful, res.status);
-        EXPECT_EQ("Response", res.data);
+        EXPECT_EQ("Response", *res.data);
         EXPECT_EQ(0, res.expires);
         EXPECT_EQ(0, res.modified);
         EXPECT_EQ("", res.etag);
@@ -0,0 +1,115 @@
+#include "storage.hpp"
+
+#include <uv.h>
+
+#include <mbgl/storage/default_file_source.hpp>
+
+#include <vector>
+
+namespace {
+
+const std::string delayed = "http://127.0.0.1:3000/delayed";
+
+std::string load(int number) {
+    return "http://127.0.0.1:3000/load/" + std::to_string(number);
+}
+
+}
+
+TEST_F(Storage, HTTPPriority) {
+    SCOPED_TEST(HTTPPriority)
+
+    using namespace mbgl;
+
+    DefaultFileSource fs(nullptr);
+    fs.setMaximumConcurrentRequests(1);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    std::vector<std::string> order;
+    const auto request = [&](const Resource &resource, const std::string &name) {
+        fs.request(resource, uv_default_loop(), env, [&, name](const Response &res) {
+            EXPECT_EQ(Response::Successful, res.status);
+            order.push_back(name);
+            if (order.size() == 5) {
+                EXPECT_EQ((std::vector<std::string> { "delayed", "style", "glyphs", "tile", "prefetch" }),
+                          order);
+                HTTPPriority.finish();
+            }
+        });
+    };
+
+    // The delayed request takes the only slot, and the others wait in the order of their priority.
+    request({ Resource::Unknown, delayed }, "delayed");
+    request({ Resource::Tile, load(1), Resource::Prefetch }, "prefetch");
+    request({ Resource::Tile, load(2) }, "tile");
+    request({ Resource::Glyphs, load(3) }, "glyphs");
+    request({ Resource::JSON, load(4) }, "style");
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
+
+TEST_F(Storage, HTTPReprioritize) {
+    SCOPED_TEST(HTTPReprioritize)
+
+    using namespace mbgl;
+
+    DefaultFileSource fs(nullptr);
+    fs.setMaximumConcurrentRequests(1);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    std::vector<std::string> order;
+    const auto request = [&](const Resource &resource, const std::string &name) {
+        fs.request(resource, uv_default_loop(), env, [&, name](const Response &res) {
+            EXPECT_EQ(Response::Successful, res.status);
+            order.push_back(name);
+            if (order.size() == 4) {
+                EXPECT_EQ((std::vector<std::string> { "delayed", "1", "1", "2" }), order);
+                HTTPReprioritize.finish();
+            }
+        });
+    };
+
+    // Requesting a prefetched tile for the viewport moves it ahead of the tiles that were
+    // requested after it was prefetched. Both requests for it are answered together.
+    request({ Resource::Unknown, delayed }, "delayed");
+    request({ Resource::Tile, load(1), Resource::Prefetch }, "1");
+    request({ Resource::Tile, load(2) }, "2");
+    request({ Resource::Tile, load(1) }, "1");
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
+
+TEST_F(Storage, HTTPCancelQueued) {
+    SCOPED_TEST(Delayed)
+    SCOPED_TEST(Tile)
+
+    using namespace mbgl;
+
+    DefaultFileSource fs(nullptr);
+    fs.setMaximumConcurrentRequests(1);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    fs.request({ Resource::Unknown, delayed }, uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        Delayed.finish();
+    });
+
+    // The canceled request never starts, and the queue moves on to the next one.
+    Request *canceled = fs.request({ Resource::Tile, load(1) }, uv_default_loop(), env,
+                                   [&](const Response &) {
+        ADD_FAILURE() << "Canceled request should not invoke its callback";
+    });
+
+    fs.request({ Resource::Tile, load(2) }, uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        EXPECT_EQ("Request 2", *res.data);
+        Tile.finish();
+    });
+
+    fs.cancel(canceled);
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
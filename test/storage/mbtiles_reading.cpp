@@ -0,0 +1,85 @@
+#include "storage.hpp"
+
+#include <uv.h>
+
+#include <mbgl/storage/default_file_source.hpp>
+#include <mbgl/storage/sqlite_cache.hpp>
+
+#include <rapidjson/document.h>
+
+TEST_F(Storage, MBTilesTileJSON) {
+    SCOPED_TEST(TileJSON)
+
+    using namespace mbgl;
+
+    DefaultFileSource fs(nullptr);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    fs.request({ Resource::JSON, "mbtiles://TEST_DATA/fixtures/storage/tiles.mbtiles" },
+               uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        EXPECT_EQ("", res.message);
+
+        rapidjson::Document doc;
+        doc.Parse<0>(res.data->c_str());
+        ASSERT_FALSE(doc.HasParseError());
+        EXPECT_EQ(0u, doc["minzoom"].GetUint());
+        EXPECT_EQ(1u, doc["maxzoom"].GetUint());
+        EXPECT_EQ(4u, doc["bounds"].Size());
+        EXPECT_EQ(3u, doc["center"].Size());
+        EXPECT_EQ(std::string("Test attribution"), doc["attribution"].GetString());
+        ASSERT_EQ(1u, doc["tiles"].Size());
+        EXPECT_EQ(std::string("mbtiles://TEST_DATA/fixtures/storage/tiles.mbtiles/{z}/{x}/{y}"),
+                  doc["tiles"][0u].GetString());
+        TileJSON.finish();
+    });
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
+
+TEST_F(Storage, MBTilesTiles) {
+    SCOPED_TEST(GzippedTile)
+    SCOPED_TEST(Tile)
+    SCOPED_TEST(MissingTile)
+    SCOPED_TEST(MissingFile)
+
+    using namespace mbgl;
+
+    // Tiles from MBTiles files aren't stored in the cache.
+    SQLiteCache cache(":memory:");
+    DefaultFileSource fs(&cache);
+
+    auto &env = *static_cast<const Environment *>(nullptr);
+
+    fs.request({ Resource::Tile, "mbtiles://TEST_DATA/fixtures/storage/tiles.mbtiles/0/0/0" },
+               uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        EXPECT_EQ("tile 0/0/0", *res.data);
+        GzippedTile.finish();
+    });
+
+    // Rows are flipped, since MBTiles files number them from the bottom.
+    fs.request({ Resource::Tile, "mbtiles://TEST_DATA/fixtures/storage/tiles.mbtiles/1/0/0" },
+               uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        EXPECT_EQ("tile 1/0/0", *res.data);
+        Tile.finish();
+    });
+
+    fs.request({ Resource::Tile, "mbtiles://TEST_DATA/fixtures/storage/tiles.mbtiles/1/1/1" },
+               uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Error, res.status);
+        EXPECT_EQ("Tile not found", res.message);
+        MissingTile.finish();
+    });
+
+    fs.request({ Resource::Tile, "mbtiles://TEST_DATA/fixtures/storage/missing.mbtiles/0/0/0" },
+               uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Error, res.status);
+        EXPECT_EQ("unable to open database file", res.message);
+        MissingFile.finish();
+    });
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+}
@@ -0,0 +1,97 @@
+#include "storage.hpp"
+
+#include <mbgl/storage/default_file_source.hpp>
+#include <mbgl/storage/offline_download.hpp>
+#include <mbgl/storage/sqlite_cache.hpp>
+
+#include <future>
+#include <limits>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char* const progressPath = "test/fixtures/database/offline_progress";
+
+mbgl::OfflineRegion region() {
+    mbgl::OfflineRegion result;
+    result.styleURL = "asset://TEST_DATA/fixtures/storage/offline/style.json";
+    result.bounds = { { -90, -180 }, { 90, 180 } };
+    result.minZoom = 0;
+    result.maxZoom = 1;
+    result.glyphRanges = { { 0, 255 }, { 256, 511 } };
+    result.maximumConcurrentRequests = 2;
+    return result;
+}
+
+mbgl::OfflineProgress download(mbgl::FileCache& cache) {
+    using namespace mbgl;
+
+    DefaultFileSource fs(&cache);
+
+    std::promise<OfflineProgress> promise;
+    OfflineDownload download(region(), fs, &cache, progressPath, [&](const OfflineProgress& progress) {
+        if (progress.complete) {
+            promise.set_value(progress);
+        }
+    });
+    return promise.get_future().get();
+}
+
+}
+
+TEST_F(Storage, OfflineDownload) {
+    using namespace mbgl;
+
+    mkdir("test/fixtures/database", 0755);
+    unlink(progressPath);
+
+    SQLiteCache cache(":memory:");
+
+    // Fresh responses in the cache aren't downloaded again.
+    auto sprite = std::make_shared<Response>();
+    sprite->status = Response::Successful;
+    sprite->expires = std::numeric_limits<int64_t>::max();
+    sprite->data = std::make_shared<const std::string>("{}");
+    cache.put({ Resource::JSON, "asset://TEST_DATA/fixtures/storage/offline/sprite.json" }, sprite,
+              FileCache::Hint::Full);
+
+    // The style, the TileJSON, the sprite image and JSON, two glyph ranges of the font stack and
+    // the five tiles of zoom levels 0 and 1. Three of the tiles are missing from the file.
+    const OfflineProgress progress = download(cache);
+    EXPECT_TRUE(progress.complete);
+    EXPECT_EQ(11u, progress.requiredResources);
+    EXPECT_EQ(11u, progress.completedResources);
+    EXPECT_EQ(1u, progress.cachedResources);
+    EXPECT_EQ(3u, progress.failedResources);
+    EXPECT_EQ(2u, progress.completedTiles);
+    EXPECT_EQ(2u, progress.downloadedTiles);
+    EXPECT_LT(0u, progress.downloadedBytes);
+    EXPECT_LT(0, progress.bytesPerSecond());
+}
+
+TEST_F(Storage, OfflineDownloadResume) {
+    using namespace mbgl;
+
+    mkdir("test/fixtures/database", 0755);
+    unlink(progressPath);
+
+    SQLiteCache cache(":memory:");
+    const OfflineProgress first = download(cache);
+    EXPECT_EQ(0u, first.cachedResources);
+    EXPECT_EQ(2u, first.downloadedTiles);
+
+    // Resources that were loaded before are skipped, except for the style and the TileJSON, which
+    // are needed to find the others. The missing tiles are tried again.
+    const OfflineProgress second = download(cache);
+    EXPECT_TRUE(second.complete);
+    EXPECT_EQ(11u, second.requiredResources);
+    EXPECT_EQ(11u, second.completedResources);
+    EXPECT_EQ(6u, second.cachedResources);
+    EXPECT_EQ(3u, second.failedResources);
+    EXPECT_EQ(2u, second.completedTiles);
+    EXPECT_EQ(0u, second.downloadedTiles);
+
+    unlink(progressPath);
+}
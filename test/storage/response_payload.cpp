@@ -0,0 +1,82 @@
+#include "storage.hpp"
+
+#include <uv.h>
+
+#include <mbgl/storage/default_file_source.hpp>
+#include <mbgl/storage/sqlite_cache.hpp>
+#include <mbgl/util/io.hpp>
+#include <mbgl/util/run_loop.hpp>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const std::size_t payloadSize = 512 * 1024;
+
+}
+
+TEST_F(Storage, ResponsePayloadShared) {
+    SCOPED_TEST(First)
+    SCOPED_TEST(Second)
+
+    using namespace mbgl;
+
+    mkdir("test/fixtures/database", 0755);
+    util::write_file("test/fixtures/database/payload", std::string(payloadSize, 'x'));
+
+    DefaultFileSource fs(nullptr);
+    auto &env = *static_cast<const Environment *>(nullptr);
+    const Resource resource { Resource::Tile, "asset://TEST_DATA/fixtures/database/payload" };
+
+    // Both requests are answered with the payload that was read from the file, without copying it.
+    const std::string* first = nullptr;
+
+    fs.request(resource, uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        ASSERT_EQ(payloadSize, res.data->size());
+        if (first) {
+            EXPECT_EQ(first, res.data.get());
+        }
+        first = res.data.get();
+        First.finish();
+    });
+
+    fs.request(resource, uv_default_loop(), env, [&](const Response &res) {
+        EXPECT_EQ(Response::Successful, res.status);
+        ASSERT_EQ(payloadSize, res.data->size());
+        if (first) {
+            EXPECT_EQ(first, res.data.get());
+        }
+        first = res.data.get();
+        Second.finish();
+    });
+
+    uv_run(uv_default_loop(), UV_RUN_DEFAULT);
+
+    unlink("test/fixtures/database/payload");
+}
+
+TEST_F(Storage, ResponsePayloadQueuedInCache) {
+    using namespace mbgl;
+
+    SQLiteCache cache(":memory:");
+    cache.setWriteBatch(64, std::chrono::seconds(10));
+
+    const Resource resource { Resource::Tile, "http://127.0.0.1:3000/payload" };
+    auto response = std::make_shared<Response>();
+    response->status = Response::Successful;
+    response->data = std::make_shared<const std::string>(payloadSize, 'x');
+    cache.put(resource, response, FileCache::Hint::Full);
+
+    // Responses that aren't written yet are answered with the payload that was put.
+    util::RunLoop loop;
+    loop.invoke([&] {
+        cache.get(resource, [&] (std::unique_ptr<Response> res) {
+            ASSERT_TRUE(res.get());
+            EXPECT_EQ(response->data.get(), res->data.get());
+            loop.stop();
+        });
+    });
+    loop.run();
+}
@@ -74,6 +74,23 @@ app.get('/revalidate-etag', function(req, res) {
 });
 
 
+var staleChangedCounter = 1;
+app.get('/stale-changed', function(req, res) {
+    res.setHeader('ETag', 'response-' + staleChangedCounter);
+    res.setHeader('Cache-Control', 'must-revalidate');
+
+    res.status(200).send('Response ' + staleChangedCounter);
+    staleChangedCounter++;
+});
+
+
+app.get('/stale-unchanged', function(req, res) {
+    // Sends the same content without validators, so it can't be revalidated with a 304.
+    res.setHeader('Cache-Control', 'must-revalidate');
+    res.status(200).send('Response');
+});
+
+
 var temporaryErrorCounter = 0;
 app.get('/temporary-error', function(req, res) {
     if (temporaryErrorCounter === 0) {
@@ -40,35 +40,155 @@
 
         'headless/headless.cpp',
 
+        'miscellaneous/arena.cpp',
         'miscellaneous/clip_ids.cpp',
         'miscellaneous/bilinear.cpp',
         'miscellaneous/comparisons.cpp',
+        'miscellaneous/earcut.cpp',
         'miscellaneous/enums.cpp',
+        'miscellaneous/filter_program.cpp',
         'miscellaneous/functions.cpp',
+        'miscellaneous/geometry_buffer.cpp',
+        'miscellaneous/glyph_atlas.cpp',
+        'miscellaneous/glyph_dependencies.cpp',
         'miscellaneous/mapbox.cpp',
         'miscellaneous/merge_lines.cpp',
+        'miscellaneous/metrics.cpp',
         'miscellaneous/rotation_range.cpp',
+        'miscellaneous/simplify.cpp',
         'miscellaneous/style_parser.cpp',
         'miscellaneous/text_conversions.cpp',
         'miscellaneous/tile.cpp',
+        'miscellaneous/tile_cache.cpp',
+        'miscellaneous/transform.cpp',
         'miscellaneous/variant.cpp',
+        'miscellaneous/vector_tile.cpp',
+        'miscellaneous/worker.cpp',
 
         'storage/storage.hpp',
         'storage/storage.cpp',
         'storage/cache_response.cpp',
         'storage/cache_revalidate.cpp',
+        'storage/cache_size.cpp',
+        'storage/cache_stale.cpp',
         'storage/database.cpp',
         'storage/directory_reading.cpp',
         'storage/file_reading.cpp',
         'storage/http_cancel.cpp',
         'storage/http_coalescing.cpp',
+        'storage/http_connection.cpp',
         'storage/http_environment.cpp',
         'storage/http_error.cpp',
         'storage/http_header_parsing.cpp',
         'storage/http_load.cpp',
         'storage/http_noloop.cpp',
         'storage/http_other_loop.cpp',
+        'storage/http_priority.cpp',
         'storage/http_reading.cpp',
+        'storage/mbtiles_reading.cpp',
+        'storage/offline_download.cpp',
+        'storage/response_payload.cpp',
+      ],
+      'libraries': [
+        '<@(uv_static_libs)',
+      ],
+      'variables': {
+        'cflags_cc': [
+          '<@(uv_cflags)',
+          '<@(opengl_cflags)',
+          '<@(boost_cflags)',
+        ],
+        'ldflags': [
+          '<@(uv_ldflags)',
+        ],
+      },
+      'conditions': [
+        ['OS == "mac"', {
+          'xcode_settings': {
+            'OTHER_CPLUSPLUSFLAGS': [ '<@(cflags_cc)' ],
+            'OTHER_LDFLAGS': [ '<@(ldflags)' ],
+          },
+        }, {
+         'cflags_cc': [ '<@(cflags_cc)' ],
+         'libraries': [ '<@(ldflags)' ],
+        }],
+      ],
+    },
+    { 'target_name': 'benchmark',
+      'type': 'executable',
+      'include_dirs': [ '../include', '../src' ],
+      'dependencies': [
+        'symlink_TEST_DATA',
+        '../mbgl.gyp:core',
+        '../mbgl.gyp:platform-<(platform_lib)',
+        '../mbgl.gyp:http-<(http_lib)',
+        '../mbgl.gyp:asset-<(asset_lib)',
+        '../mbgl.gyp:cache-<(cache_lib)',
+        '../mbgl.gyp:headless-<(headless_lib)',
+        '../deps/gtest/gtest.gyp:gtest'
+      ],
+      'sources': [
+        'fixtures/main.cpp',
+        'fixtures/util.hpp',
+        'fixtures/util.cpp',
+
+        'benchmark/benchmark.hpp',
+        'benchmark/bucket_buffers.cpp',
+        'benchmark/cold_start.cpp',
+        'benchmark/fill_tessellation.cpp',
+        'benchmark/filter_program.cpp',
+        'benchmark/fly_to.cpp',
+        'benchmark/glyph_atlas.cpp',
+        'benchmark/line_simplify.cpp',
+        'benchmark/render.cpp',
+        'benchmark/sqlite_cache.cpp',
+      ],
+      'libraries': [
+        '<@(uv_static_libs)',
+      ],
+      'variables': {
+        'cflags_cc': [
+          '<@(uv_cflags)',
+          '<@(opengl_cflags)',
+          '<@(boost_cflags)',
+        ],
+        'ldflags': [
+          '<@(uv_ldflags)',
+        ],
+      },
+      'conditions': [
+        ['OS == "mac"', {
+          'xcode_settings': {
+            'OTHER_CPLUSPLUSFLAGS': [ '<@(cflags_cc)' ],
+            'OTHER_LDFLAGS': [ '<@(ldflags)' ],
+          },
+        }, {
+         'cflags_cc': [ '<@(cflags_cc)' ],
+         'libraries': [ '<@(ldflags)' ],
+        }],
+      ],
+    },
+    { 'target_name': 'allocations',
+      'type': 'executable',
+      'include_dirs': [ '../include', '../src' ],
+      'dependencies': [
+        'symlink_TEST_DATA',
+        '../mbgl.gyp:core',
+        '../mbgl.gyp:platform-<(platform_lib)',
+        '../mbgl.gyp:http-<(http_lib)',
+        '../mbgl.gyp:asset-<(asset_lib)',
+        '../mbgl.gyp:cache-<(cache_lib)',
+        '../mbgl.gyp:headless-<(headless_lib)',
+        '../deps/gtest/gtest.gyp:gtest'
+      ],
+      'sources': [
+        'fixtures/main.cpp',
+        'fixtures/util.hpp',
+        'fixtures/util.cpp',
+
+        'allocations/allocation_counter.hpp',
+        'allocations/allocation_counter.cpp',
+        'allocations/steady_state.cpp',
       ],
       'libraries': [
         '<@(uv_static_libs)',